@@ -47,12 +47,19 @@
 #include "gfx/scenes/RaceScene.h"
 #include "common/Player.h"
 #include "common/Properties.h"
+#include "debug/DebugProperties.h"
+#include "debug/MemoryTracker.h"
+#include "debug/Profiler.h"
+#include "debug/TraceRecorder.h"
 #include "gfx/race/ui/RaceUI.h"
 #include "network/client/Client.h"
 #include "gfx/scenes/MainMenuScene.h"
 #include "logic/race/Level.h"
 
 
+/* Configuration file location */
+const CL_String CONFIG_FILE = "config.xml";
+
 #if defined(RACE_SCENE_ONLY)
 RaceScene *m_raceScene;
 #endif // RACE_SCENE_ONLY
@@ -84,26 +91,16 @@ int Application::main(const std::vector<CL_String> &args)
 
 	try {
 
-		// read args properties
-		for (std::vector<CL_String>::const_iterator itor = args.begin(); itor != args.end(); ++itor) {
-			if (itor->substr(0, 2) == "-P") {
-				const std::vector<CL_TempString> parts = CL_StringHelp::split_text(itor->substr(2), "=");
-
-				if (parts.size() != 2) {
-					CL_Console::write_line(CL_String8("cannot parse ") + *itor);
-					continue;
-				}
-
-				Properties::setProperty(parts[0], parts[1]);
-			}
-		}
-
 		// modules setup
 		CL_Console::write_line("initializing");
 
 		CL_SetupCore 	setup_core;
 		CL_ConsoleLogger logger;
 
+		// read properties, args override configuration file
+		Properties::loadFromFile(CONFIG_FILE);
+		Properties::parseArgs(args);
+
 		cl_log_event("init", "initializing display");
 		CL_SetupDisplay setup_display;
 
@@ -224,13 +221,16 @@ int Application::main(const std::vector<CL_String> &args)
 		while(!quit) {
 			CL_KeepAlive::process();
 
+			Dbg::Profiler::markFrame();
+			Dbg::TraceRecorder::update();
+
 			const unsigned timeChange = CL_System::get_time() - lastTime;
 			lastTime += timeChange;
 
 #if !defined(NDEBUG)
 			// apply iteration time change
 			static float timeChangeF = 0.0f;
-			const int iterSpeed = Properties::getPropertyAsInt("dbg_iterSpeed", 100);
+			const int iterSpeed = Dbg::ITER_SPEED.get();
 
 			timeChangeF += timeChange * (iterSpeed / 100.0f);
 
@@ -266,6 +266,8 @@ int Application::main(const std::vector<CL_String> &args)
 		CL_Console::write_line(e.message);
 	}
 
+	Dbg::MemoryTracker::reportAll("exit");
+
 	CL_Console::write_line("Thanks for playing :-)");
 
 	return 0;
@@ -30,6 +30,11 @@
 
 #include "ClanLib/network.h"
 
+#include "common/Properties.h"
+#include "debug/DebugProperties.h"
+#include "debug/MemoryTracker.h"
+#include "debug/Metrics.h"
+#include "debug/TraceRecorder.h"
 #include "network/server/Server.h"
 #include "ServerConfiguration.h"
 
@@ -46,18 +51,44 @@ int ServerApplication::main(const std::vector<CL_String> &args)
 		// load the server configuration
 		ServerConfiguration config;
 
+		// read properties, args override configuration file
+		Properties::loadFromFile(config.getFilename());
+		Properties::parseArgs(args);
+
 		Net::Server server;
 		server.setBindPort(config.getPort());
 
 		server.start();
 
+		// periodic stats log, disabled when zero
+		const unsigned statsPeriod = Dbg::STATS_PERIOD.get();
+		unsigned lastStatsTime = CL_System::get_time();
+
 		while (true) {
 			CL_KeepAlive::process();
+			server.update();
+			Dbg::TraceRecorder::update();
+
+			if (statsPeriod > 0 && CL_System::get_time() - lastStatsTime >= statsPeriod) {
+				std::vector<CL_String8> lines;
+
+				Dbg::MemoryTracker::publishMetrics();
+				Dbg::Metrics::formatAll(lines);
+
+				foreach (const CL_String8 &line, lines) {
+					cl_log_event("stats", line);
+				}
+
+				lastStatsTime = CL_System::get_time();
+			}
+
 			CL_System::sleep(2);
 		}
 	} catch (CL_Exception e) {
 		CL_Console::write_line("Exception thrown: %1", e.message);
 	}
 
+	Dbg::MemoryTracker::reportAll("exit");
+
 	return 0;
 }
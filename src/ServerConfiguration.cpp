@@ -82,6 +82,11 @@ void ServerConfiguration::load(const CL_String &p_configFile)
 	}
 }
 
+const CL_String &ServerConfiguration::getFilename() const
+{
+	return CONFIG_FILE;
+}
+
 int ServerConfiguration::getPort() const
 {
 	return m_port;
@@ -40,6 +40,9 @@ class ServerConfiguration {
 
 		int getPort() const;
 
+		/** @return Configuration file location */
+		const CL_String &getFilename() const;
+
 	private:
 
 		/** Server port */
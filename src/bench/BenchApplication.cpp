@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <ClanLib/core.h>
+
+#include "bench/Benchmark.h"
+
+/*
+ * Usage: bench [--filter=<text>] [--output=<file>] [--baseline=<file>] [--threshold=<percent>]
+ *
+ * Runs microbenchmarks from the game root directory. Results are written
+ * as JSON to the output file. When baseline is given, results are
+ * compared with it and the exit code is the number of regressions.
+ */
+
+/** Default allowed slowdown against baseline in percents */
+const double DEFAULT_THRESHOLD = 10.0;
+
+namespace {
+
+	/** @return Value of --key=value argument or empty string */
+	CL_String8 getArgument(int argc, char **argv, const CL_String8 &p_key)
+	{
+		const CL_String8 prefix = "--" + p_key + "=";
+
+		for (int i = 1; i < argc; ++i) {
+			const CL_String8 arg = argv[i];
+
+			if (arg.substr(0, prefix.size()) == prefix) {
+				return arg.substr(prefix.size());
+			}
+		}
+
+		return "";
+	}
+
+	CL_String8 readFile(const CL_String &p_filename)
+	{
+		CL_File file(p_filename, CL_File::open_existing, CL_File::access_read);
+
+		CL_String8 content;
+		content.resize(file.get_size());
+
+		if (!content.empty()) {
+			file.read(&content[0], content.size());
+		}
+
+		return content;
+	}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	try {
+		CL_SetupCore setup_core;
+
+		const CL_String8 filter = getArgument(argc, argv, "filter");
+		const CL_String8 output = getArgument(argc, argv, "output");
+		const CL_String8 baselineFile = getArgument(argc, argv, "baseline");
+		const CL_String8 threshold = getArgument(argc, argv, "threshold");
+
+		Bench::TResultList results;
+		Bench::Runner::run(filter, results);
+
+		const CL_String8 json = Bench::Runner::toJson(results);
+
+		if (!output.empty()) {
+			CL_File file(output, CL_File::create_always, CL_File::access_write);
+			file.write(json.data(), json.size());
+		} else {
+			CL_Console::write(json);
+		}
+
+		if (!baselineFile.empty()) {
+			Bench::TResultList baseline;
+			Bench::Runner::fromJson(readFile(baselineFile), baseline);
+
+			return Bench::Runner::compare(
+					results,
+					baseline,
+					threshold.empty() ? DEFAULT_THRESHOLD : CL_StringHelp::local8_to_double(threshold)
+			);
+		}
+
+	} catch (CL_Exception e) {
+		CL_Console::write_line("Exception thrown: %1", e.message);
+		return -1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <stdlib.h>
+
+#include "common.h"
+
+namespace Bench {
+
+namespace {
+
+	volatile float s_sink;
+
+	/** @return Current time in microseconds */
+	unsigned now()
+	{
+		return (unsigned) CL_System::get_microseconds();
+	}
+
+	/** @return Value of "key": in json object starting at p_pos */
+	CL_String8 findValue(const CL_String8 &p_json, CL_String8::size_type p_pos, CL_String8::size_type p_end, const CL_String8 &p_key)
+	{
+		const CL_String8 pattern = "\"" + p_key + "\":";
+		CL_String8::size_type pos = p_json.find(pattern, p_pos);
+
+		if (pos == CL_String8::npos || pos > p_end) {
+			throw CL_Exception(cl_format("no %1 in benchmark result", p_key));
+		}
+
+		pos += pattern.size();
+
+		if (p_json[pos] == '"') {
+			const CL_String8::size_type end = p_json.find('"', pos + 1);
+			return p_json.substr(pos + 1, end - pos - 1);
+		}
+
+		const CL_String8::size_type end = p_json.find_first_of(",}", pos);
+		return p_json.substr(pos, end - pos);
+	}
+
+} // namespace
+
+const unsigned Runner::BATCH_COUNT;
+
+const unsigned Runner::MIN_BATCH_TIME;
+
+void consume(float p_value)
+{
+	s_sink = p_value;
+}
+
+Benchmark::Benchmark(const CL_String &p_name) :
+	m_name(p_name)
+{
+	Runner::add(this);
+}
+
+Benchmark::~Benchmark()
+{
+}
+
+Runner::TBenchmarkList &Runner::getBenchmarks()
+{
+	static TBenchmarkList benchmarks;
+	return benchmarks;
+}
+
+void Runner::add(Benchmark *p_benchmark)
+{
+	getBenchmarks().push_back(p_benchmark);
+}
+
+void Runner::run(const CL_String &p_filter, TResultList &p_results)
+{
+	TBenchmarkList &benchmarks = getBenchmarks();
+
+	for (TBenchmarkList::iterator itor = benchmarks.begin(); itor != benchmarks.end(); ++itor) {
+		Benchmark &benchmark = **itor;
+
+		if (benchmark.getName().find(p_filter) == CL_String::npos) {
+			continue;
+		}
+
+		const Result result = measure(benchmark);
+		p_results.push_back(result);
+
+		CL_Console::write_line("%1: %2 ns/op (min %3, %4 iterations)", result.m_name, (float) result.m_nsPerOp, (float) result.m_minNsPerOp, result.m_iterations);
+	}
+}
+
+double Runner::measureBatch(Benchmark &p_benchmark, unsigned p_iterations)
+{
+	p_benchmark.setUp();
+
+	const unsigned start = now();
+
+	for (unsigned i = 0; i < p_iterations; ++i) {
+		p_benchmark.run();
+	}
+
+	const unsigned time = now() - start;
+
+	p_benchmark.tearDown();
+
+	return time * 1000.0 / p_iterations;
+}
+
+Result Runner::measure(Benchmark &p_benchmark)
+{
+	// find iteration count giving long enough batch, this warms up too
+	unsigned iterations = 1;
+
+	while (measureBatch(p_benchmark, iterations) * iterations < MIN_BATCH_TIME * 1000.0 && iterations < (1u << 30)) {
+		iterations *= 2;
+	}
+
+	std::vector<double> times;
+
+	for (unsigned i = 0; i < BATCH_COUNT; ++i) {
+		times.push_back(measureBatch(p_benchmark, iterations));
+	}
+
+	std::sort(times.begin(), times.end());
+
+	Result result;
+	result.m_name = p_benchmark.getName();
+	result.m_iterations = iterations;
+	result.m_nsPerOp = times[times.size() / 2];
+	result.m_minNsPerOp = times[0];
+
+	return result;
+}
+
+CL_String8 Runner::toJson(const TResultList &p_results)
+{
+	CL_String8 json = "{\"benchmarks\":[\n";
+
+	for (unsigned i = 0; i < p_results.size(); ++i) {
+		const Result &result = p_results[i];
+
+		json += cl_format(
+				"{\"name\":\"%1\",\"iterations\":%2,\"ns_per_op\":%3,\"min_ns_per_op\":%4}%5\n",
+				result.m_name,
+				result.m_iterations,
+				(float) result.m_nsPerOp,
+				(float) result.m_minNsPerOp,
+				CL_String8(i + 1 < p_results.size() ? "," : "")
+		);
+	}
+
+	json += "]}\n";
+
+	return json;
+}
+
+void Runner::fromJson(const CL_String8 &p_json, TResultList &p_results)
+{
+	CL_String8::size_type pos = p_json.find("{\"name\"");
+
+	while (pos != CL_String8::npos) {
+		const CL_String8::size_type end = p_json.find('}', pos);
+
+		Result result;
+		result.m_name = findValue(p_json, pos, end, "name");
+		result.m_iterations = CL_StringHelp::local8_to_uint(findValue(p_json, pos, end, "iterations"));
+		result.m_nsPerOp = CL_StringHelp::local8_to_double(findValue(p_json, pos, end, "ns_per_op"));
+		result.m_minNsPerOp = CL_StringHelp::local8_to_double(findValue(p_json, pos, end, "min_ns_per_op"));
+
+		p_results.push_back(result);
+
+		pos = p_json.find("{\"name\"", end);
+	}
+}
+
+unsigned Runner::compare(const TResultList &p_results, const TResultList &p_baseline, double p_threshold)
+{
+	unsigned regressions = 0;
+
+	foreach (const Result &result, p_results) {
+
+		const Result *baseline = NULL;
+
+		foreach (const Result &candidate, p_baseline) {
+			if (candidate.m_name == result.m_name) {
+				baseline = &candidate;
+				break;
+			}
+		}
+
+		if (baseline == NULL) {
+			CL_Console::write_line("%1: no baseline", result.m_name);
+			continue;
+		}
+
+		const double change = (result.m_nsPerOp - baseline->m_nsPerOp) * 100.0 / baseline->m_nsPerOp;
+		const bool regression = change > p_threshold;
+
+		const CL_String8 changeText = CL_String8(change >= 0.0 ? "+" : "") + CL_StringHelp::float_to_local8(change) + "%";
+
+		CL_Console::write_line(
+				"%1: %2 -> %3 ns/op (%4)%5",
+				result.m_name,
+				(float) baseline->m_nsPerOp,
+				(float) result.m_nsPerOp,
+				changeText,
+				CL_String8(regression ? " REGRESSION" : "")
+		);
+
+		if (regression) {
+			++regressions;
+		}
+	}
+
+	return regressions;
+}
+
+} // namespace
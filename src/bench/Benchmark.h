@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <vector>
+#include <ClanLib/core.h>
+
+#include "boost/utility.hpp"
+
+namespace Bench {
+
+/**
+ * Single microbenchmark. run() is called many times in a loop, setUp()
+ * and tearDown() surround each measured batch and are not timed.
+ */
+class Benchmark : public boost::noncopyable {
+
+	public:
+
+		Benchmark(const CL_String &p_name);
+
+		virtual ~Benchmark();
+
+		const CL_String &getName() const { return m_name; }
+
+		virtual void setUp() {}
+
+		virtual void run() = 0;
+
+		virtual void tearDown() {}
+
+	private:
+
+		CL_String m_name;
+};
+
+/** Benchmark result */
+struct Result {
+
+		CL_String m_name;
+
+		/** Iterations per measured batch */
+		unsigned m_iterations;
+
+		/** Median of batch times per operation */
+		double m_nsPerOp;
+
+		/** Fastest batch time per operation */
+		double m_minNsPerOp;
+};
+
+typedef std::vector<Result> TResultList;
+
+/** Runs registered benchmarks and reports results */
+class Runner {
+
+	public:
+
+		/** Batches measured per benchmark */
+		static const unsigned BATCH_COUNT = 7;
+
+		/** Minimal batch time in microseconds */
+		static const unsigned MIN_BATCH_TIME = 50000;
+
+
+		/** Registers benchmark, runner does not take ownership */
+		static void add(Benchmark *p_benchmark);
+
+		/** Runs benchmarks which names contain <code>p_filter</code> */
+		static void run(const CL_String &p_filter, TResultList &p_results);
+
+		static CL_String8 toJson(const TResultList &p_results);
+
+		/** Reads results written by toJson() */
+		static void fromJson(const CL_String8 &p_json, TResultList &p_results);
+
+		/**
+		 * Prints change against baseline.
+		 * @return Number of benchmarks slower than baseline by more than p_threshold percents
+		 */
+		static unsigned compare(const TResultList &p_results, const TResultList &p_baseline, double p_threshold);
+
+	private:
+
+		typedef std::vector<Benchmark*> TBenchmarkList;
+
+		static TBenchmarkList &getBenchmarks();
+
+		static Result measure(Benchmark &p_benchmark);
+
+		static double measureBatch(Benchmark &p_benchmark, unsigned p_iterations);
+
+		Runner();
+};
+
+/** Keeps the compiler from removing computations of benchmarked code */
+void consume(float p_value);
+
+} // namespace
+
+/** Defines static instance of benchmark class, which registers it */
+#define BENCHMARK(type) static type __benchmark_##type
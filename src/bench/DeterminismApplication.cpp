@@ -0,0 +1,339 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdlib.h>
+#include <vector>
+#include <ClanLib/core.h>
+
+#include "common.h"
+#include "logic/race/Car.h"
+#include "logic/race/Level.h"
+#include "logic/race/Replay.h"
+#include "logic/race/StateHash.h"
+
+/*
+ * Usage: determinism [--replay=<file>] [--ticks=<n>] [--cars=<n>] [--seed=<n>]
+ *                    [--log=<file>] [--compare=<file>]
+ *
+ * Replays recorded race input (or random input of given car count) twice
+ * and checks that the race state hash of every tick is the same. With
+ * --log the per tick state is written to file, --compare checks this run
+ * against a log written by other build, for example with other
+ * optimization level. Exit code is 1 when state diverges.
+ */
+
+/** Logic tick, the same as Race::LogicThread uses */
+const unsigned TICK = 1000 / 60;
+
+const unsigned DEFAULT_TICKS = 3600;
+
+const unsigned DEFAULT_CARS = 4;
+
+const CL_String DEFAULT_LEVEL = "resources/level.xml";
+
+/** State log file magic, "DLG1" */
+const unsigned LOG_MAGIC = 0x444c4731;
+
+/** Car fields of every tick */
+typedef std::vector<Race::StateHash::TCarFieldsList> TStateLog;
+
+namespace {
+
+	/** @return Value of --key=value argument or empty string */
+	CL_String8 getArgument(int argc, char **argv, const CL_String8 &p_key)
+	{
+		const CL_String8 prefix = "--" + p_key + "=";
+
+		for (int i = 1; i < argc; ++i) {
+			const CL_String8 arg = argv[i];
+
+			if (arg.substr(0, prefix.size()) == prefix) {
+				return arg.substr(prefix.size());
+			}
+		}
+
+		return "";
+	}
+
+	unsigned getArgument(int argc, char **argv, const CL_String8 &p_key, unsigned p_default)
+	{
+		const CL_String8 value = getArgument(argc, argv, p_key);
+		return value.empty() ? p_default : CL_StringHelp::local8_to_uint(value);
+	}
+
+	/** Random input which changes a few times per second */
+	void generate(Race::Replay &p_replay, unsigned p_ticks, unsigned p_seed)
+	{
+		Race::Level level;
+		level.initialize(p_replay.getLevelName());
+
+		const unsigned carCount = p_replay.getCarCount();
+
+		for (unsigned i = 0; i < carCount; ++i) {
+			p_replay.setStart(i, level.getStartPosition(i + 1), -90.0f);
+		}
+
+		level.destroy();
+
+		srand(p_seed);
+
+		std::vector<Race::RaceLogic::Input> inputs(carCount);
+
+		for (unsigned tick = 0; tick < p_ticks; ++tick) {
+
+			for (unsigned i = 0; i < carCount; ++i) {
+				Race::RaceLogic::Input &input = inputs[i];
+
+				if (rand() % 20 == 0) {
+					input.m_acceleration = rand() % 4 != 0;
+					input.m_brake = !input.m_acceleration && rand() % 2 == 0;
+					input.m_handbrake = rand() % 10 == 0;
+					input.m_turn = (rand() % 201 - 100) / 100.0f;
+				}
+			}
+
+			p_replay.addTick(&inputs[0]);
+		}
+	}
+
+	void simulate(const Race::Replay &p_replay, TStateLog &p_log)
+	{
+		Race::Level level;
+		level.initialize(p_replay.getLevelName());
+
+		const unsigned carCount = p_replay.getCarCount();
+		const unsigned tickCount = p_replay.getTickCount();
+
+		std::vector<Race::Car*> cars(carCount);
+
+		for (unsigned i = 0; i < carCount; ++i) {
+			cars[i] = new Race::Car();
+			level.addCar(cars[i]);
+
+			cars[i]->setPosition(p_replay.getStart(i).m_position);
+			cars[i]->setRotation(p_replay.getStart(i).m_rotation);
+		}
+
+		p_log.resize(tickCount);
+
+		for (unsigned tick = 0; tick < tickCount; ++tick) {
+
+			// the same order as RaceLogic::update()
+			for (unsigned i = 0; i < carCount; ++i) {
+				const Race::RaceLogic::Input &input = p_replay.getInput(tick, i);
+
+				cars[i]->setAcceleration(input.m_acceleration);
+				cars[i]->setBrake(input.m_brake);
+				cars[i]->setHandbrake(input.m_handbrake);
+				cars[i]->setTurn(input.m_turn);
+			}
+
+			for (unsigned i = 0; i < carCount; ++i) {
+				cars[i]->update(TICK);
+			}
+
+			level.update(TICK);
+
+			Race::StateHash::getFields(level, p_log[tick]);
+		}
+
+		for (unsigned i = 0; i < carCount; ++i) {
+			level.removeCar(cars[i]);
+			delete cars[i];
+		}
+
+		level.destroy();
+	}
+
+	void saveLog(const TStateLog &p_log, const CL_String &p_filename)
+	{
+		CL_File file(p_filename, CL_File::create_always, CL_File::access_write);
+
+		file.write_uint32(LOG_MAGIC);
+		file.write_uint32(p_log.size());
+		file.write_uint32(p_log.empty() ? 0 : p_log[0].size());
+
+		foreach (const Race::StateHash::TCarFieldsList &fields, p_log) {
+			foreach (const Race::StateHash::CarFields &car, fields) {
+				file.write_float(car.m_x);
+				file.write_float(car.m_y);
+				file.write_float(car.m_rotation);
+				file.write_float(car.m_moveX);
+				file.write_float(car.m_moveY);
+				file.write_float(car.m_speed);
+				file.write_int32(car.m_lap);
+				file.write_int32(car.m_checkpoint);
+			}
+		}
+	}
+
+	void loadLog(TStateLog &p_log, const CL_String &p_filename)
+	{
+		CL_File file(p_filename, CL_File::open_existing, CL_File::access_read);
+
+		if (file.read_uint32() != LOG_MAGIC) {
+			throw CL_Exception(cl_format("%1 is not a state log", p_filename));
+		}
+
+		const unsigned tickCount = file.read_uint32();
+		const unsigned carCount = file.read_uint32();
+
+		p_log.resize(tickCount);
+
+		foreach (Race::StateHash::TCarFieldsList &fields, p_log) {
+			fields.resize(carCount);
+
+			foreach (Race::StateHash::CarFields &car, fields) {
+				car.m_x = file.read_float();
+				car.m_y = file.read_float();
+				car.m_rotation = file.read_float();
+				car.m_moveX = file.read_float();
+				car.m_moveY = file.read_float();
+				car.m_speed = file.read_float();
+				car.m_lap = file.read_int32();
+				car.m_checkpoint = file.read_int32();
+			}
+		}
+	}
+
+	/**
+	 * Reports first tick where hashes differ with differing car fields.
+	 * @return True when logs are the same
+	 */
+	bool compare(const TStateLog &p_a, const TStateLog &p_b)
+	{
+		if (p_a.size() != p_b.size()) {
+			CL_Console::write_line("Tick count differs: %1 != %2", (unsigned) p_a.size(), (unsigned) p_b.size());
+			return false;
+		}
+
+		const unsigned tickCount = p_a.size();
+
+		for (unsigned tick = 0; tick < tickCount; ++tick) {
+
+			const unsigned hashA = Race::StateHash::calculate(p_a[tick]);
+			const unsigned hashB = Race::StateHash::calculate(p_b[tick]);
+
+			if (hashA == hashB) {
+				continue;
+			}
+
+			CL_Console::write_line(
+					"State diverges at tick %1: %2 != %3",
+					tick,
+					CL_StringHelp::uint_to_local8(hashA, 16),
+					CL_StringHelp::uint_to_local8(hashB, 16)
+			);
+
+			if (p_a[tick].size() != p_b[tick].size()) {
+				CL_Console::write_line("Car count differs: %1 != %2", (unsigned) p_a[tick].size(), (unsigned) p_b[tick].size());
+				return false;
+			}
+
+			const unsigned carCount = p_a[tick].size();
+
+			for (unsigned i = 0; i < carCount; ++i) {
+				std::vector<CL_String> lines;
+
+				if (Race::StateHash::diff(p_a[tick][i], p_b[tick][i], lines) > 0) {
+					CL_Console::write_line("  car %1:", i);
+
+					foreach (const CL_String &line, lines) {
+						CL_Console::write_line("    %1", line);
+					}
+				}
+			}
+
+			return false;
+		}
+
+		return true;
+	}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	try {
+		CL_SetupCore setup_core;
+
+		const CL_String8 replayFile = getArgument(argc, argv, "replay");
+		const CL_String8 logFile = getArgument(argc, argv, "log");
+		const CL_String8 compareFile = getArgument(argc, argv, "compare");
+
+		Race::Replay replay;
+
+		if (!replayFile.empty()) {
+			replay.load(replayFile);
+		} else {
+			replay = Race::Replay(DEFAULT_LEVEL, getArgument(argc, argv, "cars", DEFAULT_CARS));
+			generate(replay, getArgument(argc, argv, "ticks", DEFAULT_TICKS), getArgument(argc, argv, "seed", 1));
+		}
+
+		CL_Console::write_line(
+				"Simulating %1 ticks of %2 cars on %3",
+				replay.getTickCount(),
+				replay.getCarCount(),
+				replay.getLevelName()
+		);
+
+		// two runs in the same process must match
+		TStateLog first, second;
+
+		simulate(replay, first);
+		simulate(replay, second);
+
+		if (!compare(first, second)) {
+			return 1;
+		}
+
+		if (!logFile.empty()) {
+			saveLog(first, logFile);
+		}
+
+		if (!compareFile.empty()) {
+			TStateLog other;
+			loadLog(other, compareFile);
+
+			if (!compare(first, other)) {
+				return 1;
+			}
+		}
+
+		CL_Console::write_line(
+				"Final state hash: %1",
+				CL_StringHelp::uint_to_local8(first.empty() ? 0 : Race::StateHash::calculate(first.back()), 16)
+		);
+
+	} catch (CL_Exception e) {
+		CL_Console::write_line("Exception thrown: %1", e.message);
+		return -1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <vector>
+#include <ClanLib/core.h>
+#include <ClanLib/network.h>
+
+#include "common.h"
+#include "debug/DebugProperties.h"
+#include "network/events.h"
+#include "network/udp/UdpChannel.h"
+#include "network/udp/UdpSocket.h"
+
+/*
+ * Usage: loopback [--seconds=<n>] [--rate=<n>] [--loss=<percent>] [--port=<n>]
+ *
+ * Runs server and client UDP channels over loopback for given time.
+ * Server sends timestamped state every tick on unreliable channel and a
+ * numbered event every tenth tick on reliable one, dropping given percent
+ * of datagrams on both sides. Reports state latency, stale drops and
+ * whether all reliable events arrived in order. Exit code is 1 when
+ * sequencing or ordering is broken.
+ */
+
+const unsigned DEFAULT_SECONDS = 10;
+
+const unsigned DEFAULT_RATE = 20;
+
+/** Server port, client binds the next one */
+const unsigned BASE_PORT = 2501;
+
+/** Time given to reliable channel to resend the rest */
+const unsigned DRAIN_TIME = 2000;
+
+const unsigned TOKEN = 0x4c4f4f50;
+
+/** Codec sends only events having opcode, these stand in for the bench */
+const CL_String8 STATE_EVENT = EVENT_SNAPSHOT;
+
+const CL_String8 RELIABLE_EVENT = EVENT_PLAYER_JOINED;
+
+namespace {
+
+	/** @return Value of --key=value argument or default */
+	unsigned getArgument(int argc, char **argv, const CL_String8 &p_key, unsigned p_default)
+	{
+		const CL_String8 prefix = "--" + p_key + "=";
+
+		for (int i = 1; i < argc; ++i) {
+			const CL_String8 arg = argv[i];
+
+			if (arg.substr(0, prefix.size()) == prefix) {
+				return CL_StringHelp::local8_to_uint(arg.substr(prefix.size()));
+			}
+		}
+
+		return p_default;
+	}
+
+	/** Sends flushed datagrams of channel */
+	void flush(Net::UdpChannel &p_channel, Net::UdpSocket &p_socket, const CL_SocketName &p_to)
+	{
+		std::vector<CL_String8> datagrams;
+		p_channel.flush(CL_System::get_time(), datagrams);
+
+		foreach (const CL_String8 &datagram, datagrams) {
+			p_socket.send(datagram, p_to);
+		}
+	}
+
+	/** Feeds received datagrams to channel */
+	void receive(Net::UdpChannel &p_channel, Net::UdpSocket &p_socket, std::vector<CL_NetGameEvent> &p_events)
+	{
+		CL_String8 datagram;
+		CL_SocketName from;
+
+		while (p_socket.receive(datagram, from)) {
+			p_channel.receive(datagram, p_events);
+		}
+	}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+	try {
+		CL_SetupCore setup_core;
+		CL_SetupNetwork setup_network;
+
+		const unsigned seconds = getArgument(argc, argv, "seconds", DEFAULT_SECONDS);
+		const unsigned rate = std::max(getArgument(argc, argv, "rate", DEFAULT_RATE), 1u);
+		const unsigned loss = getArgument(argc, argv, "loss", 0);
+		const unsigned port = getArgument(argc, argv, "port", BASE_PORT);
+
+		Dbg::PACKET_LOSS.set(loss);
+
+		Net::UdpSocket serverSocket, clientSocket;
+
+		serverSocket.bind(CL_StringHelp::uint_to_local8(port));
+		clientSocket.bind(CL_StringHelp::uint_to_local8(port + 1));
+
+		const CL_SocketName serverName("127.0.0.1", CL_StringHelp::uint_to_local8(port));
+		const CL_SocketName clientName("127.0.0.1", CL_StringHelp::uint_to_local8(port + 1));
+
+		Net::UdpChannel server(TOKEN), client(TOKEN);
+
+		CL_Console::write_line("Running %1 s at %2 Hz with %3% loss", seconds, rate, loss);
+
+		const unsigned start = CL_System::get_time();
+		const unsigned ticks = seconds * rate;
+
+		unsigned tick = 0, reliableSent = 0;
+		unsigned statesReceived = 0, lastState = 0, reliableReceived = 0;
+		unsigned latencySum = 0, latencyMax = 0;
+		bool broken = false;
+
+		std::vector<CL_NetGameEvent> events;
+
+		while (true) {
+			const unsigned now = CL_System::get_time();
+
+			if (tick >= ticks && (now - start >= seconds * 1000 + DRAIN_TIME || server.getPendingCount() == 0)) {
+				break;
+			}
+
+			// server side
+			if (tick < ticks && now - start >= tick * 1000 / rate) {
+				server.send(CL_NetGameEvent(STATE_EVENT, tick + 1, now), false);
+
+				if (tick % 10 == 0) {
+					server.send(CL_NetGameEvent(RELIABLE_EVENT, reliableSent++), true);
+				}
+
+				++tick;
+			}
+
+			events.clear();
+			receive(server, serverSocket, events);
+			flush(server, serverSocket, clientName);
+
+			// client side
+			events.clear();
+			receive(client, clientSocket, events);
+
+			foreach (const CL_NetGameEvent &event, events) {
+				if (event.get_name() == STATE_EVENT) {
+					const unsigned stateTick = event.get_argument(0);
+					const unsigned latency = CL_System::get_time() - (unsigned) event.get_argument(1);
+
+					if (stateTick <= lastState) {
+						CL_Console::write_line("State %1 delivered after %2", stateTick, lastState);
+						broken = true;
+					}
+
+					lastState = stateTick;
+					++statesReceived;
+
+					latencySum += latency;
+					latencyMax = std::max(latencyMax, latency);
+				} else if (event.get_name() == RELIABLE_EVENT) {
+					const unsigned number = event.get_argument(0);
+
+					if (number != reliableReceived) {
+						CL_Console::write_line("Reliable event %1 delivered instead of %2", number, reliableReceived);
+						broken = true;
+					}
+
+					++reliableReceived;
+				}
+			}
+
+			flush(client, clientSocket, serverName);
+
+			CL_System::sleep(1);
+		}
+
+		CL_Console::write_line("States: %1 of %2 delivered", statesReceived, ticks);
+		CL_Console::write_line(
+				"State latency: %1 ms average, %2 ms max",
+				statesReceived > 0 ? latencySum / statesReceived : 0,
+				latencyMax
+		);
+		CL_Console::write_line("Reliable events: %1 of %2 delivered in order", reliableReceived, reliableSent);
+
+		if (broken || reliableReceived != reliableSent) {
+			return 1;
+		}
+
+	} catch (CL_Exception e) {
+		CL_Console::write_line("Exception thrown: %1", e.message);
+		return -1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,403 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "bench/Benchmark.h"
+#include "gfx/RenderDevice.h"
+#include "gfx/SpriteBatch.h"
+#include "gfx/TextureAtlas.h"
+#include "logic/race/Block.h"
+#include "logic/race/Car.h"
+#include "logic/race/Checkpoint.h"
+#include "logic/race/Level.h"
+#include "logic/race/Track.h"
+#include "logic/race/TyreStripes.h"
+#include "network/packets/CarState.h"
+#include "network/packets/GameState.h"
+
+namespace Bench {
+
+/** Demo level used by all level benchmarks */
+const CL_String LEVEL_FILE = "resources/level.xml";
+
+/** Random points used per benchmark */
+const unsigned POINT_COUNT = 1024;
+
+/** Sprites of one benchmarked race frame, about a zoomed out view */
+const unsigned FRAME_SPRITES = 1024;
+
+namespace {
+
+	/** @return Demo level loaded on first use */
+	Race::Level &getLevel()
+	{
+		static Race::Level level;
+
+		if (!level.isLoaded()) {
+			level.initialize(LEVEL_FILE);
+		}
+
+		return level;
+	}
+
+	/** Fills p_points with random points on the level */
+	void randomPoints(std::vector<CL_Pointf> &p_points)
+	{
+		Race::Level &level = getLevel();
+
+		const int width = level.getWidth() * Race::Block::WIDTH;
+		const int height = level.getHeight() * Race::Block::WIDTH;
+
+		srand(POINT_COUNT);
+		p_points.resize(POINT_COUNT);
+
+		for (unsigned i = 0; i < POINT_COUNT; ++i) {
+			p_points[i] = CL_Pointf(rand() % width, rand() % height);
+		}
+	}
+
+	Net::CarState prepareCarState(int p_index)
+	{
+		Net::CarState state;
+
+		state.setPlayerId(p_index % Net::MAX_PLAYERS);
+		state.setPosition(CL_Pointf(123.5f + p_index, 456.25f));
+		state.setRotation(CL_Angle(37.0f, cl_degrees));
+		state.setMovement(CL_Vec2f(0.5f, -0.75f));
+		state.setSpeed(210.0f);
+		state.setAcceleration(1.0f);
+		state.setTurn(-0.5f);
+
+		return state;
+	}
+
+} // namespace
+
+/** One physics step of accelerating and turning car */
+class CarUpdateBenchmark : public Benchmark {
+
+	public:
+
+		CarUpdateBenchmark() : Benchmark("Car::update1_60") {}
+
+		virtual void setUp()
+		{
+			getLevel().addCar(&m_car);
+
+			m_car.setStartPosition(1);
+			m_car.setAcceleration(true);
+			m_car.setTurn(0.5f);
+		}
+
+		virtual void run()
+		{
+			m_car.update1_60();
+			consume(m_car.getSpeed());
+		}
+
+		virtual void tearDown()
+		{
+			getLevel().removeCar(&m_car);
+		}
+
+	private:
+
+		Race::Car m_car;
+};
+
+BENCHMARK(CarUpdateBenchmark);
+
+/** Resistance lookups over random level points */
+class ResistanceBenchmark : public Benchmark {
+
+	public:
+
+		ResistanceBenchmark() : Benchmark("ResistanceMap::resistance"), m_next(0) {}
+
+		virtual void setUp()
+		{
+			randomPoints(m_points);
+		}
+
+		virtual void run()
+		{
+			const CL_Pointf &point = m_points[m_next++ % POINT_COUNT];
+			consume(getLevel().getResistance(point.x, point.y));
+		}
+
+	private:
+
+		std::vector<CL_Pointf> m_points;
+
+		unsigned m_next;
+};
+
+BENCHMARK(ResistanceBenchmark);
+
+/** Checkpoint progress of car driving along the demo track */
+class TrackCheckBenchmark : public Benchmark {
+
+	public:
+
+		TrackCheckBenchmark() : Benchmark("Track::check"), m_current(NULL), m_next(0) {}
+
+		virtual void setUp()
+		{
+			const Race::Track &levelTrack = getLevel().getTrack();
+			const unsigned checkpointCount = levelTrack.getCheckpointCount();
+
+			m_track.clear();
+			m_path.clear();
+
+			for (unsigned i = 0; i < checkpointCount; ++i) {
+				const CL_Pointf &from = levelTrack.getCheckpoint(i)->getPosition();
+				const CL_Pointf &to = levelTrack.getCheckpoint((i + 1) % checkpointCount)->getPosition();
+
+				m_track.addCheckpointAtPosition(from);
+
+				// points between checkpoints
+				for (int j = 0; j < 16; ++j) {
+					m_path.push_back(from + (to - from) * (j / 16.0f));
+				}
+			}
+
+			m_track.close();
+			m_current = m_track.getFirst();
+		}
+
+		virtual void run()
+		{
+			bool movingForward, newLap;
+
+			m_current = m_track.check(m_path[m_next++ % m_path.size()], m_current, &movingForward, &newLap);
+			consume(m_current->getProgress());
+		}
+
+	private:
+
+		Race::Track m_track;
+
+		std::vector<CL_Pointf> m_path;
+
+		const Race::Checkpoint *m_current;
+
+		unsigned m_next;
+};
+
+BENCHMARK(TrackCheckBenchmark);
+
+/** Stripes of four tyres of continuously drifting car */
+class TyreStripesBenchmark : public Benchmark {
+
+	public:
+
+		TyreStripesBenchmark() : Benchmark("TyreStripes::add"), m_step(0) {}
+
+		virtual void setUp()
+		{
+			m_stripes.clear();
+			m_step = 0;
+
+			for (int i = 0; i < 4; ++i) {
+				m_lastPoints[i] = tyrePoint(i);
+			}
+		}
+
+		virtual void run()
+		{
+			++m_step;
+
+			for (int i = 0; i < 4; ++i) {
+				const CL_Pointf point = tyrePoint(i);
+
+				m_stripes.add(m_lastPoints[i], point, &m_car);
+				m_lastPoints[i] = point;
+			}
+		}
+
+	private:
+
+		Race::TyreStripes m_stripes;
+
+		/** Stripe owner */
+		Race::Car m_car;
+
+		CL_Pointf m_lastPoints[4];
+
+		unsigned m_step;
+
+		/** @return Tyre position of car drifting around a circle */
+		CL_Pointf tyrePoint(int p_tyre) const
+		{
+			const float angle = m_step * 0.02f;
+			const float tyreAngle = angle + p_tyre * 1.5708f + 0.7854f;
+
+			return CL_Pointf(
+					500.0f + cos(angle) * 200.0f + cos(tyreAngle) * 10.0f,
+					500.0f + sin(angle) * 200.0f + sin(tyreAngle) * 10.0f
+			);
+		}
+};
+
+BENCHMARK(TyreStripesBenchmark);
+
+/** Car state serialization round trip */
+class CarStateBenchmark : public Benchmark {
+
+	public:
+
+		CarStateBenchmark() : Benchmark("Net::CarState round trip"), m_state(prepareCarState(0)) {}
+
+		virtual void run()
+		{
+			Net::CarState parsed;
+			parsed.parseEvent(m_state.buildEvent());
+
+			consume(parsed.getSpeed());
+		}
+
+	private:
+
+		const Net::CarState m_state;
+};
+
+BENCHMARK(CarStateBenchmark);
+
+/** Game state with eight players serialization round trip */
+class GameStateBenchmark : public Benchmark {
+
+	public:
+
+		GameStateBenchmark() : Benchmark("Net::GameState round trip")
+		{
+			for (int i = 0; i < 8; ++i) {
+				m_state.addPlayer(cl_format("player%1", i), prepareCarState(i));
+			}
+
+			m_state.setLevel(LEVEL_FILE);
+			m_state.setLevelExtent(Net::CarState::getLevelExtent());
+		}
+
+		virtual void run()
+		{
+			Net::GameState parsed;
+			parsed.parseEvent(m_state.buildEvent());
+
+			consume(parsed.getPlayerCount());
+		}
+
+	private:
+
+		Net::GameState m_state;
+};
+
+BENCHMARK(GameStateBenchmark);
+
+/** Loading of the demo level */
+class LevelLoadBenchmark : public Benchmark {
+
+	public:
+
+		LevelLoadBenchmark() : Benchmark("Level::loadFromFile") {}
+
+		virtual void run()
+		{
+			Race::Level level;
+			level.initialize(LEVEL_FILE);
+
+			consume(level.getWidth());
+		}
+};
+
+BENCHMARK(LevelLoadBenchmark);
+
+/**
+ * Draw submission of a race frame: decorations, cars and additive smoke
+ * from two atlas pages queued in mixed order, flushed to the counting
+ * backend. Needs no graphic context.
+ */
+class SpriteBatchBenchmark : public Benchmark {
+
+	public:
+
+		SpriteBatchBenchmark() : Benchmark("SpriteBatch::flush"), m_batch(m_atlas) {}
+
+		virtual void setUp()
+		{
+			for (int i = 0; i < REGION_COUNT; ++i) {
+				Gfx::TextureAtlas::Region &region = m_regions[i];
+
+				region.m_page = i % 2;
+				region.m_texCoords = CL_Rectf(0.0f, 0.0f, 0.1f, 0.1f);
+				region.m_size = CL_Sizef(32.0f, 32.0f);
+				region.m_baseAngle = 90.0f;
+				region.m_centered = true;
+			}
+
+			std::vector<CL_Pointf> points;
+			randomPoints(points);
+
+			m_positions.assign(points.begin(), points.begin() + FRAME_SPRITES);
+		}
+
+		virtual void run()
+		{
+			m_device.beginFrame();
+
+			for (unsigned i = 0; i < FRAME_SPRITES; ++i) {
+				const Gfx::SpriteBatch::BlendMode blendMode = i % 8 == 0 ? Gfx::SpriteBatch::BM_ADDITIVE : Gfx::SpriteBatch::BM_NORMAL;
+
+				m_batch.add(m_regions[i % REGION_COUNT], m_positions[i], CL_Angle(i, cl_degrees), 1.0f, CL_Colorf::white, blendMode);
+			}
+
+			m_batch.flush(m_device);
+
+			consume(m_device.getStats().m_drawCalls);
+		}
+
+	private:
+
+		static const int REGION_COUNT = 8;
+
+		/** Not built, regions are made up and the backend binds nothing */
+		Gfx::TextureAtlas m_atlas;
+
+		Gfx::TextureAtlas::Region m_regions[REGION_COUNT];
+
+		Gfx::SpriteBatch m_batch;
+
+		Gfx::NullRenderDevice m_device;
+
+		std::vector<CL_Pointf> m_positions;
+};
+
+BENCHMARK(SpriteBatchBenchmark);
+
+} // namespace
@@ -28,8 +28,6 @@
 
 #include "Properties.h"
 
-std::map<CL_String8, CL_String8> Properties::m_keyValueMap;
-
 Properties::Properties() {
 
 }
@@ -37,6 +35,55 @@ Properties::Properties() {
 Properties::~Properties() {
 }
 
+Properties::TEntryMap &Properties::getEntries()
+{
+	static TEntryMap entries;
+	return entries;
+}
+
+Properties::Entry *Properties::findEntry(const CL_String8 &p_key)
+{
+	TEntryMap &entries = getEntries();
+	TEntryMap::iterator itor = entries.find(p_key);
+
+	return itor != entries.end() ? &itor->second : NULL;
+}
+
+CL_Mutex &Properties::getValueMutex()
+{
+	static CL_Mutex mutex;
+	return mutex;
+}
+
+CL_String8 Properties::getValue(const Entry &p_entry)
+{
+	CL_MutexSection lock(&getValueMutex());
+	return p_entry.m_value;
+}
+
+void Properties::parseValue(Entry &p_entry)
+{
+	p_entry.m_intValue = CL_StringHelp::local8_to_int(p_entry.m_value);
+	p_entry.m_boolValue = CL_StringHelp::local8_to_bool(p_entry.m_value);
+}
+
+Properties::Entry *Properties::declare(const CL_String8 &p_key, const CL_String8 &p_defaultValue)
+{
+	Entry *entry = findEntry(p_key);
+
+	if (entry == NULL) {
+		entry = &getEntries()[p_key];
+
+		CL_MutexSection lock(&getValueMutex());
+
+		entry->m_key = p_key;
+		entry->m_value = p_defaultValue;
+		parseValue(*entry);
+	}
+
+	return entry;
+}
+
 void Properties::setProperty(const CL_String8 &p_key, bool p_value)
 {
 	setProperty(p_key, CL_StringHelp::bool_to_local8(p_value));
@@ -49,24 +96,88 @@ void Properties::setProperty(const CL_String8 &p_key, int p_value)
 
 void Properties::setProperty(const CL_String8 &p_key, const CL_String8 &p_value)
 {
-	m_keyValueMap[p_key] = p_value;
+	Entry *entry = findEntry(p_key);
+
+	if (entry == NULL) {
+		declare(p_key, p_value);
+		return;
+	}
+
+	{
+		CL_MutexSection lock(&getValueMutex());
+
+		if (entry->m_value == p_value) {
+			return;
+		}
+
+		entry->m_value = p_value;
+		parseValue(*entry);
+	}
+
+	entry->m_sigChanged.invoke();
 }
 
 bool Properties::getPropertyAsBool(const CL_String8 &p_key, bool p_defaultValue)
 {
-	return CL_StringHelp::local8_to_bool(getPropertyAsString(p_key, CL_StringHelp::bool_to_local8(p_defaultValue)));
+	const Entry *entry = findEntry(p_key);
+	return entry != NULL ? entry->m_boolValue : p_defaultValue;
 }
 
 int Properties::getPropertyAsInt(const CL_String8 &p_key, int p_defaultValue)
 {
-	return CL_StringHelp::local8_to_int(getPropertyAsString(p_key, CL_StringHelp::int_to_local8(p_defaultValue)));
+	const Entry *entry = findEntry(p_key);
+	return entry != NULL ? entry->m_intValue : p_defaultValue;
 }
 
 CL_String8 Properties::getPropertyAsString(const CL_String8 &p_key, const CL_String8 &defaultValue)
 {
-	if (m_keyValueMap.find(p_key) != m_keyValueMap.end()) {
-		return m_keyValueMap[p_key];
-	} else {
-		return defaultValue;
+	const Entry *entry = findEntry(p_key);
+	return entry != NULL ? getValue(*entry) : defaultValue;
+}
+
+void Properties::loadFromFile(const CL_String &p_filename)
+{
+	try {
+		CL_File file(p_filename, CL_File::open_existing, CL_File::access_read);
+
+		CL_DomDocument document(file);
+		CL_DomElement root = document.get_document_element();
+
+		if (root.named_item("properties").is_null()) {
+			return;
+		}
+
+		CL_DomNode cur = root.named_item("properties").get_first_child();
+
+		while (!cur.is_null()) {
+
+			if (cur.is_element() && cur.get_node_name() == "property") {
+				const CL_DomElement element = cur.to_element();
+
+				setProperty(element.get_attribute("name"), element.get_attribute("value"));
+				cl_log_event("config", "Property %1 set to %2", element.get_attribute("name"), element.get_attribute("value"));
+			}
+
+			cur = cur.get_next_sibling();
+		}
+
+	} catch (CL_Exception e) {
+		cl_log_event("exception", e.message);
+	}
+}
+
+void Properties::parseArgs(const std::vector<CL_String> &p_args)
+{
+	for (std::vector<CL_String>::const_iterator itor = p_args.begin(); itor != p_args.end(); ++itor) {
+		if (itor->substr(0, 2) == "-P") {
+			const std::vector<CL_TempString> parts = CL_StringHelp::split_text(itor->substr(2), "=");
+
+			if (parts.size() != 2) {
+				CL_Console::write_line(CL_String8("cannot parse ") + *itor);
+				continue;
+			}
+
+			setProperty(parts[0], parts[1]);
+		}
 	}
 }
@@ -29,6 +29,7 @@
 #pragma once
 
 #include <map>
+#include <vector>
 #include <ClanLib/core.h>
 
 /**
@@ -37,11 +38,35 @@
  * <li>dbg_* - Debug properties. Available only in debug build</li>
  * <li>cg_* - User configuration properties.</li>
  * </ul>
+ *
+ * Properties used often should be declared once with a typed handle
+ * (IntProperty, BoolProperty, StringProperty). Reading from a handle
+ * does no lookup nor parsing.
  */
 class Properties {
 
 	public:
 
+		/** Stored property */
+		struct Entry {
+
+				/** Property key */
+				CL_String8 m_key;
+
+				/** Value as set, read with getValue() */
+				CL_String8 m_value;
+
+				/** Value parsed as int */
+				int m_intValue;
+
+				/** Value parsed as bool */
+				bool m_boolValue;
+
+				/** Emitted after value change */
+				CL_Signal_v0 m_sigChanged;
+		};
+
+
 		static void setProperty(const CL_String8 &p_key, bool p_value);
 
 		static void setProperty(const CL_String8 &p_key, int p_value);
@@ -55,11 +80,99 @@ class Properties {
 
 		static CL_String8 getPropertyAsString(const CL_String8 &p_key, const CL_String8 &defaultValue);
 
+		/** @return Copy of entry value, safe while other thread sets it */
+		static CL_String8 getValue(const Entry &p_entry);
+
+
+		/**
+		 * Declares property with default value. When property is already
+		 * set, its value is kept.
+		 *
+		 * @return Entry that lives until the process ends
+		 */
+		static Entry *declare(const CL_String8 &p_key, const CL_String8 &p_defaultValue);
+
+		/** Sets properties from <properties> element of configuration file */
+		static void loadFromFile(const CL_String &p_filename);
+
+		/** Sets properties from -Pkey=value arguments */
+		static void parseArgs(const std::vector<CL_String> &p_args);
+
 	private:
 
-		static std::map<CL_String8, CL_String8> m_keyValueMap;
+		typedef std::map<CL_String8, Entry> TEntryMap;
+
+		/** Entries, created on first use so handles may be static */
+		static TEntryMap &getEntries();
+
+		static Entry *findEntry(const CL_String8 &p_key);
+
+		/** Guards string values, logic thread reads properties too */
+		static CL_Mutex &getValueMutex();
+
+		static void parseValue(Entry &p_entry);
 
 		Properties();
 
 		virtual ~Properties();
 };
+
+/** Declared integer property */
+class IntProperty {
+
+	public:
+
+		IntProperty(const CL_String8 &p_key, int p_defaultValue) :
+			m_entry(Properties::declare(p_key, CL_StringHelp::int_to_local8(p_defaultValue)))
+		{}
+
+		int get() const { return m_entry->m_intValue; }
+
+		void set(int p_value) const { Properties::setProperty(m_entry->m_key, p_value); }
+
+		CL_Signal_v0 &sig_changed() const { return m_entry->m_sigChanged; }
+
+	private:
+
+		Properties::Entry *const m_entry;
+};
+
+/** Declared boolean property */
+class BoolProperty {
+
+	public:
+
+		BoolProperty(const CL_String8 &p_key, bool p_defaultValue) :
+			m_entry(Properties::declare(p_key, CL_StringHelp::bool_to_local8(p_defaultValue)))
+		{}
+
+		bool get() const { return m_entry->m_boolValue; }
+
+		void set(bool p_value) const { Properties::setProperty(m_entry->m_key, p_value); }
+
+		CL_Signal_v0 &sig_changed() const { return m_entry->m_sigChanged; }
+
+	private:
+
+		Properties::Entry *const m_entry;
+};
+
+/** Declared string property */
+class StringProperty {
+
+	public:
+
+		StringProperty(const CL_String8 &p_key, const CL_String8 &p_defaultValue) :
+			m_entry(Properties::declare(p_key, p_defaultValue))
+		{}
+
+		CL_String8 get() const { return Properties::getValue(*m_entry); }
+
+		void set(const CL_String8 &p_value) const { Properties::setProperty(m_entry->m_key, p_value); }
+
+		CL_Signal_v0 &sig_changed() const { return m_entry->m_sigChanged; }
+
+	private:
+
+		Properties::Entry *const m_entry;
+};
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "boost/utility.hpp"
+
+/**
+ * Lock-free single producer, single consumer triple buffer. Writer fills
+ * the back buffer and publishes it, reader always gets the most recently
+ * published buffer. Neither side ever waits for the other.
+ */
+template<typename T>
+class TripleBuffer : public boost::noncopyable {
+
+	public:
+
+		TripleBuffer() :
+			m_back(0),
+			m_middle(1),
+			m_front(2)
+		{}
+
+		virtual ~TripleBuffer() {}
+
+
+		/** @return Buffer to fill by the writer */
+		T &getWriteBuffer() { return m_buffers[m_back]; }
+
+		/** Makes the write buffer visible to the reader */
+		void publish()
+		{
+			int middle;
+
+			do {
+				middle = m_middle;
+			} while (!__sync_bool_compare_and_swap(&m_middle, middle, m_back | FRESH_FLAG));
+
+			m_back = middle & INDEX_MASK;
+		}
+
+		/** @return Most recently published buffer */
+		const T &read()
+		{
+			if (m_middle & FRESH_FLAG) {
+				int middle;
+
+				do {
+					middle = m_middle;
+				} while (!__sync_bool_compare_and_swap(&m_middle, middle, m_front));
+
+				m_front = middle & INDEX_MASK;
+			}
+
+			return m_buffers[m_front];
+		}
+
+	private:
+
+		/** Set on middle index when it holds not yet read data */
+		static const int FRESH_FLAG = 4;
+
+		static const int INDEX_MASK = 3;
+
+		T m_buffers[3];
+
+		/** Writer owned index */
+		int m_back;
+
+		/** Shared index */
+		volatile int m_middle;
+
+		/** Reader owned index */
+		int m_front;
+};
@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "MemoryTracker.h"
+
+#include <stdlib.h>
+#include <new>
+
+#include "debug/Metrics.h"
+
+namespace Dbg {
+
+namespace {
+
+	/** Tag display names, in MemoryTag order */
+	const char *TAG_NAMES[MT_COUNT] = {
+		"other",
+		"level",
+		"physics",
+		"gfx",
+		"network"
+	};
+
+	/** Counters of all tags, changed with atomic builtins */
+	volatile unsigned s_liveBytes[MT_COUNT];
+
+	volatile unsigned s_liveAllocations[MT_COUNT];
+
+	volatile unsigned s_allocations[MT_COUNT];
+
+	/** Tag of calling thread */
+	__thread MemoryTag t_tag = MT_OTHER;
+
+#if defined(TRACK_MEMORY)
+
+	/** Live kilobytes per tag, in MemoryTag order */
+	const Gauge TAG_METRICS[MT_COUNT] = {
+		Gauge("mem other kB"),
+		Gauge("mem level kB"),
+		Gauge("mem physics kB"),
+		Gauge("mem gfx kB"),
+		Gauge("mem network kB")
+	};
+
+	/** Block header, sized to keep malloc alignment of the user block */
+	union Header {
+
+			struct {
+					size_t m_size;
+					MemoryTag m_tag;
+			} m_info;
+
+			double m_alignDouble;
+
+			long double m_alignLongDouble;
+
+			void *m_alignPointer;
+	};
+
+	void *allocate(size_t p_size)
+	{
+		Header *header = static_cast<Header*>(malloc(sizeof(Header) + p_size));
+
+		if (header == NULL) {
+			return NULL;
+		}
+
+		const MemoryTag tag = t_tag;
+
+		header->m_info.m_size = p_size;
+		header->m_info.m_tag = tag;
+
+		__sync_fetch_and_add(&s_liveBytes[tag], p_size);
+		__sync_fetch_and_add(&s_liveAllocations[tag], 1);
+		__sync_fetch_and_add(&s_allocations[tag], 1);
+
+		return header + 1;
+	}
+
+	void deallocate(void *p_ptr)
+	{
+		if (p_ptr == NULL) {
+			return;
+		}
+
+		Header *header = static_cast<Header*>(p_ptr) - 1;
+		const MemoryTag tag = header->m_info.m_tag;
+
+		__sync_fetch_and_sub(&s_liveBytes[tag], header->m_info.m_size);
+		__sync_fetch_and_sub(&s_liveAllocations[tag], 1);
+
+		free(header);
+	}
+
+#endif // TRACK_MEMORY
+
+} // namespace
+
+bool MemoryTracker::isEnabled()
+{
+#if defined(TRACK_MEMORY)
+	return true;
+#else
+	return false;
+#endif
+}
+
+const char *MemoryTracker::getTagName(MemoryTag p_tag)
+{
+	return TAG_NAMES[p_tag];
+}
+
+MemoryTracker::TagStats MemoryTracker::getStats(MemoryTag p_tag)
+{
+	TagStats stats;
+
+	stats.m_liveBytes = s_liveBytes[p_tag];
+	stats.m_liveAllocations = s_liveAllocations[p_tag];
+	stats.m_allocations = s_allocations[p_tag];
+
+	return stats;
+}
+
+MemoryTag MemoryTracker::getTag()
+{
+	return t_tag;
+}
+
+MemoryTag MemoryTracker::setTag(MemoryTag p_tag)
+{
+	const MemoryTag previous = t_tag;
+	t_tag = p_tag;
+
+	return previous;
+}
+
+void MemoryTracker::publishMetrics()
+{
+#if defined(TRACK_MEMORY)
+	for (int i = 0; i < MT_COUNT; ++i) {
+		TAG_METRICS[i].set(s_liveBytes[i] / 1024.0f);
+	}
+#endif
+}
+
+void MemoryTracker::reportLeaks(MemoryTag p_tag, const TagStats &p_baseline, const CL_String &p_context)
+{
+	const TagStats stats = getStats(p_tag);
+
+	if (stats.m_liveAllocations <= p_baseline.m_liveAllocations && stats.m_liveBytes <= p_baseline.m_liveBytes) {
+		return;
+	}
+
+	cl_log_event(
+			"memory",
+			"%1: %2 memory not freed, %3 bytes in %4 allocations",
+			p_context,
+			CL_String(getTagName(p_tag)),
+			(int) (stats.m_liveBytes - p_baseline.m_liveBytes),
+			(int) (stats.m_liveAllocations - p_baseline.m_liveAllocations)
+	);
+}
+
+void MemoryTracker::reportAll(const CL_String &p_context)
+{
+	if (!isEnabled()) {
+		return;
+	}
+
+	for (int i = 0; i < MT_COUNT; ++i) {
+		const TagStats stats = getStats((MemoryTag) i);
+
+		CL_Console::write_line(
+				"%1: %2 live %3 bytes in %4 allocations, %5 allocations total",
+				p_context,
+				CL_String(getTagName((MemoryTag) i)),
+				stats.m_liveBytes,
+				stats.m_liveAllocations,
+				stats.m_allocations
+		);
+	}
+}
+
+} // namespace
+
+#if defined(TRACK_MEMORY)
+
+void *operator new(size_t p_size) throw (std::bad_alloc)
+{
+	void *ptr = Dbg::allocate(p_size);
+
+	if (ptr == NULL) {
+		throw std::bad_alloc();
+	}
+
+	return ptr;
+}
+
+void *operator new[](size_t p_size) throw (std::bad_alloc)
+{
+	return operator new(p_size);
+}
+
+void *operator new(size_t p_size, const std::nothrow_t&) throw ()
+{
+	return Dbg::allocate(p_size);
+}
+
+void *operator new[](size_t p_size, const std::nothrow_t&) throw ()
+{
+	return Dbg::allocate(p_size);
+}
+
+void operator delete(void *p_ptr) throw ()
+{
+	Dbg::deallocate(p_ptr);
+}
+
+void operator delete[](void *p_ptr) throw ()
+{
+	Dbg::deallocate(p_ptr);
+}
+
+void operator delete(void *p_ptr, const std::nothrow_t&) throw ()
+{
+	Dbg::deallocate(p_ptr);
+}
+
+void operator delete[](void *p_ptr, const std::nothrow_t&) throw ()
+{
+	Dbg::deallocate(p_ptr);
+}
+
+#endif // TRACK_MEMORY
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <ClanLib/core.h>
+
+#include "boost/utility.hpp"
+
+namespace Dbg {
+
+/** Subsystems owning allocations. Name table in MemoryTracker.cpp must follow this order. */
+enum MemoryTag {
+	MT_OTHER,
+	MT_LEVEL,
+	MT_PHYSICS,
+	MT_GFX,
+	MT_NETWORK,
+	MT_COUNT
+};
+
+/**
+ * Allocation accounting per subsystem. When built with TRACK_MEMORY the
+ * global operator new and delete keep a small header in front of every
+ * block with its size and tag, so bytes are returned to the tag that
+ * allocated them no matter which thread frees them. The tag of new
+ * allocations is set per thread by MEMORY_SCOPE. Without TRACK_MEMORY all
+ * counters stay at zero and reports are empty.
+ */
+class MemoryTracker {
+
+	public:
+
+		/** Counters of single tag */
+		struct TagStats {
+
+				/** Bytes allocated and not freed yet */
+				unsigned m_liveBytes;
+
+				/** Blocks allocated and not freed yet */
+				unsigned m_liveAllocations;
+
+				/** All allocations made so far */
+				unsigned m_allocations;
+
+				TagStats() : m_liveBytes(0), m_liveAllocations(0), m_allocations(0) {}
+		};
+
+
+		/** @return True when built with allocation tracking */
+		static bool isEnabled();
+
+		/** @return Tag display name */
+		static const char *getTagName(MemoryTag p_tag);
+
+		static TagStats getStats(MemoryTag p_tag);
+
+		/** @return Tag of allocations made by calling thread */
+		static MemoryTag getTag();
+
+		/**
+		 * Sets tag of allocations made by calling thread.
+		 * @return Previous tag
+		 */
+		static MemoryTag setTag(MemoryTag p_tag);
+
+		/** Copies live totals into "mem" metrics */
+		static void publishMetrics();
+
+		/**
+		 * Logs memory of given tag which is still alive compared to the
+		 * baseline taken earlier. Logs nothing when all was freed.
+		 */
+		static void reportLeaks(MemoryTag p_tag, const TagStats &p_baseline, const CL_String &p_context);
+
+		/**
+		 * Writes live memory of every tag to the console. Used at process
+		 * exit when the logger is already gone.
+		 */
+		static void reportAll(const CL_String &p_context);
+
+	private:
+
+		MemoryTracker();
+};
+
+/** Tags allocations of calling thread for its own lifetime */
+class MemoryScope : public boost::noncopyable {
+
+	public:
+
+		explicit MemoryScope(MemoryTag p_tag) :
+			m_previous(MemoryTracker::setTag(p_tag))
+		{}
+
+		~MemoryScope()
+		{
+			MemoryTracker::setTag(m_previous);
+		}
+
+	private:
+
+		const MemoryTag m_previous;
+};
+
+} // namespace
+
+#if defined(TRACK_MEMORY)
+#define MEMORY_SCOPE_NAME(line) memoryScope_##line
+#define MEMORY_SCOPE_LINE(tag, line) Dbg::MemoryScope MEMORY_SCOPE_NAME(line)(tag)
+#define MEMORY_SCOPE(tag) MEMORY_SCOPE_LINE(tag, __LINE__)
+#else // TRACK_MEMORY
+#define MEMORY_SCOPE(tag)
+#endif // !TRACK_MEMORY
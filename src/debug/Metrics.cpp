@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Metrics.h"
+
+#include <assert.h>
+#include <string.h>
+
+namespace Dbg {
+
+Metrics::Metric Metrics::m_metrics[MAX_METRICS];
+
+unsigned Metrics::m_count = 0;
+
+const unsigned Metrics::MAX_METRICS;
+
+const unsigned Metrics::WINDOW;
+
+Metrics::Metric *Metrics::add(const char *p_name, Type p_type)
+{
+	for (unsigned i = 0; i < m_count; ++i) {
+		if (strcmp(m_metrics[i].m_name, p_name) == 0) {
+			assert(m_metrics[i].m_type == p_type && "metric registered with other type");
+			return &m_metrics[i];
+		}
+	}
+
+	assert(m_count < MAX_METRICS && "too many metrics");
+
+	Metric &metric = m_metrics[m_count++];
+
+	metric.m_name = p_name;
+	metric.m_type = p_type;
+	metric.m_count = 0;
+	metric.m_value = 0.0f;
+	metric.m_min = metric.m_max = 0.0f;
+	metric.m_lastMin = metric.m_lastMax = 0.0f;
+	metric.m_windowStart = 0;
+	metric.m_samples = 0;
+
+	return &metric;
+}
+
+const Metrics::Metric &Metrics::getMetric(unsigned p_index)
+{
+	assert(p_index < m_count && "index out of range");
+	return m_metrics[p_index];
+}
+
+CL_String8 Metrics::format(const Metric &p_metric)
+{
+	switch (p_metric.m_type) {
+		case T_COUNTER:
+			return CL_StringHelp::uint_to_local8(p_metric.m_count);
+		case T_GAUGE:
+			return CL_StringHelp::float_to_local8(p_metric.m_value);
+		case T_MIN_MAX:
+			return CL_StringHelp::float_to_local8(p_metric.m_lastMin) + " .. " + CL_StringHelp::float_to_local8(p_metric.m_lastMax);
+		default:
+			assert(0 && "unknown metric type");
+	}
+
+	return "";
+}
+
+void Metrics::formatAll(std::vector<CL_String8> &p_lines)
+{
+	p_lines.clear();
+
+	for (unsigned i = 0; i < m_count; ++i) {
+		const Metric &metric = m_metrics[i];
+		p_lines.push_back(CL_String8(metric.m_name) + ": " + format(metric));
+	}
+}
+
+void MinMax::record(float p_value) const
+{
+	Metrics::Metric &metric = *m_metric;
+	const unsigned now = CL_System::get_time();
+
+	if (now - metric.m_windowStart >= Metrics::WINDOW) {
+		// publish finished window
+		if (metric.m_samples > 0) {
+			metric.m_lastMin = metric.m_min;
+			metric.m_lastMax = metric.m_max;
+		}
+
+		metric.m_windowStart = now;
+		metric.m_samples = 0;
+	}
+
+	if (metric.m_samples == 0 || p_value < metric.m_min) {
+		metric.m_min = p_value;
+	}
+
+	if (metric.m_samples == 0 || p_value > metric.m_max) {
+		metric.m_max = p_value;
+	}
+
+	++metric.m_samples;
+}
+
+} // namespace
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <vector>
+#include <ClanLib/core.h>
+
+namespace Dbg {
+
+/**
+ * Registry of numeric metrics. Metrics are registered once through the
+ * typed handles below, usually as file-scope constants, and writing a
+ * value is a plain store. Formatting happens only when somebody reads
+ * the registry (debug overlay, server stats log).
+ */
+class Metrics {
+
+	public:
+
+		enum Type {
+			T_COUNTER,
+			T_GAUGE,
+			T_MIN_MAX
+		};
+
+		/** Registry storage of single metric */
+		struct Metric {
+
+				/** Display name */
+				const char *m_name;
+
+				Type m_type;
+
+				/** Counter value */
+				volatile unsigned m_count;
+
+				/** Gauge value */
+				volatile float m_value;
+
+				/** Min/max of the window being collected */
+				float m_min, m_max;
+
+				/** Min/max of last finished window */
+				volatile float m_lastMin, m_lastMax;
+
+				/** Current window start time */
+				unsigned m_windowStart;
+
+				/** Samples in current window */
+				unsigned m_samples;
+		};
+
+		/** Maximum number of metrics */
+		static const unsigned MAX_METRICS = 64;
+
+		/** Min/max window length in ms */
+		static const unsigned WINDOW = 1000;
+
+
+		/**
+		 * Registers metric. Registering existing name again gives the same
+		 * metric.
+		 */
+		static Metric *add(const char *p_name, Type p_type);
+
+		/** @return Number of registered metrics */
+		static unsigned getCount() { return m_count; }
+
+		/** @return Registered metric */
+		static const Metric &getMetric(unsigned p_index);
+
+		/** @return Metric value formatted for display */
+		static CL_String8 format(const Metric &p_metric);
+
+		/** Formats all metrics as "name: value" lines */
+		static void formatAll(std::vector<CL_String8> &p_lines);
+
+	private:
+
+		static Metric m_metrics[MAX_METRICS];
+
+		static unsigned m_count;
+
+		Metrics();
+};
+
+/** Monotonic event counter */
+class Counter {
+
+	public:
+
+		explicit Counter(const char *p_name) :
+			m_metric(Metrics::add(p_name, Metrics::T_COUNTER))
+		{}
+
+		void increment(unsigned p_count = 1) const { m_metric->m_count += p_count; }
+
+	private:
+
+		Metrics::Metric *const m_metric;
+};
+
+/** Last set value */
+class Gauge {
+
+	public:
+
+		explicit Gauge(const char *p_name) :
+			m_metric(Metrics::add(p_name, Metrics::T_GAUGE))
+		{}
+
+		void set(float p_value) const { m_metric->m_value = p_value; }
+
+	private:
+
+		Metrics::Metric *const m_metric;
+};
+
+/** Minimum and maximum of values recorded within last window */
+class MinMax {
+
+	public:
+
+		explicit MinMax(const char *p_name) :
+			m_metric(Metrics::add(p_name, Metrics::T_MIN_MAX))
+		{}
+
+		void record(float p_value) const;
+
+	private:
+
+		Metrics::Metric *const m_metric;
+};
+
+} // namespace
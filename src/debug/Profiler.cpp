@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Profiler.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <ClanLib/core.h>
+
+namespace Dbg {
+
+namespace {
+
+	/** Zone display names, in Zone order */
+	const char *ZONE_NAMES[Z_COUNT] = {
+		"scene update",
+		"logic",
+		"car physics",
+		"checkpoints",
+		"collisions",
+		"tyre stripes",
+		"draw",
+		"draw level",
+		"draw back blocks",
+		"draw fore blocks",
+		"draw sandpits",
+		"draw tire tracks",
+		"draw cars",
+		"draw smokes",
+		"draw ui",
+		"level load",
+		"gfx load",
+		"network event",
+		"packet send"
+	};
+
+	/** Samples written by a single thread */
+	struct ThreadLog {
+
+			Profiler::Sample m_ring[Profiler::RING_SIZE];
+
+			/** Total samples written, ring position is this modulo size */
+			volatile unsigned m_written;
+
+			/** Non zero while some thread records into this log */
+			volatile unsigned m_owned;
+	};
+
+	/** Logs are reused by next threads, samples of old ones stay in them */
+	ThreadLog s_logs[Profiler::MAX_THREADS];
+
+	/** Log of current thread, NULL when not assigned yet */
+	__thread ThreadLog *t_log = NULL;
+
+	/** Set when thread could not get its own log */
+	__thread bool t_noLog = false;
+
+	/** Zone nesting of current thread */
+	__thread unsigned t_depth = 0;
+
+	unsigned s_frameTimes[Profiler::FRAME_HISTORY];
+
+	volatile unsigned s_frameCount = 0;
+
+	unsigned s_lastFrame = 0;
+
+	ThreadLog *getThreadLog()
+	{
+		if (t_log == NULL && !t_noLog) {
+			for (unsigned slot = 0; slot < Profiler::MAX_THREADS; ++slot) {
+				if (__sync_bool_compare_and_swap(&s_logs[slot].m_owned, 0, 1)) {
+					t_log = &s_logs[slot];
+					break;
+				}
+			}
+
+			if (t_log == NULL) {
+				cl_log_event(LOG_ERROR, "Profiler: too many threads, samples dropped");
+				t_noLog = true;
+			}
+		}
+
+		return t_log;
+	}
+
+	unsigned percentile(std::vector<unsigned> &p_values, unsigned p_percent)
+	{
+		const unsigned index = (p_values.size() - 1) * p_percent / 100;
+		std::nth_element(p_values.begin(), p_values.begin() + index, p_values.end());
+
+		return p_values[index];
+	}
+
+} // namespace
+
+const unsigned Profiler::RING_SIZE;
+const unsigned Profiler::MAX_THREADS;
+const unsigned Profiler::FRAME_HISTORY;
+
+unsigned Profiler::now()
+{
+	return (unsigned) CL_System::get_microseconds();
+}
+
+const char *Profiler::getZoneName(Zone p_zone)
+{
+	assert(p_zone < Z_COUNT && "zone out of range");
+	return ZONE_NAMES[p_zone];
+}
+
+unsigned Profiler::enter()
+{
+	return t_depth++;
+}
+
+void Profiler::leave()
+{
+	assert(t_depth > 0 && "leave() without enter()");
+	--t_depth;
+}
+
+void Profiler::record(Zone p_zone, unsigned p_depth, unsigned p_start, unsigned p_duration)
+{
+	ThreadLog *log = getThreadLog();
+
+	if (log == NULL) {
+		return;
+	}
+
+	Sample &sample = log->m_ring[log->m_written % RING_SIZE];
+
+	sample.m_zone = p_zone;
+	sample.m_depth = p_depth;
+	sample.m_start = p_start;
+	sample.m_duration = p_duration;
+
+	__sync_synchronize();
+	++log->m_written;
+}
+
+void Profiler::releaseThread()
+{
+	if (t_log != NULL) {
+		__sync_synchronize();
+		t_log->m_owned = 0;
+		t_log = NULL;
+	}
+
+	t_noLog = false;
+}
+
+void Profiler::markFrame()
+{
+	const unsigned time = now();
+
+	if (s_lastFrame != 0) {
+		s_frameTimes[s_frameCount % FRAME_HISTORY] = time - s_lastFrame;
+		++s_frameCount;
+	}
+
+	s_lastFrame = time;
+}
+
+unsigned Profiler::getFrameTimes(unsigned p_times[FRAME_HISTORY])
+{
+	const unsigned frameCount = s_frameCount;
+	const unsigned count = std::min(frameCount, FRAME_HISTORY);
+
+	for (unsigned i = 0; i < count; ++i) {
+		p_times[i] = s_frameTimes[(frameCount - count + i) % FRAME_HISTORY];
+	}
+
+	return count;
+}
+
+void Profiler::calculateStats(ZoneStats p_stats[Z_COUNT])
+{
+	std::vector<unsigned> durations[Z_COUNT];
+
+	for (unsigned t = 0; t < MAX_THREADS; ++t) {
+		const ThreadLog &log = s_logs[t];
+		const unsigned written = log.m_written;
+		const unsigned count = std::min(written, RING_SIZE);
+
+		for (unsigned i = written - count; i != written; ++i) {
+			const Sample &sample = log.m_ring[i % RING_SIZE];
+			durations[sample.m_zone].push_back(sample.m_duration);
+		}
+	}
+
+	for (int z = 0; z < Z_COUNT; ++z) {
+		ZoneStats &stats = p_stats[z];
+		std::vector<unsigned> &values = durations[z];
+
+		stats.m_count = values.size();
+
+		if (!values.empty()) {
+			stats.m_p50 = percentile(values, 50);
+			stats.m_p99 = percentile(values, 99);
+		} else {
+			stats.m_p50 = stats.m_p99 = 0;
+		}
+	}
+}
+
+void Profiler::getPositions(unsigned p_positions[MAX_THREADS])
+{
+	for (unsigned t = 0; t < MAX_THREADS; ++t) {
+		p_positions[t] = s_logs[t].m_written;
+	}
+}
+
+unsigned Profiler::copySamples(unsigned p_positions[MAX_THREADS], std::vector<Sample> &p_samples, std::vector<unsigned> &p_threads)
+{
+	unsigned lost = 0;
+
+	for (unsigned t = 0; t < MAX_THREADS; ++t) {
+		const ThreadLog &log = s_logs[t];
+		const unsigned written = log.m_written;
+		const unsigned pending = written - p_positions[t];
+		const unsigned count = std::min(pending, RING_SIZE);
+
+		lost += pending - count;
+
+		for (unsigned i = written - count; i != written; ++i) {
+			p_samples.push_back(log.m_ring[i % RING_SIZE]);
+			p_threads.push_back(t);
+		}
+
+		p_positions[t] = written;
+	}
+
+	return lost;
+}
+
+} // namespace
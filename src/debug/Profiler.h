@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "boost/utility.hpp"
+
+namespace Dbg {
+
+/** Profiled code zones. Name table in Profiler.cpp must follow this order. */
+enum Zone {
+	Z_SCENE_UPDATE,
+	Z_LOGIC_UPDATE,
+	Z_CAR_PHYSICS,
+	Z_CHECKPOINTS,
+	Z_COLLISIONS,
+	Z_TYRE_STRIPES,
+	Z_DRAW,
+	Z_DRAW_LEVEL,
+	Z_DRAW_BACK_BLOCKS,
+	Z_DRAW_FORE_BLOCKS,
+	Z_DRAW_SANDPITS,
+	Z_DRAW_TIRE_TRACKS,
+	Z_DRAW_CARS,
+	Z_DRAW_SMOKES,
+	Z_DRAW_UI,
+	Z_LEVEL_LOAD,
+	Z_GFX_LOAD,
+	Z_EVENT,
+	Z_PACKET_SEND,
+	Z_COUNT
+};
+
+/**
+ * Hierarchical frame profiler. Every thread writes finished zone samples
+ * into its own ring buffer, so recording never takes a lock. Readers
+ * (debug overlay) look at the rings without synchronization and may get
+ * a slightly stale view, which is fine for statistics.
+ */
+class Profiler : public boost::noncopyable {
+
+	public:
+
+		/** Finished zone timing */
+		struct Sample {
+
+				/** Zone id */
+				Zone m_zone;
+
+				/** Nesting level, 0 for outermost zone */
+				unsigned m_depth;
+
+				/** Start time in microseconds */
+				unsigned m_start;
+
+				/** Duration in microseconds */
+				unsigned m_duration;
+		};
+
+		/** Rolling zone statistics */
+		struct ZoneStats {
+
+				/** Samples taken into account */
+				unsigned m_count;
+
+				/** Median duration in microseconds */
+				unsigned m_p50;
+
+				/** 99th percentile duration in microseconds */
+				unsigned m_p99;
+
+				ZoneStats() : m_count(0), m_p50(0), m_p99(0) {}
+		};
+
+		/** Samples kept per thread */
+		static const unsigned RING_SIZE = 4096;
+
+		/** Maximum number of recording threads */
+		static const unsigned MAX_THREADS = 8;
+
+		/** Frame times kept for the graph */
+		static const unsigned FRAME_HISTORY = 128;
+
+
+		/** @return Current time in microseconds */
+		static unsigned now();
+
+		/** @return Zone display name */
+		static const char *getZoneName(Zone p_zone);
+
+		/** Records finished zone on the calling thread */
+		static void record(Zone p_zone, unsigned p_depth, unsigned p_start, unsigned p_duration);
+
+		/**
+		 * Gives log of calling thread to the next thread that records.
+		 * Threads that come and go have to call it before they end.
+		 */
+		static void releaseThread();
+
+		/** Marks start of new rendered frame, feeds the frame-time graph */
+		static void markFrame();
+
+		/** Calculates p50/p99 from samples currently held in all rings */
+		static void calculateStats(ZoneStats p_stats[Z_COUNT]);
+
+		/**
+		 * Copies frame times in microseconds, oldest first.
+		 * @return Number of copied values, at most FRAME_HISTORY
+		 */
+		static unsigned getFrameTimes(unsigned p_times[FRAME_HISTORY]);
+
+		/** Stores current write position of every thread log */
+		static void getPositions(unsigned p_positions[MAX_THREADS]);
+
+		/**
+		 * Copies samples written since given positions, oldest first per
+		 * thread, and moves the positions past them.
+		 * @param p_threads Receives owning thread slot for each sample.
+		 * @return Number of samples overwritten before they were copied
+		 */
+		static unsigned copySamples(unsigned p_positions[MAX_THREADS], std::vector<Sample> &p_samples, std::vector<unsigned> &p_threads);
+
+		/** @return Current zone nesting of calling thread, incremented */
+		static unsigned enter();
+
+		/** Leaves zone on calling thread */
+		static void leave();
+
+	private:
+
+		Profiler() {}
+};
+
+/** Times its own lifetime as given zone */
+class ScopedTimer : public boost::noncopyable {
+
+	public:
+
+		explicit ScopedTimer(Zone p_zone) :
+			m_zone(p_zone),
+			m_depth(Profiler::enter()),
+			m_start(Profiler::now())
+		{}
+
+		~ScopedTimer()
+		{
+			const unsigned end = Profiler::now();
+
+			Profiler::leave();
+			Profiler::record(m_zone, m_depth, m_start, end - m_start);
+		}
+
+	private:
+
+		const Zone m_zone;
+
+		const unsigned m_depth;
+
+		const unsigned m_start;
+};
+
+} // namespace
+
+#if !defined(NO_PROFILER)
+#define PROFILE_ZONE_NAME(line) profileZone_##line
+#define PROFILE_ZONE_LINE(zone, line) Dbg::ScopedTimer PROFILE_ZONE_NAME(line)(zone)
+#define PROFILE_ZONE(zone) PROFILE_ZONE_LINE(zone, __LINE__)
+#else // !NO_PROFILER
+#define PROFILE_ZONE(zone)
+#endif // NO_PROFILER
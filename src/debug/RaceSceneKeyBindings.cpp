@@ -28,7 +28,8 @@
 
 #include "RaceSceneKeyBindings.h"
 
-#include "common/Properties.h"
+#include "debug/DebugProperties.h"
+#include "debug/TraceRecorder.h"
 
 namespace Dbg {
 
@@ -46,27 +47,25 @@ void RaceSceneKeyBindings::handleInput(bool p_pressed, const CL_InputEvent& p_ev
 		switch (p_event.id) {
 			case CL_KEY_F1:
 			{
-				int iterationSpeed = Properties::getPropertyAsInt("dbg_iterSpeed", 100);
+				const int iterationSpeed = ITER_SPEED.get();
 				if (iterationSpeed > 0) {
-					--iterationSpeed;
-
-					cl_log_event("debug", "Iteration speed decreased to %1", iterationSpeed);
-					Properties::setProperty("dbg_iterSpeed", iterationSpeed);
+					ITER_SPEED.set(iterationSpeed - 1);
 				}
 				break;
 			}
 
 			case CL_KEY_F2:
 			{
-				int iterationSpeed = Properties::getPropertyAsInt("dbg_iterSpeed", 100);
+				const int iterationSpeed = ITER_SPEED.get();
 				if (iterationSpeed < 300) {
-					++iterationSpeed;
-
-					cl_log_event("debug", "Iteration speed increased to %1", iterationSpeed);
-					Properties::setProperty("dbg_iterSpeed", iterationSpeed);
+					ITER_SPEED.set(iterationSpeed + 1);
 				}
 				break;
 			}
+
+			case CL_KEY_F3:
+				Dbg::TraceRecorder::arm();
+				break;
 		}
 	}
 }
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "TraceRecorder.h"
+
+#include "debug/DebugProperties.h"
+
+namespace Dbg {
+
+/** Directory for trace files */
+const CL_String TRACE_DIR = "traces";
+
+bool TraceRecorder::m_armed = false;
+
+unsigned TraceRecorder::m_startTime = 0;
+
+unsigned TraceRecorder::m_duration = 0;
+
+bool TraceRecorder::m_propertyChecked = false;
+
+unsigned TraceRecorder::m_positions[Profiler::MAX_THREADS];
+
+std::vector<Profiler::Sample> TraceRecorder::m_samples;
+
+std::vector<unsigned> TraceRecorder::m_threads;
+
+unsigned TraceRecorder::m_lost = 0;
+
+const unsigned TraceRecorder::DEFAULT_DURATION;
+
+const unsigned TraceRecorder::MAX_DURATION;
+
+void TraceRecorder::arm(unsigned p_duration)
+{
+	m_armed = true;
+	m_startTime = Profiler::now();
+	m_duration = cl_min(p_duration, MAX_DURATION) * 1000;
+
+	Profiler::getPositions(m_positions);
+	m_samples.clear();
+	m_threads.clear();
+	m_lost = 0;
+
+	cl_log_event("debug", "Trace recording armed for %1 ms", m_duration / 1000);
+}
+
+void TraceRecorder::update()
+{
+	if (!m_propertyChecked) {
+		const int duration = TRACE_DURATION.get();
+
+		if (duration > 0) {
+			arm(duration);
+		}
+
+		m_propertyChecked = true;
+	}
+
+	if (!m_armed) {
+		return;
+	}
+
+	collect();
+
+	if (Profiler::now() - m_startTime >= m_duration) {
+		m_armed = false;
+
+		try {
+			write();
+		} catch (CL_Exception e) {
+			cl_log_event(LOG_ERROR, "Cannot write trace: %1", e.message);
+		}
+
+		// give back window memory
+		std::vector<Profiler::Sample>().swap(m_samples);
+		std::vector<unsigned>().swap(m_threads);
+	}
+}
+
+void TraceRecorder::collect()
+{
+	m_lost += Profiler::copySamples(m_positions, m_samples, m_threads);
+}
+
+void TraceRecorder::write()
+{
+	if (m_lost > 0) {
+		cl_log_event(LOG_ERROR, "Trace lost %1 samples overwritten in profiler rings", m_lost);
+	}
+
+	CL_String8 json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	bool first = true;
+	unsigned written = 0;
+
+	for (unsigned i = 0; i < m_samples.size(); ++i) {
+		const Profiler::Sample &sample = m_samples[i];
+		const unsigned offset = sample.m_start - m_startTime;
+
+		// skip samples from before the window, wrapped offset is huge
+		if (offset > m_duration) {
+			continue;
+		}
+
+		if (!first) {
+			json += ",";
+		}
+
+		json += cl_format(
+				"{\"name\":\"%1\",\"cat\":\"zone\",\"ph\":\"X\",\"pid\":1,\"tid\":%2,\"ts\":%3,\"dur\":%4}",
+				CL_String8(Profiler::getZoneName(sample.m_zone)),
+				m_threads[i],
+				offset,
+				sample.m_duration
+		);
+
+		first = false;
+		++written;
+	}
+
+	json += "]}";
+
+	CL_Directory::create(TRACE_DIR);
+
+	const CL_String filename = cl_format("%1/trace_%2.json", TRACE_DIR, CL_System::get_time());
+	CL_File file(filename, CL_File::create_always, CL_File::access_write);
+	file.write(json.data(), json.size());
+
+	cl_log_event("debug", "Trace with %1 events written to %2", written, filename);
+}
+
+} // namespace
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <vector>
+#include <ClanLib/core.h>
+
+#include "debug/Profiler.h"
+
+namespace Dbg {
+
+/**
+ * Writes profiler zones of a time window as Chrome trace-event JSON,
+ * loadable in chrome://tracing or Perfetto. Samples are copied out of
+ * the profiler rings on every update while armed, so the whole window is
+ * kept as long as no thread fills its ring between two updates.
+ *
+ * Recording can be armed at startup with -Pdbg_trace=<ms>.
+ */
+class TraceRecorder {
+
+	public:
+
+		/** Default window length in ms */
+		static const unsigned DEFAULT_DURATION = 3000;
+
+		/** Longest window in ms */
+		static const unsigned MAX_DURATION = 10000;
+
+
+		/** Starts recording window of given length. Restarts when armed. */
+		static void arm(unsigned p_duration = DEFAULT_DURATION);
+
+		/** @return true when window is being recorded */
+		static bool isArmed() { return m_armed; }
+
+		/**
+		 * Call periodically from the main loop. Arms on dbg_trace property
+		 * and writes the trace file when window closes.
+		 */
+		static void update();
+
+	private:
+
+		/** Recording state */
+		static bool m_armed;
+
+		/** Window start in profiler time */
+		static unsigned m_startTime;
+
+		/** Window length in microseconds */
+		static unsigned m_duration;
+
+		/** Set after dbg_trace property was checked */
+		static bool m_propertyChecked;
+
+		/** Profiler ring positions copied so far */
+		static unsigned m_positions[Profiler::MAX_THREADS];
+
+		/** Samples copied in current window */
+		static std::vector<Profiler::Sample> m_samples;
+
+		/** Thread slot of each copied sample */
+		static std::vector<unsigned> m_threads;
+
+		/** Samples overwritten before they were copied */
+		static unsigned m_lost;
+
+
+		/** Copies samples recorded since last call */
+		static void collect();
+
+
+		static void write();
+
+		TraceRecorder();
+};
+
+} // namespace
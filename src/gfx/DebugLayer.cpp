@@ -28,7 +28,29 @@
 
 #include "DebugLayer.h"
 
-DebugLayer::DebugLayer()
+#include <algorithm>
+
+#include "debug/MemoryTracker.h"
+#include "debug/Metrics.h"
+
+/** Metrics text refresh period in ms */
+const unsigned METRICS_REFRESH_PERIOD = 250;
+
+/** Profiler statistics refresh period in ms */
+const unsigned STATS_REFRESH_PERIOD = 500;
+
+/** Frame graph height in pixels for 1/30 s frame */
+const int FRAME_GRAPH_HEIGHT = 66;
+
+/** Frame time in microseconds at which graph reaches its height */
+const unsigned FRAME_GRAPH_SCALE = 33333;
+
+/** Target frame time in microseconds */
+const unsigned FRAME_TARGET = 16667;
+
+DebugLayer::DebugLayer() :
+	m_lastMetricsTime(0),
+	m_lastStatsTime(0)
 {
 
 }
@@ -47,8 +69,74 @@ void DebugLayer::draw(CL_GraphicContext &p_gc) {
 	int y = 15;
 	const int margin = 0;
 
-	for (std::map<CL_String, CL_String>::iterator itor = m_messages.begin(); itor != m_messages.end(); ++itor) {
-		m_font.draw_text(p_gc, x, y, itor->first + ": " + itor->second, CL_Colorf::white);
+	const unsigned now = CL_System::get_time();
+
+	// values change every tick, text does not need to
+	if (now - m_lastMetricsTime >= METRICS_REFRESH_PERIOD) {
+		Dbg::MemoryTracker::publishMetrics();
+		Dbg::Metrics::formatAll(m_metricLines);
+		m_lastMetricsTime = now;
+	}
+
+	foreach (const CL_String8 &line, m_metricLines) {
+		m_font.draw_text(p_gc, x, y, line, CL_Colorf::white);
 		y += m_fontMetrics.get_height() + margin;
 	}
+
+	drawProfilerStats(p_gc, x, y + m_fontMetrics.get_height());
+	drawFrameGraph(p_gc);
+}
+
+void DebugLayer::drawProfilerStats(CL_GraphicContext &p_gc, int p_x, int p_y)
+{
+	const unsigned now = CL_System::get_time();
+
+	// sorting all samples is too heavy for every frame
+	if (now - m_lastStatsTime >= STATS_REFRESH_PERIOD) {
+		Dbg::Profiler::calculateStats(m_zoneStats);
+		m_lastStatsTime = now;
+	}
+
+	m_font.draw_text(p_gc, p_x, p_y, "zone: p50 / p99 [us]", CL_Colorf::yellow);
+	p_y += m_fontMetrics.get_height();
+
+	for (int i = 0; i < Dbg::Z_COUNT; ++i) {
+		const Dbg::Profiler::ZoneStats &stats = m_zoneStats[i];
+
+		if (stats.m_count == 0) {
+			continue;
+		}
+
+		m_font.draw_text(
+				p_gc, p_x, p_y,
+				cl_format("%1: %2 / %3", CL_String(Dbg::Profiler::getZoneName((Dbg::Zone) i)), stats.m_p50, stats.m_p99),
+				CL_Colorf::white
+		);
+
+		p_y += m_fontMetrics.get_height();
+	}
+}
+
+void DebugLayer::drawFrameGraph(CL_GraphicContext &p_gc)
+{
+	unsigned frameTimes[Dbg::Profiler::FRAME_HISTORY];
+	const unsigned count = Dbg::Profiler::getFrameTimes(frameTimes);
+
+	const int left = 5;
+	const int bottom = p_gc.get_height() - 5;
+	const int width = Dbg::Profiler::FRAME_HISTORY * 2;
+
+	CL_Draw::fill(p_gc, left, bottom - FRAME_GRAPH_HEIGHT, left + width, bottom, CL_Colorf(0.0f, 0.0f, 0.0f, 0.5f));
+
+	for (unsigned i = 0; i < count; ++i) {
+		const unsigned time = std::min(frameTimes[i], FRAME_GRAPH_SCALE);
+		const int height = time * FRAME_GRAPH_HEIGHT / FRAME_GRAPH_SCALE;
+		const int x = left + i * 2;
+
+		CL_Draw::line(p_gc, x, bottom, x, bottom - height, frameTimes[i] > FRAME_TARGET ? CL_Colorf::red : CL_Colorf::green);
+	}
+
+	// target frame time marker
+	const int targetY = bottom - FRAME_TARGET * FRAME_GRAPH_HEIGHT / FRAME_GRAPH_SCALE;
+	CL_Draw::line(p_gc, left, targetY, left + width, targetY, CL_Colorf::yellow);
 }
@@ -28,7 +28,9 @@
 
 #pragma once
 
+#include <vector>
 #include <ClanLib/core.h>
+#include "debug/Profiler.h"
 #include "gfx/Drawable.h"
 
 class DebugLayer : public Gfx::Drawable {
@@ -38,17 +40,28 @@ class DebugLayer : public Gfx::Drawable {
 
 		virtual void draw(CL_GraphicContext &p_gc);
 
-		void putMessage(const CL_String8 &p_key, const CL_String8 &p_value) { m_messages[p_key] = p_value; }
-		void removeMessage(const CL_String8 &p_key) { m_messages.erase(m_messages.find(p_key)); }
-
 	private:
-		/** Debug messages */
-		::std::map<CL_String8, CL_String8> m_messages;
+		/** Metrics formatted at last refresh */
+		std::vector<CL_String8> m_metricLines;
+
+		/** Last metrics refresh time */
+		unsigned m_lastMetricsTime;
 
 		/** Display font */
 		CL_Font m_font;
 
 		/** Font metrics */
 		CL_FontMetrics m_fontMetrics;
+
+		/** Profiler zone statistics */
+		Dbg::Profiler::ZoneStats m_zoneStats[Dbg::Z_COUNT];
+
+		/** Last zone statistics refresh time */
+		unsigned m_lastStatsTime;
+
+
+		void drawProfilerStats(CL_GraphicContext &p_gc, int p_x, int p_y);
+
+		void drawFrameGraph(CL_GraphicContext &p_gc);
 };
 
@@ -30,7 +30,9 @@
 
 #include "gfx/Scene.h"
 #include "gfx/Stage.h"
-#include "common/Properties.h"
+#include "debug/DebugProperties.h"
+#include "debug/Profiler.h"
+#include "debug/TraceRecorder.h"
 
 GameWindow::GameWindow(CL_GUIManager *p_manager, const CL_DisplayWindowDescription &p_desc) :
 	CL_Window(p_manager, p_desc),
@@ -56,6 +58,9 @@ void GameWindow::repaint()
 
 void GameWindow::onRender(CL_GraphicContext &p_gc, const CL_Rect &p_clipRect)
 {
+	Dbg::Profiler::markFrame();
+	Dbg::TraceRecorder::update();
+
 	Scene *scene = Gfx::Stage::peekScene();
 
 	updateLogic(scene);
@@ -66,6 +71,8 @@ void GameWindow::updateLogic(Scene *p_scene)
 {
 //	CL_KeepAlive::process();
 
+	PROFILE_ZONE(Dbg::Z_SCENE_UPDATE);
+
 	if (p_scene != NULL) {
 
 		if (p_scene != m_lastScene) {
@@ -92,7 +99,7 @@ void GameWindow::updateLogic(Scene *p_scene)
 #if !defined(NDEBUG)
 			// apply iteration time change
 			static float timeChangeF = 0.0f;
-			const int iterSpeed = Properties::getPropertyAsInt("dbg_iterSpeed", 100);
+			const int iterSpeed = Dbg::ITER_SPEED.get();
 
 			timeChangeF += timeChange * (iterSpeed / 100.0f);
 
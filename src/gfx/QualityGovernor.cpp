@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "QualityGovernor.h"
+
+#include <assert.h>
+
+namespace Gfx {
+
+namespace {
+
+	/** Settings in Level order */
+	const QualityGovernor::Settings SETTINGS[QualityGovernor::QL_COUNT] = {
+		{ 100, 30, 100, 1, false },
+		{ 50, 80, 400, 2, true },
+		{ 25, 200, 2000, QualityGovernor::MAX_DECORATIONS_PER_BLOCK, true }
+	};
+
+	/** Window average over budget in percents which counts as overload */
+	const unsigned OVER_BUDGET = 100;
+
+	/** Window average below budget in percents which counts as headroom */
+	const unsigned HEADROOM = 60;
+
+} // namespace
+
+const unsigned QualityGovernor::MAX_DECORATIONS_PER_BLOCK;
+const unsigned QualityGovernor::WINDOW_FRAMES;
+const unsigned QualityGovernor::DOWNGRADE_WINDOWS;
+const unsigned QualityGovernor::UPGRADE_WINDOWS;
+const unsigned QualityGovernor::MAX_UPGRADE_WINDOWS;
+
+QualityGovernor::QualityGovernor() :
+	m_budget(0),
+	m_level(QL_HIGH),
+	m_windowTime(0),
+	m_windowFrames(0),
+	m_overWindows(0),
+	m_headroomWindows(0),
+	m_upgradeWindows(UPGRADE_WINDOWS),
+	m_windowsSinceUpgrade(MAX_UPGRADE_WINDOWS)
+{
+}
+
+const QualityGovernor::Settings &QualityGovernor::getSettings(Level p_level)
+{
+	assert(p_level >= QL_LOW && p_level < QL_COUNT && "bad quality level");
+	return SETTINGS[p_level];
+}
+
+void QualityGovernor::setBudget(unsigned p_budget)
+{
+	m_budget = p_budget;
+
+	m_windowTime = 0;
+	m_windowFrames = 0;
+	m_overWindows = 0;
+	m_headroomWindows = 0;
+	m_upgradeWindows = UPGRADE_WINDOWS;
+	m_windowsSinceUpgrade = MAX_UPGRADE_WINDOWS;
+
+	if (m_budget == 0) {
+		m_level = QL_HIGH;
+	}
+}
+
+bool QualityGovernor::addFrame(unsigned p_frameTime)
+{
+	if (m_budget == 0) {
+		return false;
+	}
+
+	m_windowTime += p_frameTime;
+
+	if (++m_windowFrames < WINDOW_FRAMES) {
+		return false;
+	}
+
+	const unsigned average = m_windowTime / m_windowFrames;
+	const Level previous = m_level;
+
+	m_windowTime = 0;
+	m_windowFrames = 0;
+
+	if (m_windowsSinceUpgrade < MAX_UPGRADE_WINDOWS) {
+		++m_windowsSinceUpgrade;
+	}
+
+	if (average * 100 > m_budget * OVER_BUDGET) {
+		m_headroomWindows = 0;
+
+		if (++m_overWindows >= DOWNGRADE_WINDOWS && m_level > QL_LOW) {
+
+			// upgrade did not hold, be more careful next time
+			if (m_windowsSinceUpgrade < m_upgradeWindows) {
+				m_upgradeWindows = m_upgradeWindows * 2 < MAX_UPGRADE_WINDOWS ? m_upgradeWindows * 2 : MAX_UPGRADE_WINDOWS;
+			} else {
+				m_upgradeWindows = UPGRADE_WINDOWS;
+			}
+
+			setLevel((Level) (m_level - 1));
+		}
+
+	} else if (average * 100 < m_budget * HEADROOM) {
+		m_overWindows = 0;
+
+		if (++m_headroomWindows >= m_upgradeWindows && m_level < QL_HIGH) {
+			setLevel((Level) (m_level + 1));
+			m_windowsSinceUpgrade = 0;
+		}
+
+	} else {
+		m_overWindows = 0;
+		m_headroomWindows = 0;
+	}
+
+	return m_level != previous;
+}
+
+void QualityGovernor::setLevel(Level p_level)
+{
+	m_level = p_level;
+
+	m_overWindows = 0;
+	m_headroomWindows = 0;
+}
+
+} // namespace
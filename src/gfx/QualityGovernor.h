@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+namespace Gfx {
+
+/**
+ * Picks visual quality from recent frame work times. Frame times are
+ * averaged over windows of WINDOW_FRAMES frames. Quality drops after
+ * DOWNGRADE_WINDOWS windows over budget and rises only after a longer run
+ * of windows with plenty of headroom. Each upgrade which has to be taken
+ * back soon doubles the headroom run needed for the next one, so quality
+ * does not oscillate around the budget.
+ */
+class QualityGovernor {
+
+	public:
+
+		enum Level {
+			QL_LOW,
+			QL_MEDIUM,
+			QL_HIGH,
+			QL_COUNT
+		};
+
+		/** What race graphics may spend on effects */
+		struct Settings {
+
+				/** Minimal time between two smokes in ms */
+				unsigned m_smokePeriod;
+
+				/** Maximum number of live smokes */
+				unsigned m_smokeLimit;
+
+				/** Maximum number of drawn tyre stripes, newest are kept */
+				unsigned m_stripeLimit;
+
+				/** Drawn decorations of every level block */
+				unsigned m_decorationsPerBlock;
+
+				bool m_multisampling;
+		};
+
+		/** Decorations loaded for every level block */
+		static const unsigned MAX_DECORATIONS_PER_BLOCK = 3;
+
+		/** Frames averaged before quality is considered */
+		static const unsigned WINDOW_FRAMES = 30;
+
+		/** Windows over budget needed to lower the quality */
+		static const unsigned DOWNGRADE_WINDOWS = 2;
+
+		/** Windows with headroom needed to raise the quality */
+		static const unsigned UPGRADE_WINDOWS = 8;
+
+		/** Upper bound of upgrade run after repeated backoffs */
+		static const unsigned MAX_UPGRADE_WINDOWS = 128;
+
+
+		QualityGovernor();
+
+		/** @return Settings of given quality level */
+		static const Settings &getSettings(Level p_level);
+
+		const Settings &getSettings() const { return getSettings(m_level); }
+
+		Level getLevel() const { return m_level; }
+
+		/**
+		 * Sets frame budget in microseconds. Zero disables the governor
+		 * and restores the highest quality.
+		 */
+		void setBudget(unsigned p_budget);
+
+		/**
+		 * Feeds work time of finished frame in microseconds.
+		 * @return True when quality level has changed
+		 */
+		bool addFrame(unsigned p_frameTime);
+
+	private:
+
+		/** Frame budget in microseconds, 0 when disabled */
+		unsigned m_budget;
+
+		Level m_level;
+
+		/** Current window */
+		unsigned m_windowTime, m_windowFrames;
+
+		/** Consecutive windows over budget and with headroom */
+		unsigned m_overWindows, m_headroomWindows;
+
+		/** Headroom windows needed for next upgrade */
+		unsigned m_upgradeWindows;
+
+		/** Windows since last upgrade */
+		unsigned m_windowsSinceUpgrade;
+
+		void setLevel(Level p_level);
+};
+
+} // namespace
@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "RenderDevice.h"
+
+#include <assert.h>
+
+#include "gfx/TextureAtlas.h"
+
+namespace Gfx {
+
+RenderDevice::RenderDevice() :
+	m_boundAtlas(NULL),
+	m_boundPage(0),
+	m_blendMode(BM_NORMAL)
+{
+}
+
+RenderDevice::~RenderDevice()
+{
+}
+
+void RenderDevice::beginFrame()
+{
+	m_stats = Stats();
+	m_boundAtlas = NULL;
+	m_blendMode = BM_NORMAL;
+}
+
+void RenderDevice::bindTexture(const TextureAtlas &p_atlas, unsigned p_page)
+{
+	if (m_boundAtlas == &p_atlas && m_boundPage == p_page) {
+		return;
+	}
+
+	doBindTexture(p_atlas, p_page);
+
+	m_boundAtlas = &p_atlas;
+	m_boundPage = p_page;
+	++m_stats.m_textureBinds;
+}
+
+void RenderDevice::resetTexture()
+{
+	if (m_boundAtlas != NULL) {
+		doResetTexture();
+		m_boundAtlas = NULL;
+	}
+}
+
+void RenderDevice::setBlendMode(BlendMode p_blendMode)
+{
+	if (m_blendMode != p_blendMode) {
+		doSetBlendMode(p_blendMode);
+		m_blendMode = p_blendMode;
+	}
+}
+
+void RenderDevice::drawTriangles(const CL_Vec2f *p_positions, const CL_Vec2f *p_texCoords, const CL_Vec4f *p_colors, unsigned p_vertexCount)
+{
+	assert(m_boundAtlas != NULL && "no texture bound");
+
+	doDrawTriangles(p_positions, p_texCoords, p_colors, p_vertexCount);
+
+	++m_stats.m_drawCalls;
+	m_stats.m_vertices += p_vertexCount;
+}
+
+void RenderDevice::drawLine(const CL_Pointf &p_from, const CL_Pointf &p_to, float p_width, const CL_Colorf &p_color)
+{
+	doDrawLine(p_from, p_to, p_width, p_color);
+
+	++m_stats.m_drawCalls;
+	++m_stats.m_lines;
+	m_stats.m_vertices += 2;
+}
+
+void RenderDevice::drawLines(const CL_Vec2f *p_points, unsigned p_pointCount, float p_width, const CL_Colorf &p_color)
+{
+	assert(p_pointCount % 2 == 0 && "line list needs point pairs");
+
+	if (p_pointCount == 0) {
+		return;
+	}
+
+	doDrawLines(p_points, p_pointCount, p_width, p_color);
+
+	++m_stats.m_drawCalls;
+	m_stats.m_lines += p_pointCount / 2;
+	m_stats.m_vertices += p_pointCount;
+}
+
+//
+// ClanLib backend
+//
+
+void ClanLibRenderDevice::doBindTexture(const TextureAtlas &p_atlas, unsigned p_page)
+{
+	m_gc.set_texture(0, p_atlas.getPage(p_page));
+}
+
+void ClanLibRenderDevice::doResetTexture()
+{
+	m_gc.reset_texture(0);
+}
+
+void ClanLibRenderDevice::doSetBlendMode(BlendMode p_blendMode)
+{
+	if (p_blendMode == BM_ADDITIVE) {
+		CL_BlendMode blendMode;
+		blendMode.set_blend_function(cl_blend_src_alpha, cl_blend_one, cl_blend_src_alpha, cl_blend_one);
+
+		m_gc.set_blend_mode(blendMode);
+	} else {
+		m_gc.reset_blend_mode();
+	}
+}
+
+void ClanLibRenderDevice::doDrawTriangles(const CL_Vec2f *p_positions, const CL_Vec2f *p_texCoords, const CL_Vec4f *p_colors, unsigned p_vertexCount)
+{
+	CL_PrimitivesArray primitives(m_gc);
+	primitives.set_attributes(0, p_positions);
+	primitives.set_attributes(1, p_colors);
+	primitives.set_attributes(2, p_texCoords);
+
+	m_gc.set_program_object(cl_program_single_texture);
+	m_gc.draw_primitives(cl_triangles, p_vertexCount, primitives);
+	m_gc.reset_program_object();
+}
+
+void ClanLibRenderDevice::doDrawLine(const CL_Pointf &p_from, const CL_Pointf &p_to, float p_width, const CL_Colorf &p_color)
+{
+	CL_Pen pen;
+	pen.set_line_width(p_width);
+	m_gc.set_pen(pen);
+
+	CL_Draw::line(m_gc, p_from, p_to, p_color);
+}
+
+void ClanLibRenderDevice::doDrawLines(const CL_Vec2f *p_points, unsigned p_pointCount, float p_width, const CL_Colorf &p_color)
+{
+	m_lineColors.assign(p_pointCount, CL_Vec4f(p_color.r, p_color.g, p_color.b, p_color.a));
+
+	CL_Pen pen;
+	pen.set_line_width(p_width);
+	m_gc.set_pen(pen);
+
+	CL_PrimitivesArray primitives(m_gc);
+	primitives.set_attributes(0, p_points);
+	primitives.set_attributes(1, &m_lineColors[0]);
+
+	m_gc.set_program_object(cl_program_color_only);
+	m_gc.draw_primitives(cl_lines, p_pointCount, primitives);
+	m_gc.reset_program_object();
+}
+
+} // namespace
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <vector>
+#include <ClanLib/core.h>
+#include <ClanLib/display.h>
+
+#include "boost/utility.hpp"
+
+namespace Gfx {
+
+class TextureAtlas;
+
+/**
+ * Thin render command interface used by race graphics. Counts submitted
+ * work, so draw-call regressions show up with any backend. Backends
+ * implement the protected do* methods.
+ */
+class RenderDevice : public boost::noncopyable {
+
+	public:
+
+		enum BlendMode {
+			BM_NORMAL,
+			BM_ADDITIVE
+		};
+
+		/** Work submitted since beginFrame() */
+		struct Stats {
+
+				unsigned m_drawCalls;
+
+				unsigned m_textureBinds;
+
+				unsigned m_vertices;
+
+				unsigned m_lines;
+
+				Stats() : m_drawCalls(0), m_textureBinds(0), m_vertices(0), m_lines(0) {}
+		};
+
+
+		RenderDevice();
+
+		virtual ~RenderDevice();
+
+
+		/** Resets statistics and bound state */
+		void beginFrame();
+
+		const Stats &getStats() const { return m_stats; }
+
+
+		/** Binds atlas page for following triangles. Same page is not bound again. */
+		void bindTexture(const TextureAtlas &p_atlas, unsigned p_page);
+
+		/** Unbinds texture, next bindTexture() always binds */
+		void resetTexture();
+
+		void setBlendMode(BlendMode p_blendMode);
+
+		/** Draws textured triangle list with bound texture */
+		void drawTriangles(const CL_Vec2f *p_positions, const CL_Vec2f *p_texCoords, const CL_Vec4f *p_colors, unsigned p_vertexCount);
+
+		void drawLine(const CL_Pointf &p_from, const CL_Pointf &p_to, float p_width, const CL_Colorf &p_color);
+
+		/** Draws line list in one call, every two points make a line */
+		void drawLines(const CL_Vec2f *p_points, unsigned p_pointCount, float p_width, const CL_Colorf &p_color);
+
+	protected:
+
+		virtual void doBindTexture(const TextureAtlas &p_atlas, unsigned p_page) = 0;
+
+		virtual void doResetTexture() = 0;
+
+		virtual void doSetBlendMode(BlendMode p_blendMode) = 0;
+
+		virtual void doDrawTriangles(const CL_Vec2f *p_positions, const CL_Vec2f *p_texCoords, const CL_Vec4f *p_colors, unsigned p_vertexCount) = 0;
+
+		virtual void doDrawLine(const CL_Pointf &p_from, const CL_Pointf &p_to, float p_width, const CL_Colorf &p_color) = 0;
+
+		virtual void doDrawLines(const CL_Vec2f *p_points, unsigned p_pointCount, float p_width, const CL_Colorf &p_color) = 0;
+
+	private:
+
+		Stats m_stats;
+
+		/** Bound atlas, NULL when no texture is bound */
+		const TextureAtlas *m_boundAtlas;
+
+		unsigned m_boundPage;
+
+		BlendMode m_blendMode;
+};
+
+/** Backend that only counts commands. Needs no graphic context. */
+class NullRenderDevice : public RenderDevice {
+
+	protected:
+
+		virtual void doBindTexture(const TextureAtlas &p_atlas, unsigned p_page) {}
+
+		virtual void doResetTexture() {}
+
+		virtual void doSetBlendMode(BlendMode p_blendMode) {}
+
+		virtual void doDrawTriangles(const CL_Vec2f *p_positions, const CL_Vec2f *p_texCoords, const CL_Vec4f *p_colors, unsigned p_vertexCount) {}
+
+		virtual void doDrawLine(const CL_Pointf &p_from, const CL_Pointf &p_to, float p_width, const CL_Colorf &p_color) {}
+
+		virtual void doDrawLines(const CL_Vec2f *p_points, unsigned p_pointCount, float p_width, const CL_Colorf &p_color) {}
+};
+
+/** Backend drawing with ClanLib graphic context */
+class ClanLibRenderDevice : public RenderDevice {
+
+	public:
+
+		/** Sets context used by following commands */
+		void setGraphicContext(CL_GraphicContext &p_gc) { m_gc = p_gc; }
+
+	protected:
+
+		virtual void doBindTexture(const TextureAtlas &p_atlas, unsigned p_page);
+
+		virtual void doResetTexture();
+
+		virtual void doSetBlendMode(BlendMode p_blendMode);
+
+		virtual void doDrawTriangles(const CL_Vec2f *p_positions, const CL_Vec2f *p_texCoords, const CL_Vec4f *p_colors, unsigned p_vertexCount);
+
+		virtual void doDrawLine(const CL_Pointf &p_from, const CL_Pointf &p_to, float p_width, const CL_Colorf &p_color);
+
+		virtual void doDrawLines(const CL_Vec2f *p_points, unsigned p_pointCount, float p_width, const CL_Colorf &p_color);
+
+	private:
+
+		CL_GraphicContext m_gc;
+
+		/** Per vertex colors of line lists */
+		std::vector<CL_Vec4f> m_lineColors;
+};
+
+} // namespace
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "SpriteBatch.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+
+namespace Gfx {
+
+SpriteBatch::SpriteBatch(const TextureAtlas &p_atlas) :
+	m_atlas(p_atlas)
+{
+}
+
+SpriteBatch::~SpriteBatch()
+{
+}
+
+void SpriteBatch::add(
+		const TextureAtlas::Region &p_region,
+		const CL_Pointf &p_position,
+		const CL_Angle &p_angle,
+		float p_scale,
+		const CL_Colorf &p_color,
+		BlendMode p_blendMode
+)
+{
+	const CL_Sizef size(p_region.m_size.width * p_scale, p_region.m_size.height * p_scale);
+
+	CL_Pointf center(p_position);
+
+	if (!p_region.m_centered) {
+		center.x += size.width / 2;
+		center.y += size.height / 2;
+	}
+
+	addQuad(p_region, center, size, p_angle.to_radians(), p_color, p_blendMode);
+}
+
+void SpriteBatch::add(
+		const TextureAtlas::Region &p_region,
+		const CL_Rectf &p_rect,
+		const CL_Colorf &p_color,
+		BlendMode p_blendMode
+)
+{
+	addQuad(p_region, p_rect.get_center(), p_rect.get_size(), 0.0f, p_color, p_blendMode);
+}
+
+void SpriteBatch::addQuad(const TextureAtlas::Region &p_region, const CL_Pointf &p_center, const CL_Sizef &p_size, float p_angleRad, const CL_Colorf &p_color, BlendMode p_blendMode)
+{
+	static const float DEG_TO_RAD = 3.14159265f / 180.0f;
+
+	const float angle = p_angleRad + p_region.m_baseAngle * DEG_TO_RAD;
+
+	const float c = cos(angle);
+	const float s = sin(angle);
+
+	const float hw = p_size.width / 2;
+	const float hh = p_size.height / 2;
+
+	// top left, top right, bottom right, bottom left
+	const float local[4][2] = {
+		{ -hw, -hh }, { hw, -hh }, { hw, hh }, { -hw, hh }
+	};
+
+	Quad quad;
+	quad.m_page = p_region.m_page;
+	quad.m_blendMode = p_blendMode;
+	quad.m_texCoords = p_region.m_texCoords;
+	quad.m_color = CL_Vec4f(p_color.r, p_color.g, p_color.b, p_color.a);
+
+	for (int i = 0; i < 4; ++i) {
+		quad.m_corners[i].x = p_center.x + local[i][0] * c - local[i][1] * s;
+		quad.m_corners[i].y = p_center.y + local[i][0] * s + local[i][1] * c;
+	}
+
+	m_quads.push_back(quad);
+}
+
+void SpriteBatch::flush(RenderDevice &p_device)
+{
+	if (m_quads.empty()) {
+		return;
+	}
+
+	// group by blend mode and texture keeping the order inside groups
+	std::stable_sort(m_quads.begin(), m_quads.end());
+
+	const unsigned quadCount = m_quads.size();
+	unsigned begin = 0;
+
+	for (unsigned i = 1; i <= quadCount; ++i) {
+		if (i == quadCount || m_quads[begin] < m_quads[i]) {
+			drawRun(p_device, begin, i);
+			begin = i;
+		}
+	}
+
+	p_device.resetTexture();
+	p_device.setBlendMode(RenderDevice::BM_NORMAL);
+
+	m_quads.clear();
+}
+
+void SpriteBatch::drawRun(RenderDevice &p_device, unsigned p_begin, unsigned p_end)
+{
+	const Quad &first = m_quads[p_begin];
+	const unsigned vertexCount = (p_end - p_begin) * 6;
+
+	m_positions.resize(vertexCount);
+	m_texCoords.resize(vertexCount);
+	m_colors.resize(vertexCount);
+
+	// two triangles per quad
+	static const int CORNERS[6] = { 0, 1, 2, 0, 2, 3 };
+
+	unsigned v = 0;
+
+	for (unsigned i = p_begin; i < p_end; ++i) {
+		const Quad &quad = m_quads[i];
+		const CL_Rectf &tc = quad.m_texCoords;
+
+		const CL_Vec2f texCorners[4] = {
+			CL_Vec2f(tc.left, tc.top), CL_Vec2f(tc.right, tc.top),
+			CL_Vec2f(tc.right, tc.bottom), CL_Vec2f(tc.left, tc.bottom)
+		};
+
+		for (int j = 0; j < 6; ++j, ++v) {
+			m_positions[v] = quad.m_corners[CORNERS[j]];
+			m_texCoords[v] = texCorners[CORNERS[j]];
+			m_colors[v] = quad.m_color;
+		}
+	}
+
+	p_device.setBlendMode(first.m_blendMode == BM_ADDITIVE ? RenderDevice::BM_ADDITIVE : RenderDevice::BM_NORMAL);
+	p_device.bindTexture(m_atlas, first.m_page);
+
+	p_device.drawTriangles(&m_positions[0], &m_texCoords[0], &m_colors[0], vertexCount);
+}
+
+} // namespace
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <vector>
+#include <ClanLib/core.h>
+#include <ClanLib/display.h>
+
+#include "boost/utility.hpp"
+
+#include "gfx/RenderDevice.h"
+#include "gfx/TextureAtlas.h"
+
+namespace Gfx {
+
+/**
+ * Collects textured quads from the atlas and draws them with as few draw
+ * calls as possible. Quads of one layer are grouped by blend mode and
+ * atlas page at flush().
+ */
+class SpriteBatch : public boost::noncopyable {
+
+	public:
+
+		enum BlendMode {
+			BM_NORMAL,
+			BM_ADDITIVE
+		};
+
+
+		SpriteBatch(const TextureAtlas &p_atlas);
+
+		virtual ~SpriteBatch();
+
+
+		const TextureAtlas &getAtlas() const { return m_atlas; }
+
+		/**
+		 * Queues the sprite at <code>p_position</code>. Position is the
+		 * center or the top left corner depending on sprite translation
+		 * origin. Sprite is rotated around its center.
+		 */
+		void add(
+				const TextureAtlas::Region &p_region,
+				const CL_Pointf &p_position,
+				const CL_Angle &p_angle = CL_Angle(),
+				float p_scale = 1.0f,
+				const CL_Colorf &p_color = CL_Colorf::white,
+				BlendMode p_blendMode = BM_NORMAL
+		);
+
+		/** Queues the sprite stretched to <code>p_rect</code> */
+		void add(
+				const TextureAtlas::Region &p_region,
+				const CL_Rectf &p_rect,
+				const CL_Colorf &p_color = CL_Colorf::white,
+				BlendMode p_blendMode = BM_NORMAL
+		);
+
+		/** Draws all queued quads and empties the queue */
+		void flush(RenderDevice &p_device);
+
+	private:
+
+		struct Quad {
+				unsigned m_page;
+				BlendMode m_blendMode;
+				CL_Vec2f m_corners[4];
+				CL_Rectf m_texCoords;
+				CL_Vec4f m_color;
+
+				bool operator<(const Quad &p_other) const {
+					if (m_blendMode != p_other.m_blendMode) {
+						return m_blendMode < p_other.m_blendMode;
+					}
+
+					return m_page < p_other.m_page;
+				}
+		};
+
+		/** The atlas */
+		const TextureAtlas &m_atlas;
+
+		/** Queued quads */
+		std::vector<Quad> m_quads;
+
+		/** Vertex data (kept between frames to avoid allocations) */
+		std::vector<CL_Vec2f> m_positions;
+
+		std::vector<CL_Vec2f> m_texCoords;
+
+		std::vector<CL_Vec4f> m_colors;
+
+
+		void addQuad(const TextureAtlas::Region &p_region, const CL_Pointf &p_center, const CL_Sizef &p_size, float p_angleRad, const CL_Colorf &p_color, BlendMode p_blendMode);
+
+		void drawRun(RenderDevice &p_device, unsigned p_begin, unsigned p_end);
+};
+
+} // namespace
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "TextureAtlas.h"
+
+#include <assert.h>
+
+#include "common.h"
+
+namespace Gfx {
+
+TextureAtlas::TextureAtlas() :
+	m_built(false),
+	m_shelfX(0),
+	m_shelfY(0),
+	m_shelfHeight(0)
+{
+}
+
+TextureAtlas::~TextureAtlas()
+{
+}
+
+void TextureAtlas::add(const CL_String &p_spriteName)
+{
+	assert(!m_built && "atlas is already built");
+	m_spriteNames.push_back(p_spriteName);
+}
+
+void TextureAtlas::build(CL_GraphicContext &p_gc, CL_ResourceManager *p_resources)
+{
+	assert(!m_built && "atlas is already built");
+
+	// sprites sharing the same image file are packed only once
+	typedef std::pair<unsigned, CL_Rect> TImagePlace;
+	typedef std::map<CL_String, TImagePlace> TImageMap;
+	TImageMap images;
+
+	foreach (const CL_String &spriteName, m_spriteNames) {
+		CL_Resource resource = p_resources->get_resource(spriteName);
+		CL_DomElement element = resource.get_element();
+
+		const CL_String file = element.named_item("image").to_element().get_attribute("file");
+		TImageMap::iterator itor = images.find(file);
+
+		if (itor == images.end()) {
+			CL_PixelBuffer image = CL_ImageProviderFactory::load(file, p_resources->get_directory(resource));
+
+			CL_Point position;
+			const unsigned page = allocate(p_gc, image.get_size(), position);
+
+			m_pages[page].set_subimage(position.x, position.y, image, CL_Rect(CL_Point(0, 0), image.get_size()));
+			extrude(m_pages[page], image, position);
+
+			itor = images.insert(std::make_pair(file, TImagePlace(page, CL_Rect(position, image.get_size())))).first;
+
+			cl_log_event(LOG_DEBUG, "atlas: %1 packed at page %2 (%3, %4)", file, page, position.x, position.y);
+		}
+
+		const unsigned page = itor->second.first;
+		const CL_Rect &rect = itor->second.second;
+
+		Region region;
+		region.m_page = page;
+		region.m_texCoords = CL_Rectf(
+				rect.left / (float) PAGE_SIZE, rect.top / (float) PAGE_SIZE,
+				rect.right / (float) PAGE_SIZE, rect.bottom / (float) PAGE_SIZE
+		);
+
+		// apply sprite description attributes
+		float scaleX = 1.0f, scaleY = 1.0f;
+		const CL_DomElement scale = element.named_item("scale").to_element();
+
+		if (!scale.is_null()) {
+			scaleX = CL_StringHelp::local8_to_float(scale.get_attribute("x", "1.0"));
+			scaleY = CL_StringHelp::local8_to_float(scale.get_attribute("y", "1.0"));
+		}
+
+		region.m_size = CL_Sizef(rect.get_width() * scaleX, rect.get_height() * scaleY);
+		region.m_baseAngle = CL_StringHelp::local8_to_float(element.get_attribute("base_angle", "0"));
+
+		const CL_DomElement translation = element.named_item("translation").to_element();
+		region.m_centered = !translation.is_null() && translation.get_attribute("origin") == "center";
+
+		m_regions[spriteName] = region;
+	}
+
+	foreach (CL_Texture &page, m_pages) {
+		page.generate_mipmap();
+		page.set_max_level(MIPMAP_LEVELS);
+		page.set_min_filter(cl_filter_linear_mipmap_linear);
+	}
+
+	cl_log_event(LOG_DEBUG, "atlas: %1 sprites packed into %2 page(s)", m_regions.size(), m_pages.size());
+
+	m_built = true;
+}
+
+void TextureAtlas::clear()
+{
+	m_spriteNames.clear();
+	m_regions.clear();
+	m_pages.clear();
+
+	m_shelfX = m_shelfY = m_shelfHeight = 0;
+	m_built = false;
+}
+
+const TextureAtlas::Region &TextureAtlas::getRegion(const CL_String &p_spriteName) const
+{
+	TRegionMap::const_iterator itor = m_regions.find(p_spriteName);
+
+	assert(itor != m_regions.end() && "sprite not packed in atlas");
+	return itor->second;
+}
+
+unsigned TextureAtlas::allocate(CL_GraphicContext &p_gc, const CL_Size &p_size, CL_Point &p_position)
+{
+	assert(p_size.width + PADDING <= PAGE_SIZE && p_size.height + PADDING <= PAGE_SIZE && "image too big for the atlas");
+
+	if (m_pages.empty()) {
+		addPage(p_gc);
+	}
+
+	// start next shelf when this one is full
+	if (m_shelfX + p_size.width + PADDING > PAGE_SIZE) {
+		m_shelfX = 0;
+		m_shelfY += m_shelfHeight;
+		m_shelfHeight = 0;
+	}
+
+	// start next page when there is no place for the shelf
+	if (m_shelfY + p_size.height + PADDING > PAGE_SIZE) {
+		addPage(p_gc);
+	}
+
+	// image sits in the middle of its padded box
+	p_position = CL_Point(m_shelfX + EXTRUDE, m_shelfY + EXTRUDE);
+
+	m_shelfX += p_size.width + PADDING;
+
+	if (p_size.height + PADDING > m_shelfHeight) {
+		m_shelfHeight = p_size.height + PADDING;
+	}
+
+	return m_pages.size() - 1;
+}
+
+void TextureAtlas::addPage(CL_GraphicContext &p_gc)
+{
+	CL_Texture page(p_gc, PAGE_SIZE, PAGE_SIZE);
+	page.set_min_filter(cl_filter_linear);
+	page.set_mag_filter(cl_filter_linear);
+
+	m_pages.push_back(page);
+
+	m_shelfX = m_shelfY = m_shelfHeight = 0;
+}
+
+void TextureAtlas::extrude(CL_Texture &p_page, const CL_PixelBuffer &p_image, const CL_Point &p_position)
+{
+	const int w = p_image.get_width();
+	const int h = p_image.get_height();
+
+	for (int i = 1; i <= EXTRUDE; ++i) {
+		p_page.set_subimage(p_position.x - i, p_position.y, p_image, CL_Rect(0, 0, 1, h));
+		p_page.set_subimage(p_position.x + w - 1 + i, p_position.y, p_image, CL_Rect(w - 1, 0, w, h));
+		p_page.set_subimage(p_position.x, p_position.y - i, p_image, CL_Rect(0, 0, w, 1));
+		p_page.set_subimage(p_position.x, p_position.y + h - 1 + i, p_image, CL_Rect(0, h - 1, w, h));
+	}
+}
+
+} // namespace
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <map>
+#include <vector>
+#include <ClanLib/core.h>
+#include <ClanLib/display.h>
+
+#include "boost/utility.hpp"
+
+namespace Gfx {
+
+/**
+ * Packs sprite images from the resource file into few big textures, so
+ * sprites can be drawn in batches without switching textures. Pages are
+ * mipmapped for zoomed out views. Image edges are extruded into the
+ * padding, so smaller mipmap levels do not mix neighbouring images.
+ */
+class TextureAtlas : public boost::noncopyable {
+
+	public:
+
+		/** Sprite placement in the atlas */
+		struct Region {
+
+				/** Texture page index */
+				unsigned m_page;
+
+				/** Texture coordinates (0.0 - 1.0) */
+				CL_Rectf m_texCoords;
+
+				/** Draw size with sprite scale applied */
+				CL_Sizef m_size;
+
+				/** Sprite base angle in degrees */
+				float m_baseAngle;
+
+				/** If true then sprite is drawn from the center */
+				bool m_centered;
+		};
+
+		/** Size of a single texture page */
+		static const int PAGE_SIZE = 2048;
+
+
+		TextureAtlas();
+
+		virtual ~TextureAtlas();
+
+
+		/** Registers the sprite resource to be packed at build() */
+		void add(const CL_String &p_spriteName);
+
+		/** Loads registered sprite images and packs them into textures */
+		void build(CL_GraphicContext &p_gc, CL_ResourceManager *p_resources);
+
+		void clear();
+
+
+		bool isBuilt() const { return m_built; }
+
+		const Region &getRegion(const CL_String &p_spriteName) const;
+
+		unsigned getPageCount() const { return m_pages.size(); }
+
+		const CL_Texture &getPage(unsigned p_index) const { return m_pages[p_index]; }
+
+	private:
+
+		/** Space between packed images */
+		static const int PADDING = 8;
+
+		/** Edge pixels copied around every image, half of the padding */
+		static const int EXTRUDE = PADDING / 2;
+
+		/**
+		 * Highest mipmap level. Extrusion has to stay at least two texels
+		 * wide there, so bilinear samples at region edges stay inside it.
+		 */
+		static const int MIPMAP_LEVELS = 1;
+
+		/** Built state */
+		bool m_built;
+
+		/** Registered sprite names */
+		std::vector<CL_String> m_spriteNames;
+
+		/** Sprite regions */
+		typedef std::map<CL_String, Region> TRegionMap;
+		TRegionMap m_regions;
+
+		/** Texture pages */
+		std::vector<CL_Texture> m_pages;
+
+		/** Packing cursor */
+		int m_shelfX, m_shelfY, m_shelfHeight;
+
+
+		/** Finds place for the image of given size and returns page index */
+		unsigned allocate(CL_GraphicContext &p_gc, const CL_Size &p_size, CL_Point &p_position);
+
+		void addPage(CL_GraphicContext &p_gc);
+
+		/** Repeats image edges into surrounding padding */
+		void extrude(CL_Texture &p_page, const CL_PixelBuffer &p_image, const CL_Point &p_position);
+};
+
+} // namespace
@@ -45,6 +45,9 @@ class Viewport {
 
 		void detach() { m_attachPoint = NULL; }
 
+		/** @return Visible area in level coordinates */
+		CL_Rectf getBounds() const { return CL_Rectf(m_x, m_y, m_x + m_width, m_y + m_height); }
+
 		float getScale() const { return m_scale; }
 
 		void setScale(float p_scale) { m_scale = p_scale; }
@@ -28,8 +28,18 @@
 
 #include "RaceGraphics.h"
 
+#include <algorithm>
+
+#if defined(GL2)
+#include <ClanLib/gl.h>
+#endif // GL2
+
 #include "common.h"
 #include "common/Game.h"
+#include "common/Properties.h"
+#include "debug/MemoryTracker.h"
+#include "debug/Metrics.h"
+#include "debug/Profiler.h"
 #include "gfx/DebugLayer.h"
 #include "gfx/Stage.h"
 #include "gfx/race/level/Bound.h"
@@ -44,14 +54,68 @@
 
 namespace Gfx {
 
+const Dbg::Gauge FPS_METRIC("fps");
+
+const Dbg::Gauge SCALE_METRIC("scale");
+
+const Dbg::Gauge DRAW_CALLS_METRIC("draw calls");
+
+const Dbg::Gauge TEXTURE_BINDS_METRIC("texture binds");
+
+const Dbg::Gauge VERTICES_METRIC("vertices");
+
+const Dbg::Gauge QUALITY_METRIC("quality");
+
+const Dbg::Gauge DETAIL_METRIC("detail level");
+
+/** Zoom detail tier settings */
+struct DetailTier {
+
+		/** Lowest viewport scale of the tier */
+		float m_minScale;
+
+		/** Drawn decorations of every level block */
+		unsigned m_decorationsPerBlock;
+};
+
+/** Tiers in DetailLevel order, zoomed out views thin out the grass */
+const DetailTier DETAIL_TIERS[] = {
+	{ 0.0f, 1 },
+	{ 1.3f, 2 },
+	{ 1.6f, QualityGovernor::MAX_DECORATIONS_PER_BLOCK }
+};
+
+/** Scale distance from tier border needed to change the tier */
+const float DETAIL_HYSTERESIS = 0.05f;
+
+namespace {
+
+	/** @return True when bounding box of the line touches the rectangle */
+	bool isLineVisible(const CL_Pointf &p_from, const CL_Pointf &p_to, const CL_Rectf &p_area)
+	{
+		return std::max(p_from.x, p_to.x) >= p_area.left && std::min(p_from.x, p_to.x) <= p_area.right
+			&& std::max(p_from.y, p_to.y) >= p_area.top && std::min(p_from.y, p_to.y) <= p_area.bottom;
+	}
+
+} // namespace
+
+/** Frame rate kept by lowering effects quality, 0 keeps the best quality */
+const IntProperty TARGET_FPS("gfx_targetFps", 60);
+
 RaceGraphics::RaceGraphics(const Race::RaceLogic *p_logic) :
-	m_logic(p_logic)
+	m_logic(p_logic),
+	m_snapshot(NULL),
+	m_batch(m_atlas),
+#if defined(GL2)
+	m_tileMap(m_atlas),
+#endif // GL2
+	m_multisampling(true),
+	m_detailLevel(DL_HIGH),
+	m_frameWork(0),
+	m_timeToSmoke(0)
 {
 	// attach viewport to player's car
-	Game &game = Game::getInstance();
-
-	Player &player = game.getPlayer();
-	m_viewport.attachTo(&(player.getCar().getPosition()));
+	m_viewport.attachTo(&m_cameraPosition);
 }
 
 RaceGraphics::~RaceGraphics()
@@ -60,10 +124,23 @@ RaceGraphics::~RaceGraphics()
 
 void RaceGraphics::draw(CL_GraphicContext &p_gc)
 {
-	if (!m_logic->getLevel().isLoaded()) {
+	PROFILE_ZONE(Dbg::Z_DRAW);
+	MEMORY_SCOPE(Dbg::MT_GFX);
+
+	if (m_snapshot == NULL || !m_snapshot->m_levelLoaded) {
 		return;
 	}
 
+	// level was loaded again since last frame
+	if (m_snapshot->m_level != m_level) {
+		loadLevel(p_gc);
+	}
+
+	const unsigned drawStart = Dbg::Profiler::now();
+
+	m_device.setGraphicContext(p_gc);
+	m_device.beginFrame();
+
 	// initialize player's viewport
 	m_viewport.prepareGC(p_gc);
 
@@ -82,9 +159,16 @@ void RaceGraphics::draw(CL_GraphicContext &p_gc)
 	drawUI(p_gc);
 
 	countFps();
+	updateQuality(p_gc, Dbg::Profiler::now() - drawStart);
 
 #ifndef NDEBUG
-	Gfx::Stage::getDebugLayer()->putMessage("fps", CL_StringHelp::int_to_local8(m_fps));
+	FPS_METRIC.set(m_fps);
+
+	const RenderDevice::Stats &stats = m_device.getStats();
+
+	DRAW_CALLS_METRIC.set(stats.m_drawCalls);
+	TEXTURE_BINDS_METRIC.set(stats.m_textureBinds);
+	VERTICES_METRIC.set(stats.m_vertices);
 
 	Gfx::Stage::getDebugLayer()->draw(p_gc);
 #endif // NDEBUG
@@ -92,10 +176,32 @@ void RaceGraphics::draw(CL_GraphicContext &p_gc)
 
 void RaceGraphics::load(CL_GraphicContext &p_gc)
 {
+	PROFILE_ZONE(Dbg::Z_GFX_LOAD);
+	MEMORY_SCOPE(Dbg::MT_GFX);
+
 	m_raceUI.load(p_gc);
+	loadAtlas(p_gc);
 	loadGroundBlocks(p_gc);
-	loadDecorations(p_gc);
-	loadSandPits(p_gc);
+
+	const int targetFps = TARGET_FPS.get();
+	m_governor.setBudget(targetFps > 0 ? 1000000 / targetFps : 0);
+}
+
+void RaceGraphics::loadAtlas(CL_GraphicContext &p_gc)
+{
+	m_atlas.add("race/block");
+	m_atlas.add("race/street_vert");
+	m_atlas.add("race/street_horiz");
+	m_atlas.add("race/turn_bottom_right");
+	m_atlas.add("race/turn_bottom_left");
+	m_atlas.add("race/turn_top_right");
+	m_atlas.add("race/turn_top_left");
+	m_atlas.add("race/start_line_up");
+	m_atlas.add("race/car");
+	m_atlas.add("race/smoke");
+	m_atlas.add("race/decorations/grass");
+
+	m_atlas.build(p_gc, Stage::getResourceManager());
 }
 
 void RaceGraphics::loadGroundBlocks(CL_GraphicContext &p_gc)
@@ -104,25 +210,43 @@ void RaceGraphics::loadGroundBlocks(CL_GraphicContext &p_gc)
 	const int last = Common::BT_START_LINE_UP; // FIXME: this is dangerous
 
 	for (int i = first; i <= last; ++i) {
-		CL_SharedPtr<Gfx::GroundBlock> gfxBlock(new Gfx::GroundBlock((Common::GroundBlockType) i));
+		CL_SharedPtr<Gfx::GroundBlock> gfxBlock(new Gfx::GroundBlock((Common::GroundBlockType) i, m_batch));
 		gfxBlock->load(p_gc);
 
 		m_blockMapping[(Common::GroundBlockType) i] = gfxBlock;
 	}
 }
 
+void RaceGraphics::loadLevel(CL_GraphicContext &p_gc)
+{
+	PROFILE_ZONE(Dbg::Z_GFX_LOAD);
+	MEMORY_SCOPE(Dbg::MT_GFX);
+
+	// sandpits point into the old level data, drop them first
+	m_decorations.clear();
+	m_sandpits.clear();
+
+	m_level = m_snapshot->m_level;
+
+#if defined(GL2)
+	m_tileMap.setLevel(*m_level);
+	m_tileMap.load(p_gc);
+#endif // GL2
+	loadDecorations(p_gc);
+	loadSandPits(p_gc);
+}
+
 void RaceGraphics::loadDecorations(CL_GraphicContext &p_gc)
 {
 	// load decorations
-	const Race::Level &level = m_logic->getLevel();
-	const int w = level.getWidth();
-	const int h = level.getHeight();
+	const int w = m_level->m_width;
+	const int h = m_level->m_height;
 
 	for (int x = 0; x < w; ++x) {
 		for (int y = 0; y < h; ++y) {
 
-			for (int i = 0; i < 3; ++i) {
-				CL_SharedPtr<Gfx::DecorationSprite> decoration(new Gfx::DecorationSprite("race/decorations/grass"));
+			for (unsigned i = 0; i < QualityGovernor::MAX_DECORATIONS_PER_BLOCK; ++i) {
+				CL_SharedPtr<Gfx::DecorationSprite> decoration(new Gfx::DecorationSprite("race/decorations/grass", m_batch));
 
 				const CL_Pointf point(x * Race::Block::WIDTH + rand() % Race::Block::WIDTH, y * Race::Block::WIDTH + rand() % Race::Block::WIDTH);
 				decoration->setPosition(point);
@@ -138,11 +262,7 @@ void RaceGraphics::loadDecorations(CL_GraphicContext &p_gc)
 
 void RaceGraphics::loadSandPits(CL_GraphicContext &p_gc)
 {
-	const Race::Level &level = m_logic->getLevel();
-	const unsigned sandpitCount = level.getSandpitCount();
-
-	for (unsigned i = 0; i < sandpitCount; ++i) {
-		const Race::Sandpit &logicSandpit = level.sandpitAt(i);
+	foreach (const Race::Sandpit &logicSandpit, m_level->m_sandpits) {
 		CL_SharedPtr<Gfx::Sandpit> gfxSandpit(new Gfx::Sandpit(&logicSandpit));
 
 		// load and add to list
@@ -154,6 +274,8 @@ void RaceGraphics::loadSandPits(CL_GraphicContext &p_gc)
 
 void RaceGraphics::drawSandpits(CL_GraphicContext &p_gc)
 {
+	PROFILE_ZONE(Dbg::Z_DRAW_SANDPITS);
+
 	foreach (CL_SharedPtr<Gfx::Sandpit> &sandpit, m_sandpits) {
 		sandpit->draw(p_gc);
 	}
@@ -161,6 +283,8 @@ void RaceGraphics::drawSandpits(CL_GraphicContext &p_gc)
 
 void RaceGraphics::drawSmokes(CL_GraphicContext &p_gc)
 {
+	PROFILE_ZONE(Dbg::Z_DRAW_SMOKES);
+
 	foreach(CL_SharedPtr<Gfx::Smoke> &smoke, m_smokes) {
 		if (!smoke->isLoaded()) {
 			smoke->load(p_gc);
@@ -168,35 +292,53 @@ void RaceGraphics::drawSmokes(CL_GraphicContext &p_gc)
 
 		smoke->draw(p_gc);
 	}
+
+	m_batch.flush(m_device);
 }
 
 void RaceGraphics::drawUI(CL_GraphicContext &p_gc)
 {
-	Gfx::SpeedMeter &speedMeter = m_raceUI.getSpeedMeter();
-	speedMeter.setSpeed(Game::getInstance().getPlayer().getCar().getSpeedKMS());
+	PROFILE_ZONE(Dbg::Z_DRAW_UI);
+
+	const Race::RaceSnapshot::CarState *localCar = getLocalCar();
+
+	if (localCar != NULL) {
+		Gfx::SpeedMeter &speedMeter = m_raceUI.getSpeedMeter();
+		speedMeter.setSpeed(localCar->m_speed / 3.0f); // km/s
+	}
 
 	m_raceUI.draw(p_gc);
 }
 
 void RaceGraphics::drawTireTracks(CL_GraphicContext &p_gc)
 {
-	const Race::Level &level = m_logic->getLevel();
-	const Race::TyreStripes &tireStripes = level.getTyreStripes();
+	PROFILE_ZONE(Dbg::Z_DRAW_TIRE_TRACKS);
 
-	Gfx::TireTrack track;
+	// stripes are kept newest first
+	const std::vector<Race::RaceSnapshot::Stripe> &stripes = m_snapshot->m_stripes;
+	const size_t stripeCount = std::min<size_t>(stripes.size(), m_governor.getSettings().m_stripeLimit);
 
-	foreach (const Race::TyreStripes::Stripe &stripe, tireStripes.getStripeList()) {
-		track.setFromPoint(stripe.getFromPoint());
-		track.setToPoint(stripe.getToPoint());
+	const CL_Rectf area = m_viewport.getBounds();
+	m_linePoints.clear();
 
-		track.draw(p_gc);
+	for (size_t i = 0; i < stripeCount; ++i) {
+		const Race::RaceSnapshot::Stripe &stripe = stripes[i];
+
+		if (isLineVisible(stripe.m_from, stripe.m_to, area)) {
+			m_linePoints.push_back(stripe.m_from);
+			m_linePoints.push_back(stripe.m_to);
+		}
+	}
+
+	if (!m_linePoints.empty()) {
+		Gfx::TireTrack::drawList(m_device, &m_linePoints[0], m_linePoints.size());
 	}
 
 }
 
 void RaceGraphics::drawLevel(CL_GraphicContext &p_gc)
 {
-	const Race::Level &level = m_logic->getLevel();
+	PROFILE_ZONE(Dbg::Z_DRAW_LEVEL);
 
 	drawBackBlocks(p_gc);
 
@@ -204,40 +346,25 @@ void RaceGraphics::drawLevel(CL_GraphicContext &p_gc)
 
 	drawForeBlocks(p_gc);
 
-	// draw bounds
-	const size_t boundCount = level.getBoundCount();
-	Gfx::Bound gfxBound;
-
-	for (size_t i = 0; i < boundCount; ++i) {
-		const Race::Bound &bound = level.getBound(i);
-		gfxBound.setSegment(bound.getSegment());
-
-		gfxBound.draw(p_gc);
-	}
-
-#if !defined(NDEBUG) && defined(DRAW_CHECKPOINTS)
-
-	// draw car -> checkpoint links
-	std::vector<CL_String> names = m_logic->getPlayerNames();
+	// draw visible bounds as one line list
+	const CL_Rectf area = m_viewport.getBounds();
 
-	foreach (const CL_String &name, names) {
-		const Player &player = m_logic->getPlayer(name);
-		const Race::Car &car = player.getCar();
+	m_linePoints.clear();
 
-		const Race::Checkpoint *cp = car.getCurrentCheckpoint();
-
-		if (cp != NULL) {
-			CL_Draw::line(p_gc, car.getPosition(), cp->getPosition(), CL_Colorf::green);
+	foreach (const CL_LineSegment2f &segment, m_level->m_bounds) {
+		if (isLineVisible(segment.p, segment.q, area)) {
+			m_linePoints.push_back(segment.p);
+			m_linePoints.push_back(segment.q);
 		}
 	}
 
-	const Race::Track &track = level.getTrack();
-	const unsigned checkpointCount = track.getCheckpointCount();
+	if (!m_linePoints.empty()) {
+		Gfx::Bound::drawList(m_device, &m_linePoints[0], m_linePoints.size());
+	}
 
-	for (unsigned i = 0; i < checkpointCount; ++i) {
-		const Race::Checkpoint *checkpoint = track.getCheckpoint(i);
-		const CL_Pointf &point = checkpoint->getPosition();
+#if !defined(NDEBUG) && defined(DRAW_CHECKPOINTS)
 
+	foreach (const CL_Pointf &point, m_level->m_checkpoints) {
 		CL_Draw::circle(p_gc, point.x, point.y, 5, CL_Colorf::red);
 	}
 
@@ -246,54 +373,76 @@ void RaceGraphics::drawLevel(CL_GraphicContext &p_gc)
 
 void RaceGraphics::drawBackBlocks(CL_GraphicContext &p_gc)
 {
-	const Race::Level &level = m_logic->getLevel();
+	PROFILE_ZONE(Dbg::Z_DRAW_BACK_BLOCKS);
 
-	const size_t w = level.getWidth();
-	const size_t h = level.getHeight();
+	const int h = m_level->m_height;
+	const CL_Rect visible = getVisibleBlocks();
 
 	// draw grass
 	CL_SharedPtr<Gfx::GroundBlock> gfxGrassBlock = m_blockMapping[Common::BT_GRASS];
 
-	for (size_t iw = 0; iw < w; ++iw) {
-		for (size_t ih = 0; ih < h; ++ih) {
+	for (int iw = visible.left; iw < visible.right; ++iw) {
+		for (int ih = visible.top; ih < visible.bottom; ++ih) {
 			gfxGrassBlock->setPosition(real(CL_Pointf(iw, ih)));
 			gfxGrassBlock->draw(p_gc);
+		}
+	}
 
-			// draw grass decoration sprites
-			foreach(CL_SharedPtr<Gfx::DecorationSprite> &decoration, m_decorations) {
-				const CL_Pointf &position = decoration->getPosition();
+	// draw grass decoration sprites on top of the grass, fewer of them
+	// when zoomed out or over frame budget
+	if (!m_decorations.empty()) {
+		const unsigned decorationsPerBlock = std::min(
+				m_governor.getSettings().m_decorationsPerBlock,
+				DETAIL_TIERS[m_detailLevel].m_decorationsPerBlock
+		);
 
-				if (position.x >= real(iw) && position.x < real(iw) + Race::Block::WIDTH && position.y >= real(ih) && position.y < real(ih) + Race::Block::WIDTH) {
-					decoration->draw(p_gc);
+		for (int iw = visible.left; iw < visible.right; ++iw) {
+			for (int ih = visible.top; ih < visible.bottom; ++ih) {
+				const unsigned first = (iw * h + ih) * QualityGovernor::MAX_DECORATIONS_PER_BLOCK;
+
+				for (unsigned i = 0; i < decorationsPerBlock; ++i) {
+					m_decorations[first + i]->draw(p_gc);
 				}
 			}
 		}
 	}
+
+	m_batch.flush(m_device);
 }
 
 void RaceGraphics::drawForeBlocks(CL_GraphicContext &p_gc)
 {
-	const Race::Level &level = m_logic->getLevel();
+	PROFILE_ZONE(Dbg::Z_DRAW_FORE_BLOCKS);
+
+#if defined(GL2)
+	if (m_tileMap.isLoaded()) {
+		m_tileMap.setVisibleArea(m_viewport.getBounds());
+		m_tileMap.draw(p_gc);
+
+		return;
+	}
+#endif // GL2
 
-	const size_t w = level.getWidth();
-	const size_t h = level.getHeight();
+	const CL_Rect visible = getVisibleBlocks();
 
 	// draw foreground
 
-	for (size_t iw = 0; iw < w; ++iw) {
-		for (size_t ih = 0; ih < h; ++ih) {
-			drawGroundBlock(p_gc, level.getBlock(iw, ih), real(iw), real(ih));
+	for (int iw = visible.left; iw < visible.right; ++iw) {
+		for (int ih = visible.top; ih < visible.bottom; ++ih) {
+			drawGroundBlock(p_gc, m_level->getBlockType(iw, ih), real(iw), real(ih));
 		}
 	}
+
+	m_batch.flush(m_device);
 }
 
-void RaceGraphics::drawGroundBlock(CL_GraphicContext &p_gc, const Race::Block& p_block, size_t x, size_t y)
+void RaceGraphics::drawGroundBlock(CL_GraphicContext &p_gc, Common::GroundBlockType p_type, size_t x, size_t y)
 {
-	assert(m_blockMapping.find(p_block.getType()) != m_blockMapping.end() && "not loaded block type");
+	assert(m_blockMapping.find(p_type) != m_blockMapping.end() && "not loaded block type");
 
 	// then draw selected block
-	if (p_block.getType() != Common::BT_GRASS) {
-		CL_SharedPtr<Gfx::GroundBlock> gfxBlock = m_blockMapping[p_block.getType()];
+	if (p_type != Common::BT_GRASS) {
+		CL_SharedPtr<Gfx::GroundBlock> gfxBlock = m_blockMapping[p_type];
 		gfxBlock->setPosition(CL_Pointf(x, y));
 
 		gfxBlock->draw(p_gc);
@@ -303,37 +452,37 @@ void RaceGraphics::drawGroundBlock(CL_GraphicContext &p_gc, const Race::Block& p
 
 void RaceGraphics::drawCars(CL_GraphicContext &p_gc)
 {
-	const Race::Level &level = m_logic->getLevel();
-	size_t carCount = level.getCarCount();
+	PROFILE_ZONE(Dbg::Z_DRAW_CARS);
 
-	for (size_t i = 0; i < carCount; ++i) {
-		const Race::Car &car = level.getCar(i);
+	foreach (const Race::RaceSnapshot::CarState &car, m_snapshot->m_cars) {
 		drawCar(p_gc, car);
 	}
+
+	m_batch.flush(m_device);
 }
 
-void RaceGraphics::drawCar(CL_GraphicContext &p_gc, const Race::Car &p_car)
+void RaceGraphics::drawCar(CL_GraphicContext &p_gc, const Race::RaceSnapshot::CarState &p_car)
 {
-	TCarMapping::iterator itor = m_carMapping.find(&p_car);
+	TCarMapping::iterator itor = m_carMapping.find(p_car.m_car);
 
 	CL_SharedPtr<Gfx::Car> gfxCar;
 
 	if (itor == m_carMapping.end()) {
-		gfxCar = CL_SharedPtr<Gfx::Car>(cl_new Gfx::Car());
+		gfxCar = CL_SharedPtr<Gfx::Car>(cl_new Gfx::Car(m_batch));
 		gfxCar->load(p_gc);
 
-		m_carMapping[&p_car] = gfxCar;
+		m_carMapping[p_car.m_car] = gfxCar;
 	} else {
 		gfxCar = itor->second;
 	}
 
-	gfxCar->setPosition(p_car.getPosition());
-	gfxCar->setRotation(CL_Angle(p_car.getRotationRad(), cl_radians));
+	gfxCar->setPosition(p_car.m_position);
+	gfxCar->setRotation(CL_Angle(p_car.m_rotationRad, cl_radians));
 
 	gfxCar->draw(p_gc);
 	
 	#if defined(DRAW_CAR_VECTORS) && !defined(NDEBUG)
-		const CL_Pointf &pos = p_car.getPosition();
+		const CL_Pointf &pos = p_car.m_position;
 		p_gc.push_translate(pos.x, pos.y);
 		
 		CL_Draw::line(p_gc, 0, 0, p_car.m_moveVector.x/10, p_car.m_moveVector.y/10, CL_Colorf::red);
@@ -358,8 +507,65 @@ void RaceGraphics::countFps()
 
 void RaceGraphics::update(unsigned p_timeElapsed)
 {
+	MEMORY_SCOPE(Dbg::MT_GFX);
+
+	const unsigned updateStart = Dbg::Profiler::now();
+
+	// take the newest state published by the logic
+	m_snapshot = &m_logic->getSnapshots().read();
+
+	const Race::RaceSnapshot::CarState *localCar = getLocalCar();
+
+	if (localCar != NULL) {
+		m_cameraPosition = localCar->m_position;
+	}
+
 	updateViewport(p_timeElapsed);
+	updateDetailLevel();
 	updateSmokes(p_timeElapsed);
+
+	m_frameWork += Dbg::Profiler::now() - updateStart;
+}
+
+void RaceGraphics::updateDetailLevel()
+{
+	const float scale = m_viewport.getScale();
+
+	if (m_detailLevel < DL_HIGH && scale >= DETAIL_TIERS[m_detailLevel + 1].m_minScale + DETAIL_HYSTERESIS) {
+		m_detailLevel = (DetailLevel) (m_detailLevel + 1);
+	} else if (m_detailLevel > DL_LOW && scale < DETAIL_TIERS[m_detailLevel].m_minScale - DETAIL_HYSTERESIS) {
+		m_detailLevel = (DetailLevel) (m_detailLevel - 1);
+	}
+
+	DETAIL_METRIC.set(m_detailLevel);
+}
+
+void RaceGraphics::updateQuality(CL_GraphicContext &p_gc, unsigned p_drawTime)
+{
+	// work time, not frame interval, so vsync wait is not counted as load
+	if (m_governor.addFrame(m_frameWork + p_drawTime)) {
+		cl_log_event("debug", "Quality level set to %1", (int) m_governor.getLevel());
+	}
+
+	m_frameWork = 0;
+	QUALITY_METRIC.set(m_governor.getLevel());
+
+	const bool multisampling = m_governor.getSettings().m_multisampling;
+
+	if (multisampling != m_multisampling) {
+#if defined(GL2)
+		// window is created multisampled, it can only be switched here
+		CL_OpenGL::set_active(p_gc);
+
+		if (multisampling) {
+			clEnable(CL_MULTISAMPLE);
+		} else {
+			clDisable(CL_MULTISAMPLE);
+		}
+#endif // GL2
+
+		m_multisampling = multisampling;
+	}
 }
 
 void RaceGraphics::updateViewport(unsigned p_timeElapsed)
@@ -367,7 +573,10 @@ void RaceGraphics::updateViewport(unsigned p_timeElapsed)
 	static const float ZOOM_SPEED = 0.005f;
 	static const float MAX_SPEED = 500.0f; // FIXME
 
-	float speed = fabs( ceil(Game::getInstance().getPlayer().getCar().getSpeed() * 10.0f ) / 10.0f);
+	const Race::RaceSnapshot::CarState *localCar = getLocalCar();
+	const float carSpeed = localCar != NULL ? localCar->m_speed : 0.0f;
+
+	float speed = fabs( ceil(carSpeed * 10.0f ) / 10.0f);
 
 	float properScale = -( 1.0f / MAX_SPEED ) * speed + 2.0f;
 	properScale = ceil( properScale * 100.0f ) / 100.0f;
@@ -381,9 +590,7 @@ void RaceGraphics::updateViewport(unsigned p_timeElapsed)
 	}
 
 
-#ifndef NDEBUG
-	Gfx::Stage::getDebugLayer()->putMessage(CL_String8("scale"),  CL_StringHelp::float_to_local8(scale));
-#endif
+	SCALE_METRIC.set(scale);
 }
 
 void RaceGraphics::updateSmokes(unsigned p_timeElapsed)
@@ -401,33 +608,57 @@ void RaceGraphics::updateSmokes(unsigned p_timeElapsed)
 	}
 
 	// if car is drifting then add new smokes
-	Player &player = Game::getInstance().getPlayer();
-	const Race::Car &car = player.getCar();
+	const Race::RaceSnapshot::CarState *car = getLocalCar();
 
-	// but keep this limit on mind
-	static const unsigned SMOKE_PERIOD = 25;
-	static unsigned timeFromLastSmoke = SMOKE_PERIOD;
+	if (car == NULL) {
+		return;
+	}
 
-	timeFromLastSmoke += p_timeElapsed;
+	// but keep quality limits on mind
+	const QualityGovernor::Settings &settings = m_governor.getSettings();
+
+	m_timeToSmoke = m_timeToSmoke > p_timeElapsed ? m_timeToSmoke - p_timeElapsed : 0;
 
 	static const int RAND_LIMIT = 10;
 
-	if (car.isDrifting() && timeFromLastSmoke >= SMOKE_PERIOD) {
+	if (car->m_drifting && m_timeToSmoke == 0 && m_smokes.size() < settings.m_smokeLimit) {
 
-		CL_Pointf smokePosition = car.getPosition();
+		CL_Pointf smokePosition = car->m_position;
 		smokePosition.x += (rand() % (RAND_LIMIT * 2) - RAND_LIMIT);
 		smokePosition.y += (rand() % (RAND_LIMIT * 2) - RAND_LIMIT);
 
-		CL_SharedPtr<Gfx::Smoke> smoke(new Gfx::Smoke(smokePosition));
+		CL_SharedPtr<Gfx::Smoke> smoke(new Gfx::Smoke(smokePosition, m_batch));
 		smoke->start();
 
 		m_smokes.push_back(smoke);
 
-		timeFromLastSmoke = 0;
+		m_timeToSmoke = settings.m_smokePeriod;
 	}
 
 }
 
+const Race::RaceSnapshot::CarState *RaceGraphics::getLocalCar() const
+{
+	if (m_snapshot == NULL || m_snapshot->m_localCar < 0) {
+		return NULL;
+	}
+
+	return &m_snapshot->m_cars[m_snapshot->m_localCar];
+}
+
+CL_Rect RaceGraphics::getVisibleBlocks() const
+{
+	const CL_Rectf area = m_viewport.getBounds();
+
+	// sprites may reach over their block
+	return CL_Rect(
+			std::max(0, (int) floor(area.left / Race::Block::WIDTH) - 1),
+			std::max(0, (int) floor(area.top / Race::Block::WIDTH) - 1),
+			std::min(m_level->m_width, (int) ceil(area.right / Race::Block::WIDTH) + 1),
+			std::min(m_level->m_height, (int) ceil(area.bottom / Race::Block::WIDTH) + 1)
+	);
+}
+
 CL_Pointf RaceGraphics::real(const CL_Pointf &p_point) const
 {
 	return CL_Pointf(real(p_point.x), real(p_point.y));
@@ -29,14 +29,20 @@
 #pragma once
 
 #include <list>
+#include <vector>
 #include <ClanLib/display.h>
 
 #include "common/GroundBlockType.h"
+#include "gfx/race/level/TileMap.h"
 #include "gfx/race/ui/RaceUI.h"
+#include "gfx/QualityGovernor.h"
+#include "gfx/RenderDevice.h"
+#include "gfx/SpriteBatch.h"
+#include "gfx/TextureAtlas.h"
 #include "gfx/Viewport.h"
+#include "logic/race/RaceSnapshot.h"
 
 namespace Race {
-	class Block;
 	class Car;
 	class RaceLogic;
 }
@@ -53,6 +59,13 @@ class RaceGraphics {
 
 	public:
 
+		/** Level of detail tiers chosen by viewport zoom */
+		enum DetailLevel {
+			DL_LOW,
+			DL_MEDIUM,
+			DL_HIGH
+		};
+
 		RaceGraphics(const Race::RaceLogic *p_logic);
 
 		virtual ~RaceGraphics();
@@ -63,17 +76,66 @@ class RaceGraphics {
 
 		void update(unsigned p_timeElapsed);
 
+		const QualityGovernor &getQualityGovernor() const { return m_governor; }
+
+		DetailLevel getDetailLevel() const { return m_detailLevel; }
+
+		const Gfx::Viewport &getViewport() const { return m_viewport; }
+
+		const RenderDevice &getRenderDevice() const { return m_device; }
+
 	private:
 
 		/** Logic with data for reading only */
 		const Race::RaceLogic *m_logic;
 
+		/** Latest race state from the logic */
+		const Race::RaceSnapshot *m_snapshot;
+
+		/** Level geometry graphics are built from, kept while they use it */
+		boost::shared_ptr<const Race::LevelGeometry> m_level;
+
+		/** Point followed by the viewport */
+		CL_Pointf m_cameraPosition;
+
 		/** How player sees the scene */
 		Gfx::Viewport m_viewport;
 
 		/** Race scene interface */
 		Gfx::RaceUI m_raceUI;
 
+		/** Race sprites packed together */
+		Gfx::TextureAtlas m_atlas;
+
+		/** Batch for all atlas sprites */
+		Gfx::SpriteBatch m_batch;
+
+		/** Backend of batched sprites and lines */
+		Gfx::ClanLibRenderDevice m_device;
+
+#if defined(GL2)
+		/** Single pass street blocks renderer */
+		Gfx::TileMap m_tileMap;
+#endif // GL2
+
+		/** Effects quality chosen from frame times */
+		Gfx::QualityGovernor m_governor;
+
+		/** Multisampling state applied to the context */
+		bool m_multisampling;
+
+		/** Current zoom detail tier */
+		DetailLevel m_detailLevel;
+
+		/** Line list of current draw call */
+		std::vector<CL_Vec2f> m_linePoints;
+
+		/** Update work of current frame in microseconds */
+		unsigned m_frameWork;
+
+		/** Time to wait until next smoke in ms */
+		unsigned m_timeToSmoke;
+
 		/** FPS counter */
 		unsigned m_fps, m_nextFps;
 
@@ -92,8 +154,8 @@ class RaceGraphics {
 		typedef std::list< CL_SharedPtr<Gfx::Smoke> > TSmokeList;
 		TSmokeList m_smokes;
 
-		/** Decorations */
-		typedef std::list< CL_SharedPtr<Gfx::DecorationSprite> > TDecorationList;
+		/** Decorations, block after block in column order */
+		typedef std::vector< CL_SharedPtr<Gfx::DecorationSprite> > TDecorationList;
 		TDecorationList m_decorations;
 
 		/** Sandpits */
@@ -103,8 +165,13 @@ class RaceGraphics {
 
 		// initialize routines
 
+		void loadAtlas(CL_GraphicContext &p_gc);
+
 		void loadGroundBlocks(CL_GraphicContext &p_gc);
 
+		/** Rebuilds level graphics from geometry of current snapshot */
+		void loadLevel(CL_GraphicContext &p_gc);
+
 		void loadDecorations(CL_GraphicContext &p_gc);
 
 		void loadSandPits(CL_GraphicContext &p_gc);
@@ -116,6 +183,9 @@ class RaceGraphics {
 
 		void updateSmokes(unsigned p_timeElapsed);
 
+		/** Picks detail tier from viewport scale */
+		void updateDetailLevel();
+
 
 		// drawing routines
 
@@ -125,7 +195,7 @@ class RaceGraphics {
 
 		void drawForeBlocks(CL_GraphicContext &p_gc);
 
-		void drawGroundBlock(CL_GraphicContext &p_gc, const Race::Block& p_block, size_t x, size_t y);
+		void drawGroundBlock(CL_GraphicContext &p_gc, Common::GroundBlockType p_type, size_t x, size_t y);
 
 		void drawTireTracks(CL_GraphicContext &p_gc);
 
@@ -133,7 +203,7 @@ class RaceGraphics {
 
 		void drawCars(CL_GraphicContext &p_gc);
 
-		void drawCar(CL_GraphicContext &p_gc, const Race::Car &p_car);
+		void drawCar(CL_GraphicContext &p_gc, const Race::RaceSnapshot::CarState &p_car);
 
 		void drawSmokes(CL_GraphicContext &p_gc);
 
@@ -142,6 +212,15 @@ class RaceGraphics {
 
 		void countFps();
 
+		/** Feeds frame work time to the governor and applies new quality */
+		void updateQuality(CL_GraphicContext &p_gc, unsigned p_drawTime);
+
+		/** @return Local player car state or NULL when not on level */
+		const Race::RaceSnapshot::CarState *getLocalCar() const;
+
+		/** @return Level blocks in the viewport with one block margin, right and bottom exclusive */
+		CL_Rect getVisibleBlocks() const;
+
 		// helpers
 
 		// FIXME: this is copy of Level helpers
@@ -30,6 +30,9 @@
 
 namespace Gfx {
 
+/** Bound line width */
+const float BOUND_WIDTH = 3.0f;
+
 Bound::Bound()
 {
 }
@@ -40,15 +43,20 @@ Bound::~Bound()
 
 void Bound::draw(CL_GraphicContext &p_gc)
 {
-	CL_Vec4f white_color(1.0f, 1.0f, 1.0f, 1.0f);
-
-	CL_Pen pen;
-	pen.set_line_width(3.0);
+	ClanLibRenderDevice device;
+	device.setGraphicContext(p_gc);
 
-	p_gc.set_pen(pen);
+	draw(device);
+}
 
+void Bound::draw(RenderDevice &p_device)
+{
+	p_device.drawLine(m_segment.p, m_segment.q, BOUND_WIDTH, CL_Colorf::white);
+}
 
-	CL_Draw::line(p_gc, m_segment.p, m_segment.q, CL_Colorf::white);
+void Bound::drawList(RenderDevice &p_device, const CL_Vec2f *p_points, unsigned p_pointCount)
+{
+	p_device.drawLines(p_points, p_pointCount, BOUND_WIDTH, CL_Colorf::white);
 }
 
 void Bound::load(CL_GraphicContext &p_gc)
@@ -31,6 +31,7 @@
 #include <ClanLib/core.h>
 
 #include "gfx/Drawable.h"
+#include "gfx/RenderDevice.h"
 
 namespace Gfx {
 
@@ -45,11 +46,17 @@ class Bound : public Drawable {
 
 		virtual void draw(CL_GraphicContext &p_gc);
 
+		void draw(RenderDevice &p_device);
+
 		virtual void load(CL_GraphicContext &p_gc);
 
 
 		void setSegment(const CL_LineSegment2f &p_segment) { m_segment = p_segment; }
 
+
+		/** Draws many bounds in one call, two points per bound */
+		static void drawList(RenderDevice &p_device, const CL_Vec2f *p_points, unsigned p_pointCount);
+
 	private:
 
 		CL_LineSegment2f m_segment;
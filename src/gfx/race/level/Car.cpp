@@ -30,11 +30,12 @@
 
 #include <assert.h>
 
-#include "gfx/Stage.h"
+#include "gfx/SpriteBatch.h"
 
 namespace Gfx {
 
-Car::Car()
+Car::Car(SpriteBatch &p_batch) :
+	m_batch(p_batch)
 {
 }
 
@@ -46,21 +47,14 @@ void Car::load(CL_GraphicContext &p_gc)
 {
 	Drawable::load(p_gc);
 
-	m_sprite = CL_Sprite(p_gc, "race/car", Stage::getResourceManager());
+	m_region = m_batch.getAtlas().getRegion("race/car");
 }
 
 void Car::draw(CL_GraphicContext &p_gc)
 {
 	assert(isLoaded());
 
-	p_gc.push_modelview();
-
-	p_gc.mult_translate(m_position.x, m_position.y);
-	p_gc.mult_rotate(m_rotation, 0, 0, 1);
-
-	m_sprite.draw(p_gc, 0, 0);
-
-	p_gc.pop_modelview();
+	m_batch.add(m_region, m_position, m_rotation);
 }
 
 }
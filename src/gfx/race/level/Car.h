@@ -31,17 +31,21 @@
 #include <ClanLib/core.h>
 
 #include "gfx/Drawable.h"
+#include "gfx/TextureAtlas.h"
 
 namespace Gfx {
 
+class SpriteBatch;
+
 class Car : public Gfx::Drawable {
 
 	public:
 
-		Car();
+		Car(SpriteBatch &p_batch);
 
 		virtual ~Car();
 
+		/** Queues the car in the sprite batch */
 		virtual void draw(CL_GraphicContext &p_gc);
 
 		virtual void load(CL_GraphicContext &p_gc);
@@ -53,7 +57,9 @@ class Car : public Gfx::Drawable {
 
 	private:
 
-		CL_Sprite m_sprite;
+		SpriteBatch &m_batch;
+
+		TextureAtlas::Region m_region;
 
 		CL_Pointf m_position;
 
@@ -28,12 +28,13 @@
 
 #include "DecorationSprite.h"
 
-#include "gfx/Stage.h"
+#include "gfx/SpriteBatch.h"
 
 namespace Gfx {
 
-DecorationSprite::DecorationSprite(const CL_String &p_spriteName) :
-		m_spriteName(p_spriteName)
+DecorationSprite::DecorationSprite(const CL_String &p_spriteName, SpriteBatch &p_batch) :
+		m_spriteName(p_spriteName),
+		m_batch(p_batch)
 {
 }
 
@@ -43,12 +44,12 @@ DecorationSprite::~DecorationSprite()
 
 void DecorationSprite::draw(CL_GraphicContext &p_gc)
 {
-	m_sprite.draw(p_gc, m_position.x, m_position.y);
+	m_batch.add(m_region, m_position);
 }
 
 void DecorationSprite::load(CL_GraphicContext &p_gc)
 {
-	m_sprite = CL_Sprite(p_gc, m_spriteName, Stage::getResourceManager());
+	m_region = m_batch.getAtlas().getRegion(m_spriteName);
 	Drawable::load(p_gc);
 }
 
@@ -29,18 +29,22 @@
 #pragma once
 
 #include "gfx/Drawable.h"
+#include "gfx/TextureAtlas.h"
 
 namespace Gfx {
 
+class SpriteBatch;
+
 class DecorationSprite: public Drawable {
 
 	public:
 
-		DecorationSprite(const CL_String &p_spriteName);
+		DecorationSprite(const CL_String &p_spriteName, SpriteBatch &p_batch);
 
 		virtual ~DecorationSprite();
 
 
+		/** Queues the decoration in the sprite batch */
 		virtual void draw(CL_GraphicContext &p_gc);
 
 		virtual void load(CL_GraphicContext &p_gc);
@@ -54,7 +58,9 @@ class DecorationSprite: public Drawable {
 
 		CL_String m_spriteName;
 
-		CL_Sprite m_sprite;
+		SpriteBatch &m_batch;
+
+		TextureAtlas::Region m_region;
 
 		CL_Pointf m_position;
 
@@ -30,12 +30,13 @@
 
 #include <assert.h>
 
-#include <gfx/Stage.h>
+#include "gfx/SpriteBatch.h"
 
 namespace Gfx {
 
-GroundBlock::GroundBlock(Common::GroundBlockType p_type) :
-	m_type(p_type)
+GroundBlock::GroundBlock(Common::GroundBlockType p_type, SpriteBatch &p_batch) :
+	m_type(p_type),
+	m_batch(p_batch)
 {
 }
 
@@ -45,20 +46,25 @@ GroundBlock::~GroundBlock()
 
 void GroundBlock::draw(CL_GraphicContext &p_gc)
 {
-	CL_Rect rect(
+	CL_Rectf rect(
 			m_position.x, m_position.y,
 			m_position.x + 200, m_position.y + 200
 	);
-	m_sprite.draw(p_gc, rect);
+	m_batch.add(m_region, rect);
 }
 
 void GroundBlock::load(CL_GraphicContext &p_gc)
 {
-	CL_String spriteName;
+	m_region = m_batch.getAtlas().getRegion(getSpriteName(m_type));
+
+	Drawable::load(p_gc);
+}
 
-//	cl_log_event("debug", "block type: %1", m_type);
+CL_String GroundBlock::getSpriteName(Common::GroundBlockType p_type)
+{
+	CL_String spriteName;
 
-	switch (m_type) {
+	switch (p_type) {
 		case Common::BT_GRASS:
 			spriteName = "race/block";
 			break;
@@ -87,8 +93,7 @@ void GroundBlock::load(CL_GraphicContext &p_gc)
 			assert(0 && "unknown block type");
 	}
 
-	m_sprite = CL_Sprite(p_gc, spriteName, Gfx::Stage::getResourceManager());
-
+	return spriteName;
 }
 
 } // namespace
@@ -33,19 +33,23 @@
 #include <ClanLib/core.h>
 
 #include "gfx/Drawable.h"
+#include "gfx/TextureAtlas.h"
 #include "common/GroundBlockType.h"
 
 namespace Gfx {
 
+class SpriteBatch;
+
 class GroundBlock : public Gfx::Drawable {
 
 	public:
 
-		GroundBlock(Common::GroundBlockType p_type);
+		GroundBlock(Common::GroundBlockType p_type, SpriteBatch &p_batch);
 
 		virtual ~GroundBlock();
 
 
+		/** Queues the block in the sprite batch */
 		virtual void draw(CL_GraphicContext &p_gc);
 
 		virtual void load(CL_GraphicContext &p_gc);
@@ -53,13 +57,20 @@ class GroundBlock : public Gfx::Drawable {
 
 		void setPosition(const CL_Pointf &p_position) { m_position = p_position; }
 
+
+		/** @return Resource name of the sprite for block type */
+		static CL_String getSpriteName(Common::GroundBlockType p_type);
+
 	private:
 
 		/** This block type (what is displays) */
 		Common::GroundBlockType m_type;
 
-		/** This block sprite */
-		CL_Sprite m_sprite;
+		/** Batch to draw with */
+		SpriteBatch &m_batch;
+
+		/** This block atlas region */
+		TextureAtlas::Region m_region;
 
 		/** Draw position. Where top left point should lay. */
 		CL_Pointf m_position;
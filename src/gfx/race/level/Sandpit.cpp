@@ -37,6 +37,15 @@
 
 namespace Gfx {
 
+/** Directory for baked sandpit textures */
+const CL_String CACHE_DIR = "cache";
+
+/** Cache file magic and format version */
+const unsigned CACHE_MAGIC = 0x53503031; // "SP01"
+
+/** Sand color */
+const unsigned SAND_COLOR = 0xFFFF00FF; // yellow
+
 Sandpit::Sandpit(const Race::Sandpit *p_logicSandpit) :
 	m_logicSandpit(p_logicSandpit),
 	m_built(false)
@@ -102,7 +111,13 @@ void Sandpit::build()
 	// prepare pixel data
 	m_pixelData = CL_SharedPtr<CL_PixelBuffer>(new CL_PixelBuffer(width, height, width * 4, CL_PixelFormat::rgba8888));
 
-	fillCircles(width, height, bounds);
+	// use baked texture when this sandpit was built before
+	const unsigned hash = calculateHash();
+
+	if (!loadFromCache(hash, width, height)) {
+		fillCircles(width, height, bounds);
+		saveToCache(hash);
+	}
 
 	// unset the texture to create is at the next draw
 	m_texture.disconnect();
@@ -112,50 +127,51 @@ void Sandpit::build()
 
 void Sandpit::fillCircles(int p_width, int p_height, const CL_Rect& p_totalBounds)
 {
-	int strike = p_width;
-	int *data = (int*) m_pixelData->get_data();
+	const int strike = p_width;
+	unsigned *data = (unsigned*) m_pixelData->get_data();
 
 	// clear all
-	memset(data, 0, strike * p_height);
+	memset(data, 0, strike * p_height * sizeof(unsigned));
 
-	// fill circles
-	CL_Rect circleBounds;
+	const int tx = -p_totalBounds.left;
+	const int ty = -p_totalBounds.top;
 
+	// fill circles row by row
 	const unsigned circleCount = m_logicSandpit->getCircleCount();
 
 	for (unsigned i = 0; i < circleCount; ++i) {
 		const Race::Sandpit::Circle &circle = m_logicSandpit->circleAt(i);
 
-		// here y points to bottom
-		circleBounds.left = circle.getCenter().x - circle.getRadius();
-		circleBounds.right = circle.getCenter().x + circle.getRadius();
-		circleBounds.top = circle.getCenter().y - circle.getRadius();
-		circleBounds.bottom = circle.getCenter().y + circle.getRadius();
-
-
-		int index;
+		const int cx = circle.getCenter().x + tx;
+		const int cy = circle.getCenter().y + ty;
+		const int r = circle.getRadius();
 
-		int tx = -p_totalBounds.left;
-		int ty = -p_totalBounds.top;
+		// half span width shrinks while going away from the center row
+		int dx = r;
 
-		cl_log_event("debug", "tx = %1, ty = %2", tx, ty);
-
-		for (int y = circleBounds.top; y <= circleBounds.bottom; ++y) {
-			for (int x = circleBounds.left; x <= circleBounds.right; ++x) {
-				CL_Point point(x, y);
-
-				if (point.distance(circle.getCenter()) <= circle.getRadius()) {
+		for (int dy = 0; dy <= r; ++dy) {
+			while (dx * dx + dy * dy > r * r) {
+				--dx;
+			}
 
-					index = (y + ty) * strike + (x + tx);
+			fillSpan(data + (cy + dy) * strike, cx - dx, cx + dx, SAND_COLOR);
 
-					assert(index < p_width * p_height && index >= 0);
-					data[index] = 0xFFFF00FF; // yellow
-				}
+			if (dy != 0) {
+				fillSpan(data + (cy - dy) * strike, cx - dx, cx + dx, SAND_COLOR);
 			}
 		}
 	}
 }
 
+void Sandpit::fillSpan(unsigned *p_row, int p_from, int p_to, unsigned p_color)
+{
+	assert(p_from >= 0 && p_to < m_pixelData->get_width());
+
+	for (int x = p_from; x <= p_to; ++x) {
+		p_row[x] = p_color;
+	}
+}
+
 CL_Rect Sandpit::calculateCircleBounds()
 {
 	CL_Rect bounds;
@@ -201,4 +217,72 @@ CL_Rect Sandpit::calculateCircleBounds()
 	return bounds;
 }
 
+unsigned Sandpit::calculateHash() const
+{
+	// FNV-1a over circle definitions
+	unsigned hash = 2166136261u;
+
+	const unsigned circleCount = m_logicSandpit->getCircleCount();
+
+	for (unsigned i = 0; i < circleCount; ++i) {
+		const Race::Sandpit::Circle &circle = m_logicSandpit->circleAt(i);
+
+		const int values[3] = { circle.getCenter().x, circle.getCenter().y, circle.getRadius() };
+
+		for (int j = 0; j < 3; ++j) {
+			hash = (hash ^ (unsigned) values[j]) * 16777619u;
+		}
+	}
+
+	return hash;
+}
+
+CL_String Sandpit::getCacheFilename(unsigned p_hash) const
+{
+	return cl_format("%1/sandpit_%2.raw", CACHE_DIR, CL_StringHelp::uint_to_hex(p_hash));
+}
+
+bool Sandpit::loadFromCache(unsigned p_hash, int p_width, int p_height)
+{
+	try {
+		CL_File file(getCacheFilename(p_hash), CL_File::open_existing, CL_File::access_read);
+
+		if (file.read_uint32() != CACHE_MAGIC) {
+			return false;
+		}
+
+		if ((int) file.read_uint32() != p_width || (int) file.read_uint32() != p_height) {
+			return false;
+		}
+
+		const int size = p_width * p_height * 4;
+		return file.read(m_pixelData->get_data(), size) == size;
+
+	} catch (CL_Exception e) {
+		// not cached yet
+		return false;
+	}
+}
+
+void Sandpit::saveToCache(unsigned p_hash)
+{
+	try {
+		// fails silently when directory exists
+		CL_Directory::create(CACHE_DIR);
+
+		CL_File file(getCacheFilename(p_hash), CL_File::create_always, CL_File::access_write);
+
+		const int width = m_pixelData->get_width();
+		const int height = m_pixelData->get_height();
+
+		file.write_uint32(CACHE_MAGIC);
+		file.write_uint32(width);
+		file.write_uint32(height);
+		file.write(m_pixelData->get_data(), width * height * 4);
+
+	} catch (CL_Exception e) {
+		cl_log_event(LOG_ERROR, "Cannot save sandpit cache: %1", e.message);
+	}
+}
+
 }
@@ -80,6 +80,20 @@ class Sandpit : public Gfx::Drawable {
 		CL_Rect calculateCircleBounds();
 
 		void fillCircles(int p_width, int p_height, const CL_Rect& p_totalBounds);
+
+		void fillSpan(unsigned *p_row, int p_from, int p_to, unsigned p_color);
+
+
+		// texture cache routines
+
+		/** @return Hash of sandpit circles used as cache key */
+		unsigned calculateHash() const;
+
+		CL_String getCacheFilename(unsigned p_hash) const;
+
+		bool loadFromCache(unsigned p_hash, int p_width, int p_height);
+
+		void saveToCache(unsigned p_hash);
 };
 
 }
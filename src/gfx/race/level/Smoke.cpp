@@ -30,11 +30,12 @@
 
 #include <assert.h>
 
-#include "gfx/Stage.h"
+#include "gfx/SpriteBatch.h"
 
 namespace Gfx {
 
-Smoke::Smoke(const CL_Pointf &p_position) :
+Smoke::Smoke(const CL_Pointf &p_position, SpriteBatch &p_batch) :
+		m_batch(p_batch),
 		m_position(p_position)
 {
 }
@@ -57,13 +58,13 @@ void Smoke::update(unsigned p_timeElapsed)
 {
 	Animation::update(p_timeElapsed);
 
-	m_alpha.update(p_timeElapsed);
-	m_size.update(p_timeElapsed);
+	Math::Float *const floats[] = { &m_alpha, &m_size };
+	Math::Float::updateAll(floats, 2, p_timeElapsed);
 }
 
 void Smoke::draw(CL_GraphicContext &p_gc)
 {
-	assert(!m_smokeSprite.is_null());
+	assert(isLoaded());
 
 	static const unsigned ANIMATION_END = 6000;
 
@@ -71,10 +72,10 @@ void Smoke::draw(CL_GraphicContext &p_gc)
 
 	if (now < ANIMATION_END) {
 
-		m_smokeSprite.set_alpha(m_alpha.get());
-		m_smokeSprite.set_scale(m_size.get(), m_size.get());
-
-		m_smokeSprite.draw(p_gc, m_position.x, m_position.y);
+		m_batch.add(
+				m_region, m_position, CL_Angle(), m_size.get(),
+				CL_Colorf(1.0f, 1.0f, 1.0f, m_alpha.get())
+		);
 	} else {
 		setFinished(true);
 	}
@@ -83,7 +84,9 @@ void Smoke::draw(CL_GraphicContext &p_gc)
 
 void Smoke::load(CL_GraphicContext &p_gc)
 {
-	m_smokeSprite = CL_Sprite(p_gc, "race/smoke", Stage::getResourceManager());
+	m_region = m_batch.getAtlas().getRegion("race/smoke");
+
+	Drawable::load(p_gc);
 }
 
 }
@@ -29,16 +29,19 @@
 #pragma once
 
 #include "gfx/Animation.h"
+#include "gfx/TextureAtlas.h"
 
 #include "math/Float.h"
 
 namespace Gfx {
 
+class SpriteBatch;
+
 class Smoke: public Gfx::Animation {
 
 	public:
 
-		Smoke(const CL_Pointf &p_position);
+		Smoke(const CL_Pointf &p_position, SpriteBatch &p_batch);
 
 		virtual ~Smoke();
 
@@ -52,8 +55,11 @@ class Smoke: public Gfx::Animation {
 
 	private:
 
-		/** The sprite */
-		CL_Sprite m_smokeSprite;
+		/** Batch to draw with */
+		SpriteBatch &m_batch;
+
+		/** Smoke atlas region */
+		TextureAtlas::Region m_region;
 
 		/** The position */
 		CL_Pointf m_position;
@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "TileMap.h"
+
+#if defined(GL2)
+
+#include <assert.h>
+#include <math.h>
+
+#include "common.h"
+#include "common/GroundBlockType.h"
+#include "gfx/TextureAtlas.h"
+#include "gfx/race/level/GroundBlock.h"
+#include "logic/race/Block.h"
+#include "logic/race/LevelGeometry.h"
+
+namespace Gfx {
+
+/** Number of block types */
+static const int TILE_COUNT = Common::BT_START_LINE_UP + 1;
+
+static const char *VERTEX_SHADER =
+	"attribute vec4 Position;\n"
+	"attribute vec2 TileCoord0;\n"
+	"varying vec2 TileCoord;\n"
+	"void main()\n"
+	"{\n"
+	"	gl_Position = gl_ModelViewProjectionMatrix * Position;\n"
+	"	TileCoord = TileCoord0;\n"
+	"}\n";
+
+/** Tile tables are sized with %1, filled with TILE_COUNT at build */
+static const char *FRAGMENT_SHADER =
+	"uniform sampler2D IndexTexture;\n"
+	"uniform sampler2D TileTexture;\n"
+	"uniform vec2 LevelSize;\n"
+	"uniform vec4 TileRects[%1];\n"
+	"uniform vec2 TileRotations[%1];\n"
+	"varying vec2 TileCoord;\n"
+	"void main()\n"
+	"{\n"
+	"	vec2 cell = floor(TileCoord);\n"
+	"	int type = int(texture2D(IndexTexture, (cell + 0.5) / LevelSize).r * 255.0 + 0.5);\n"
+	"	if (type == 0) {\n"
+	"		discard;\n" // grass is drawn with the back blocks
+	"	}\n"
+	"	vec2 p = fract(TileCoord) - 0.5;\n"
+	"	vec2 r = TileRotations[type];\n"
+	"	vec2 local = vec2(p.x * r.x + p.y * r.y, p.y * r.x - p.x * r.y) + 0.5;\n"
+	"	vec4 rect = TileRects[type];\n"
+	"	gl_FragColor = texture2D(TileTexture, mix(rect.xy, rect.zw, local));\n"
+	"}\n";
+
+TileMap::TileMap(const TextureAtlas &p_atlas) :
+	m_level(NULL),
+	m_atlas(p_atlas),
+	m_page(0)
+{
+}
+
+TileMap::~TileMap()
+{
+}
+
+void TileMap::load(CL_GraphicContext &p_gc)
+{
+	assert(m_level != NULL && "level not set");
+
+	if (!buildProgram(p_gc) || !buildIndexTexture(p_gc)) {
+		cl_log_event(LOG_ERROR, "Tile map not available, using block sprites");
+		return;
+	}
+
+	// tile rectangles and rotations for the shader
+	float rects[TILE_COUNT * 4];
+	float rotations[TILE_COUNT * 2];
+
+	static const float DEG_TO_RAD = 3.14159265f / 180.0f;
+
+	for (int i = 0; i < TILE_COUNT; ++i) {
+		const TextureAtlas::Region &region = m_atlas.getRegion(GroundBlock::getSpriteName((Common::GroundBlockType) i));
+
+		if (i == 0) {
+			m_page = region.m_page;
+		} else if (region.m_page != m_page) {
+			cl_log_event(LOG_ERROR, "Tile map needs all blocks on one atlas page, using block sprites");
+			return;
+		}
+
+		rects[i * 4 + 0] = region.m_texCoords.left;
+		rects[i * 4 + 1] = region.m_texCoords.top;
+		rects[i * 4 + 2] = region.m_texCoords.right;
+		rects[i * 4 + 3] = region.m_texCoords.bottom;
+
+		rotations[i * 2 + 0] = cos(region.m_baseAngle * DEG_TO_RAD);
+		rotations[i * 2 + 1] = sin(region.m_baseAngle * DEG_TO_RAD);
+	}
+
+	p_gc.set_program_object(m_program);
+
+	m_program.set_uniform1i("IndexTexture", 0);
+	m_program.set_uniform1i("TileTexture", 1);
+	m_program.set_uniform2f("LevelSize", m_level->m_width, m_level->m_height);
+	m_program.set_uniformfv("TileRects", 4, TILE_COUNT, rects);
+	m_program.set_uniformfv("TileRotations", 2, TILE_COUNT, rotations);
+
+	p_gc.reset_program_object();
+
+	Drawable::load(p_gc);
+}
+
+bool TileMap::buildProgram(CL_GraphicContext &p_gc)
+{
+	CL_ShaderObject vertexShader(p_gc, cl_shadertype_vertex, VERTEX_SHADER);
+
+	if (!vertexShader.compile()) {
+		cl_log_event(LOG_ERROR, "Tile map vertex shader: %1", vertexShader.get_info_log());
+		return false;
+	}
+
+	CL_ShaderObject fragmentShader(p_gc, cl_shadertype_fragment, cl_format(FRAGMENT_SHADER, TILE_COUNT));
+
+	if (!fragmentShader.compile()) {
+		cl_log_event(LOG_ERROR, "Tile map fragment shader: %1", fragmentShader.get_info_log());
+		return false;
+	}
+
+	m_program = CL_ProgramObject(p_gc);
+	m_program.attach(vertexShader);
+	m_program.attach(fragmentShader);
+	m_program.bind_attribute_location(0, "Position");
+	m_program.bind_attribute_location(1, "TileCoord0");
+
+	if (!m_program.link()) {
+		cl_log_event(LOG_ERROR, "Tile map program: %1", m_program.get_info_log());
+		return false;
+	}
+
+	return true;
+}
+
+bool TileMap::buildIndexTexture(CL_GraphicContext &p_gc)
+{
+	const int width = m_level->m_width;
+	const int height = m_level->m_height;
+
+	if (width <= 0 || height <= 0) {
+		return false;
+	}
+
+	CL_PixelBuffer indexData(width, height, width * 4, CL_PixelFormat::rgba8888);
+	unsigned *data = (unsigned*) indexData.get_data();
+
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+			// block type in every channel
+			data[y * width + x] = m_level->getBlockType(x, y) * 0x01010101u;
+		}
+	}
+
+	m_indexTexture = CL_Texture(p_gc, width, height);
+	m_indexTexture.set_image(indexData);
+	m_indexTexture.set_min_filter(cl_filter_nearest);
+	m_indexTexture.set_mag_filter(cl_filter_nearest);
+
+	return true;
+}
+
+void TileMap::draw(CL_GraphicContext &p_gc)
+{
+	assert(isLoaded());
+
+	// cover only visible part of the level
+	CL_Rectf area(0, 0, m_level->m_width * Race::Block::WIDTH, m_level->m_height * Race::Block::WIDTH);
+	area.overlap(m_visibleArea);
+
+	if (area.get_width() <= 0 || area.get_height() <= 0) {
+		return;
+	}
+
+	const float tile = Race::Block::WIDTH;
+
+	const CL_Vec2f positions[6] = {
+		CL_Vec2f(area.left, area.top), CL_Vec2f(area.right, area.top), CL_Vec2f(area.right, area.bottom),
+		CL_Vec2f(area.left, area.top), CL_Vec2f(area.right, area.bottom), CL_Vec2f(area.left, area.bottom)
+	};
+
+	const CL_Vec2f tileCoords[6] = {
+		CL_Vec2f(area.left / tile, area.top / tile), CL_Vec2f(area.right / tile, area.top / tile), CL_Vec2f(area.right / tile, area.bottom / tile),
+		CL_Vec2f(area.left / tile, area.top / tile), CL_Vec2f(area.right / tile, area.bottom / tile), CL_Vec2f(area.left / tile, area.bottom / tile)
+	};
+
+	CL_PrimitivesArray primitives(p_gc);
+	primitives.set_attributes(0, positions);
+	primitives.set_attributes(1, tileCoords);
+
+	// Tile coordinates restart at every block edge, so derivatives there
+	// would pick the smallest mipmap and draw seams. Page is sampled from
+	// its base level while tiles are drawn.
+	CL_Texture page = m_atlas.getPage(m_page);
+	page.set_min_filter(cl_filter_linear);
+
+	p_gc.set_texture(0, m_indexTexture);
+	p_gc.set_texture(1, page);
+	p_gc.set_program_object(m_program);
+
+	p_gc.draw_primitives(cl_triangles, 6, primitives);
+
+	page.set_min_filter(cl_filter_linear_mipmap_linear);
+
+	p_gc.reset_program_object();
+	p_gc.reset_texture(1);
+	p_gc.reset_texture(0);
+}
+
+} // namespace
+
+#endif // GL2
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#if defined(GL2)
+
+#include <ClanLib/core.h>
+#include <ClanLib/display.h>
+
+#include "gfx/Drawable.h"
+
+namespace Race {
+	struct LevelGeometry;
+}
+
+namespace Gfx {
+
+class TextureAtlas;
+
+/**
+ * Draws all street blocks of the level in one pass. Block types are
+ * stored in an index texture and the fragment shader picks the tile from
+ * the atlas, so drawing cost does not depend on block count.
+ */
+class TileMap : public Gfx::Drawable {
+
+	public:
+
+		TileMap(const TextureAtlas &p_atlas);
+
+		virtual ~TileMap();
+
+
+		virtual void draw(CL_GraphicContext &p_gc);
+
+		/**
+		 * Compiles the shader and uploads the block grid. When shader cannot
+		 * be used then tile map stays not loaded.
+		 */
+		virtual void load(CL_GraphicContext &p_gc);
+
+
+		/** Sets level to draw, has to be called before load() */
+		void setLevel(const Race::LevelGeometry &p_level) { m_level = &p_level; }
+
+		/** Sets the area that should be covered (in level coordinates) */
+		void setVisibleArea(const CL_Rectf &p_area) { m_visibleArea = p_area; }
+
+	private:
+
+		/** The level */
+		const Race::LevelGeometry *m_level;
+
+		/** Atlas with tile images */
+		const TextureAtlas &m_atlas;
+
+		/** Atlas page containing all tiles */
+		unsigned m_page;
+
+		/** Block types, one texel per block */
+		CL_Texture m_indexTexture;
+
+		/** Tile map shader */
+		CL_ProgramObject m_program;
+
+		/** Area to cover */
+		CL_Rectf m_visibleArea;
+
+
+		bool buildProgram(CL_GraphicContext &p_gc);
+
+		bool buildIndexTexture(CL_GraphicContext &p_gc);
+};
+
+} // namespace
+
+#endif // GL2
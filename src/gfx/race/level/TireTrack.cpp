@@ -30,6 +30,9 @@
 
 namespace Gfx {
 
+/** Track line width */
+const float TIRE_TRACK_WIDTH = 3.0f;
+
 TireTrack::TireTrack()
 {
 }
@@ -40,12 +43,21 @@ TireTrack::~TireTrack()
 
 void TireTrack::draw(CL_GraphicContext &p_gc)
 {
-	CL_Pen pen;
-	pen.set_line_width(3);
-	p_gc.set_pen(pen);
+	ClanLibRenderDevice device;
+	device.setGraphicContext(p_gc);
+
+	draw(device);
+}
 
+void TireTrack::draw(RenderDevice &p_device)
+{
 	// TODO: how to make blend?
-	CL_Draw::line(p_gc, m_fromPoint, m_toPoint, CL_Colorf(0.0f, 0.0f, 0.0f, m_fromAlpha));
+	p_device.drawLine(m_fromPoint, m_toPoint, TIRE_TRACK_WIDTH, CL_Colorf(0.0f, 0.0f, 0.0f, m_fromAlpha));
+}
+
+void TireTrack::drawList(RenderDevice &p_device, const CL_Vec2f *p_points, unsigned p_pointCount)
+{
+	p_device.drawLines(p_points, p_pointCount, TIRE_TRACK_WIDTH, CL_Colorf(0.0f, 0.0f, 0.0f, TIRE_TRACK_DEFAULT_ALPHA));
 }
 
 void TireTrack::load(CL_GraphicContext &p_gc)
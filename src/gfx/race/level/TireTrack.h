@@ -33,6 +33,7 @@
 #include <ClanLib/core.h>
 
 #include "gfx/Drawable.h"
+#include "gfx/RenderDevice.h"
 
 namespace Gfx {
 
@@ -47,6 +48,8 @@ class TireTrack : public Gfx::Drawable {
 
 		virtual void draw(CL_GraphicContext &p_gc);
 
+		void draw(RenderDevice &p_device);
+
 		virtual void load(CL_GraphicContext &p_gc);
 
 
@@ -54,6 +57,10 @@ class TireTrack : public Gfx::Drawable {
 
 		void setToPoint(const CL_Pointf &p_to, float p_alpha = TIRE_TRACK_DEFAULT_ALPHA);
 
+
+		/** Draws many default tracks in one call, two points per track */
+		static void drawList(RenderDevice &p_device, const CL_Vec2f *p_points, unsigned p_pointCount);
+
 	private:
 
 		/** Track line */
@@ -33,9 +33,9 @@
 
 #include "common/Game.h"
 #include "common.h"
+#include "debug/DebugProperties.h"
 #include "logic/race/Block.h"
-#include "logic/race/OfflineRaceLogic.h"
-#include "logic/race/OnlineRaceLogic.h"
+#include "logic/race/LogicThread.h"
 #include "network/events.h"
 #include "network/packets/CarState.h"
 #include "network/client/Client.h"
@@ -55,6 +55,7 @@ RaceScene::RaceScene(CL_GUIComponent *p_guiParent) :
 
 #endif // !RACE_SCENE_ONLY
 	m_logic(NULL),
+	m_logicThread(NULL),
 	m_graphics(NULL),
 	m_lapsTotal(3),
 	m_initialized(false),
@@ -71,6 +72,10 @@ RaceScene::RaceScene(CL_GUIComponent *p_guiParent) :
 
 #endif
 
+#if !defined(NDEBUG)
+	m_slots.connect(Dbg::ITER_SPEED.sig_changed(), this, &RaceScene::onIterSpeedChanged);
+#endif // !NDEBUG
+
 	Game &game = Game::getInstance();
 	// countdown ends
 	m_raceStartTimer.func_expired().set(this, &RaceScene::onCountdownEnds);
@@ -83,13 +88,14 @@ RaceScene::~RaceScene() {
 void RaceScene::initialize(const CL_String &p_hostname, int p_port)
 {
 	if (!m_initialized) {
-		if (p_hostname == "") {
-			m_logic = new Race::OfflineRaceLogic("resources/level.xml");
-		} else {
-			m_logic = new Race::OnlineRaceLogic(p_hostname, p_port);
-		}
+		m_logicThread = new Race::LogicThread(p_hostname, p_port);
+		m_logicThread->start();
+
+#if !defined(NDEBUG)
+		m_logicThread->setTimeScale(Dbg::ITER_SPEED.get());
+#endif // !NDEBUG
 
-		m_logic->initialize();
+		m_logic = &m_logicThread->getLogic();
 		m_graphics = new Gfx::RaceGraphics(m_logic);
 
 		m_initialized = true;
@@ -100,12 +106,16 @@ void RaceScene::initialize(const CL_String &p_hostname, int p_port)
 void RaceScene::destroy()
 {
 	if (m_initialized) {
-		delete m_logic;
-		m_logic = NULL;
-
+		// graphics reads the logic, so goes first
 		delete m_graphics;
 		m_graphics = NULL;
 
+		m_logicThread->stop();
+		m_logic = NULL;
+
+		delete m_logicThread;
+		m_logicThread = NULL;
+
 		m_initialized = false;
 	}
 }
@@ -137,8 +147,11 @@ void RaceScene::update(unsigned p_timeElapsed)
 {
 	assert(m_initialized);
 
-	m_logic->update(p_timeElapsed);
+	// logic is updated by the logic thread
 	m_graphics->update(p_timeElapsed);
+
+	const CL_Rectf view = m_graphics->getViewport().getBounds();
+	m_logic->setViewExtent(CL_Sizef(view.get_width(), view.get_height()));
 }
 
 
@@ -163,8 +176,6 @@ void RaceScene::handleInput(InputState p_state, const CL_InputEvent& p_event)
 {
 	assert(m_initialized);
 
-	Race::Car &car = Game::getInstance().getPlayer().getCar();
-
 	bool state;
 
 	switch (p_state) {
@@ -186,13 +197,13 @@ void RaceScene::handleInput(InputState p_state, const CL_InputEvent& p_event)
 			m_turnRight = state;
 			break;
 		case CL_KEY_UP:
-			car.setAcceleration(state);
+			m_input.m_acceleration = state;
 			break;
 		case CL_KEY_DOWN:
-			car.setBrake(state);
+			m_input.m_brake = state;
 			break;
 		case CL_KEY_SPACE:
-			car.setHandbrake(state);
+			m_input.m_handbrake = state;
 			break;
 #ifndef NDEBUG
 		case CL_KEY_BACKSPACE:
@@ -210,7 +221,7 @@ void RaceScene::handleInput(InputState p_state, const CL_InputEvent& p_event)
 		Gfx::Stage::popScene();
 	}
 
-	updateCarTurn();
+	updateCarInput();
 
 #if !defined(NDEBUG)
 	// debug key bindings
@@ -218,12 +229,12 @@ void RaceScene::handleInput(InputState p_state, const CL_InputEvent& p_event)
 #endif // !NDEBUG
 }
 
-void RaceScene::updateCarTurn()
+void RaceScene::updateCarInput()
 {
 	assert(m_initialized);
 
-	Race::Car &car = Game::getInstance().getPlayer().getCar();
-	car.setTurn((int) -m_turnLeft + (int) m_turnRight);
+	m_input.m_turn = (int) -m_turnLeft + (int) m_turnRight;
+	m_logic->setInput(m_input);
 }
 
 void RaceScene::startRace()
@@ -261,6 +272,16 @@ void RaceScene::onCountdownEnds()
 	m_inputLock = false;
 }
 
+void RaceScene::onIterSpeedChanged()
+{
+	const int iterSpeed = Dbg::ITER_SPEED.get();
+	cl_log_event("debug", "Iteration speed changed to %1", iterSpeed);
+
+	if (m_initialized) {
+		m_logicThread->setTimeScale(iterSpeed);
+	}
+}
+
 void RaceScene::onInputLock()
 {
 	assert(m_initialized);
@@ -44,6 +44,10 @@ namespace Gfx {
 	class RaceGraphics;
 }
 
+namespace Race {
+	class LogicThread;
+}
+
 #if defined(RACE_SCENE_ONLY)
 
 class RaceScene
@@ -86,6 +90,9 @@ class RaceScene: public Scene
 		/** Logic subsystem */
 		Race::RaceLogic *m_logic;
 
+		/** Thread running the logic */
+		Race::LogicThread *m_logicThread;
+
 		/** Graphics subsystem */
 		Gfx::RaceGraphics *m_graphics;
 
@@ -114,6 +121,9 @@ class RaceScene: public Scene
 		/** Keys down */
 		bool m_turnLeft, m_turnRight;
 
+		/** Local car controls passed to the logic */
+		Race::RaceLogic::Input m_input;
+
 		// display
 
 		/** Last drift car position. If null, then no drift was doing last time. */
@@ -140,7 +150,7 @@ class RaceScene: public Scene
 
 		void handleInput(InputState p_state, const CL_InputEvent& p_event);
 
-		void updateCarTurn();
+		void updateCarInput();
 
 		// flow control
 
@@ -158,6 +168,8 @@ class RaceScene: public Scene
 
 		void onCountdownEnds();
 
+		void onIterSpeedChanged();
+
 		void onInputLock();
 
 		void onRaceStateChanged(int p_lapsNum);
@@ -33,20 +33,6 @@ namespace Race {
 Bound::Bound(const CL_LineSegment2f &p_segment) :
 	m_segment(p_segment)
 {
-#ifndef SERVER
-	// build this bound contour
-	CL_Contour contour;
-
-	contour.get_points().push_back(p_segment.p);
-	contour.get_points().push_back(p_segment.q);
-
-	m_collisionOutline.get_contours().push_back(contour);
-
-	m_collisionOutline.set_inside_test(true);
-
-	m_collisionOutline.calculate_radius();
-	m_collisionOutline.calculate_smallest_enclosing_discs();
-#endif // !SERVER
 }
 
 Bound::~Bound() {
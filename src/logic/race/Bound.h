@@ -31,10 +31,6 @@
 #include <boost/utility.hpp>
 #include <ClanLib/core.h>
 
-#ifdef CLIENT
-#include <ClanLib/display.h>
-#endif // CLIENT
-
 namespace Race {
 
 class Bound : public boost::noncopyable
@@ -52,18 +48,6 @@ class Bound : public boost::noncopyable
 		/** Segment of this bound */
 		CL_LineSegment2f m_segment;
 
-#ifndef SERVER
-	public:
-
-		const CL_CollisionOutline &getCollisionOutline() const { return m_collisionOutline; }
-
-	private:
-
-		CL_CollisionOutline m_collisionOutline;
-
-
-#endif // !SERVER
-
 };
 
 } // namespace
@@ -29,11 +29,12 @@
 #include "common.h"
 #include "common/Game.h"
 #include "common/Properties.h"
-#include "gfx/Stage.h"
-#include "gfx/DebugLayer.h"
+#include "debug/Metrics.h"
 #include "logic/race/Car.h"
 #include "logic/race/Level.h"
 
+#include <assert.h>
+#include <algorithm>
 #include <ClanLib/core.h>
 
 namespace Race {
@@ -44,6 +45,10 @@ const int CAR_WIDTH = 18;
 /* Car height in pixels */
 const int CAR_HEIGHT = 24;
 
+const Dbg::Gauge SPEED_METRIC("speed");
+
+const Dbg::MinMax RESISTANCE_METRIC("resist");
+
 Car::Car() :
 	m_level(NULL),
 	m_locked(false),
@@ -62,28 +67,34 @@ Car::Car() :
 	m_currentCheckpoint(NULL),
 	m_boundHitTest(false)
 {
-#ifndef SERVER
-	// build car contour for collision check
-	CL_Contour contour;
-
-	const int halfWidth = CAR_WIDTH / 2;
-	const int halfHeight = CAR_HEIGHT / 2;
-	contour.get_points().push_back(CL_Pointf(-halfWidth, halfHeight));
-	contour.get_points().push_back(CL_Pointf(halfWidth, halfHeight));
-	contour.get_points().push_back(CL_Pointf(halfWidth, -halfHeight));
-	contour.get_points().push_back(CL_Pointf(-halfWidth, -halfHeight));
-
-	m_collisionOutline.get_contours().push_back(contour);
-
-	m_collisionOutline.set_inside_test(true);
-
-	m_collisionOutline.calculate_radius();
-	m_collisionOutline.calculate_smallest_enclosing_discs();
-#endif // !SERVERs
 }
 
 Car::~Car() {
 }
+
+void Car::reset()
+{
+	assert(m_level == NULL && "car is still on a level");
+
+	m_locked = false;
+	m_position = CL_Pointf(300.0f, 300.0f);
+	m_rotation = CL_Angle(0, cl_degrees);
+	m_turn = 0.0f;
+	m_acceleration = false;
+	m_brake = false;
+	m_handbrake = false;
+	m_moveVector = CL_Vec2f();
+	accelerationVector = CL_Vec2f();
+	m_speed = 0.0f;
+	m_angle = 0.0f;
+	m_inputChecksum = 0;
+	m_lap = 0;
+	m_timeFromLastUpdate = 0;
+	m_greatestCheckpointId = 0;
+	m_currentCheckpoint = NULL;
+	m_boundSegment = CL_LineSegment2f();
+	m_boundHitTest = false;
+}
 void Car::update(unsigned p_timeElapsed)
 {
 	m_timeFromLastUpdate += p_timeElapsed;
@@ -273,14 +284,13 @@ void Car::update1_60() {
 		m_rotation.set_degrees( atan2( rotVector.y, rotVector.x ) * 180.0f / 3.14f );
 	}
 	
-#ifdef CLIENT
+	SPEED_METRIC.set(m_speed);
+
 #ifndef NDEBUG
-			Gfx::Stage::getDebugLayer()->putMessage(CL_String8("speed"),  CL_StringHelp::float_to_local8(m_speed));
-			if (m_level != NULL) {
-				Gfx::Stage::getDebugLayer()->putMessage(CL_String8("resist"), CL_StringHelp::float_to_local8(m_level->getResistance(m_position.x, m_position.y)));
-			}
+	if (m_level != NULL) {
+		RESISTANCE_METRIC.record(m_level->getResistance(m_position.x, m_position.y));
+	}
 #endif // NDEBUG
-#endif // CLIENT
 }
 
 int Car::prepareStatusEvent(CL_NetGameEvent &p_event) {
@@ -358,6 +368,9 @@ void Car::applyCarState(const Net::CarState &p_carState)
 	m_turn = p_carState.getTurn();
 	m_acceleration = p_carState.getAcceleration() > 0.0f;
 	m_brake = p_carState.getAcceleration() < 0.0f;
+
+	// hit, if any, is checked again at new position
+	m_boundHitTest = false;
 }
 
 int Car::calculateInputChecksum() const {
@@ -369,6 +382,11 @@ int Car::calculateInputChecksum() const {
 	return checksum;
 }
 
+void Car::setLocked(bool p_locked)
+{
+	m_locked = p_locked;
+}
+
 void Car::setStartPosition(int p_startPosition) {
 	if (m_level != NULL) {
 		m_position = m_level->getStartPosition(p_startPosition);
@@ -403,25 +421,55 @@ bool Car::isDrifting() const {
 	
 }
 
-#ifdef CLIENT
-CL_CollisionOutline Car::calculateCurrentCollisionOutline() const
+bool Car::collides(const CL_LineSegment2f &p_segment) const
 {
-	CL_CollisionOutline outline(m_collisionOutline);
+	// segment in car space, where body is a box of width across the
+	// heading and height along it
+	const float rad = m_rotation.to_radians();
+
+	const CL_Vec2f along(cos(rad), sin(rad));
+	const CL_Vec2f across(-sin(rad), cos(rad));
+
+	const CL_Vec2f p = p_segment.p - m_position;
+	const CL_Vec2f q = p_segment.q - m_position;
 
-//	outline.calculate_smallest_enclosing_discs();
-//	outline.set_inside_test(true);
+	const float x = p.dot(across);
+	const float y = p.dot(along);
+	const float dx = q.dot(across) - x;
+	const float dy = q.dot(along) - y;
 
+	// clip segment to the box, Liang-Barsky
+	const float halfWidth = CAR_WIDTH / 2;
+	const float halfHeight = CAR_HEIGHT / 2;
 
-	// transform the outline
-	CL_Angle angle(90, cl_degrees);
-	angle += m_rotation;
+	const float directions[4] = { -dx, dx, -dy, dy };
+	const float distances[4] = { x + halfWidth, halfWidth - x, y + halfHeight, halfHeight - y };
 
-	outline.set_angle(angle);
-	outline.set_translation(m_position.x, m_position.y);
+	float enter = 0.0f, leave = 1.0f;
+
+	for (int i = 0; i < 4; ++i) {
+		if (directions[i] == 0.0f) {
+			// parallel to edge, outside of it
+			if (distances[i] < 0.0f) {
+				return false;
+			}
+		} else {
+			const float t = distances[i] / directions[i];
+
+			if (directions[i] < 0.0f) {
+				enter = std::max(enter, t);
+			} else {
+				leave = std::min(leave, t);
+			}
+
+			if (enter > leave) {
+				return false;
+			}
+		}
+	}
 
-	return outline;
+	return true;
 }
-#endif // CLIENT
 
 void Car::updateCurrentCheckpoint(const Checkpoint *p_checkpoint)
 {
@@ -31,6 +31,10 @@
 #include <ClanLib/core.h>
 #include <ClanLib/network.h>
 
+#ifdef CLIENT
+#include <ClanLib/display.h>
+#endif // CLIENT
+
 #include "common.h"
 #include "logic/race/Bound.h"
 #include "logic/race/Checkpoint.h"
@@ -55,6 +59,12 @@ class Car
 
 		virtual ~Car();
 
+		/**
+		 * Brings back the state of a new car. Signal connections are kept,
+		 * car has to be removed from its level first.
+		 */
+		void reset();
+
 		const Checkpoint *getCurrentCheckpoint() const { return m_currentCheckpoint; }
 
 		int getLap() const { return m_lap; }
@@ -67,6 +77,8 @@ class Car
 
 		float getSpeed() const { return m_speed; }
 
+		const CL_Vec2f &getMoveVector() const { return m_moveVector; }
+
 		/** @return Car speed in km/s */
 		float getSpeedKMS() const { return m_speed / 3.0f; }
 		
@@ -117,17 +129,14 @@ class Car
 		 */
 		void updateCurrentCheckpoint(const Checkpoint *p_checkpoint);
 
-#ifndef SERVER
-		/** @return Current collision outline based on car position and rotation */
-		CL_CollisionOutline calculateCurrentCollisionOutline() const;
+		/** @return True if car body touches the segment */
+		bool collides(const CL_LineSegment2f &p_segment) const;
 
 		/** Invoked when collision with bound has occurred */
 		void performBoundCollision(const Bound &p_bound) {
 			m_boundSegment = p_bound.getSegment();
 			m_boundHitTest = true;
 		}
-		
-#endif // !SERVER
 
 	private:
 		
@@ -191,14 +200,9 @@ class Car
 
 		friend class Race::Level;
 
-#ifdef CLIENT
-		/** Body outline for collision check */
-		CL_CollisionOutline m_collisionOutline;
-
-#ifndef NDEBUG
+#if defined(CLIENT) && !defined(NDEBUG)
 		void debugDrawLine(CL_GraphicContext &p_gc, float x1, float y1, float x2, float y2, const CL_Color& p_color);
-#endif // !NDEBUG
-#endif // CLIENT
+#endif // CLIENT && !NDEBUG
 
 #if defined(DRAW_CAR_VECTORS) && !defined(NDEBUG)
 friend class Gfx::RaceGraphics;
@@ -35,9 +35,21 @@
 #include "Checkpoint.h"
 #include "Car.h"
 #include "resistance/Geometry.h"
+#include "debug/Profiler.h"
 
 namespace Race {
 
+namespace {
+
+	/** Clears vector and gives its memory back */
+	template <typename T>
+	void release(std::vector<T> &p_vector)
+	{
+		std::vector<T>().swap(p_vector);
+	}
+
+} // namespace
+
 Level::Level() :
 	m_initialized(false),
 	m_loaded(false),
@@ -49,8 +61,15 @@ Level::Level() :
 void Level::initialize(const CL_String &p_filename)
 {
 	if (!m_initialized) {
+		MEMORY_SCOPE(Dbg::MT_LEVEL);
+
+		m_memoryBaseline = Dbg::MemoryTracker::getStats(Dbg::MT_LEVEL);
 		loadFromFile(p_filename);
 
+		if (m_loaded) {
+			buildGeometry();
+		}
+
 		m_initialized = true;
 	}
 }
@@ -58,12 +77,12 @@ void Level::initialize(const CL_String &p_filename)
 void Level::destroy()
 {
 	if (m_initialized) {
-		m_blocks.clear();
+		release(m_blocks);
 		m_track.clear();
-		m_bounds.clear();
-		m_sandpits.clear();
+		release(m_bounds);
+		release(m_sandpits);
 		m_resistanceMap.clear();
-		m_cars.clear();
+		release(m_cars);
 
 		std::pair<Car*, CL_Pointf*> entry;
 		foreach(entry, m_carsDriftPoints) {
@@ -75,7 +94,16 @@ void Level::destroy()
 		m_startPositions.clear();
 		m_tyreStripes.clear();
 
+		// published copies live until graphics let them go
+		m_geometry.reset();
+
 		m_loaded = false;
+		m_initialized = false;
+
+		// Stats are process wide per tag, not per level. Level memory of
+		// other live levels (like the static one of server or bench)
+		// allocated or freed since initialize() is reported here as well.
+		Dbg::MemoryTracker::reportLeaks(Dbg::MT_LEVEL, m_memoryBaseline, "Level::destroy");
 	}
 }
 
@@ -92,6 +120,8 @@ CL_String8 Level::readLine(CL_File& p_file) {
 
 void Level::loadFromFile(const CL_String& p_filename)
 {
+	PROFILE_ZONE(Dbg::Z_LEVEL_LOAD);
+
 	assert(!m_loaded && "level is already loaded");
 
 	try {
@@ -129,6 +159,39 @@ void Level::loadFromFile(const CL_String& p_filename)
 
 }
 
+void Level::buildGeometry()
+{
+	// owned by graphics in the end, not counted as level memory
+	MEMORY_SCOPE(Dbg::MT_GFX);
+
+	LevelGeometry *geometry = new LevelGeometry();
+
+	geometry->m_width = m_width;
+	geometry->m_height = m_height;
+
+	geometry->m_blocks.reserve(m_blocks.size());
+
+	foreach (const CL_SharedPtr<Block> &block, m_blocks) {
+		geometry->m_blocks.push_back(block->getType());
+	}
+
+	geometry->m_bounds.reserve(m_bounds.size());
+
+	foreach (const CL_SharedPtr<Bound> &bound, m_bounds) {
+		geometry->m_bounds.push_back(bound->getSegment());
+	}
+
+	geometry->m_sandpits = m_sandpits;
+
+	const unsigned checkpointCount = m_track.getCheckpointCount();
+
+	for (unsigned i = 0; i < checkpointCount; ++i) {
+		geometry->m_checkpoints.push_back(m_track.getCheckpoint(i)->getPosition());
+	}
+
+	m_geometry.reset(geometry);
+}
+
 void Level::loadMetaElement(const CL_DomNode &p_metaNode)
 {
 	m_width = p_metaNode.select_int("size/width");
@@ -401,6 +464,8 @@ void Level::addCar(Car *p_car) {
 
 	assert(m_loaded && "Level is not loaded");
 
+	MEMORY_SCOPE(Dbg::MT_LEVEL);
+
 	p_car->m_level = this;
 
 
@@ -440,6 +505,8 @@ CL_Pointf Level::getStartPosition(int p_num) const {
 
 void Level::updateCheckpoints()
 {
+	PROFILE_ZONE(Dbg::Z_CHECKPOINTS);
+
 	foreach(Car *car, m_cars) {
 
 		const Checkpoint *currentCheckpoint = car->getCurrentCheckpoint() ? car->getCurrentCheckpoint() : m_track.getFirst();
@@ -466,13 +533,16 @@ void Level::updateCheckpoints()
 
 void Level::update(unsigned p_timeElapsed)
 {
+	MEMORY_SCOPE(Dbg::MT_LEVEL);
+
 	updateCheckpoints();
+	checkCollistions();
 
 #ifdef CLIENT
 
-	checkCollistions();
-
 #ifndef NO_TYRE_STRIPES
+	PROFILE_ZONE(Dbg::Z_TYRE_STRIPES);
+
 	foreach (Car* car, m_cars) {
 
 		CL_Pointf* lastDriftPoints = m_carsDriftPoints[car];
@@ -529,40 +599,24 @@ void Level::update(unsigned p_timeElapsed)
 #endif // CLIENT
 }
 
-#ifdef CLIENT
 void Level::checkCollistions()
 {
-	CL_CollisionOutline coll1, coll2;
-
-
-	foreach (Car *c1, m_cars) {
-		coll1 = c1->calculateCurrentCollisionOutline();
-
-		// check car collisions
-		// TODO: later :-)
-//		foreach (Car *c2, m_cars) {
-//
-//			if (c1 == c2) {
-//				continue;
-//			}
-//
-//			coll2 = c2->calculateCurrentCollisionOutline();
-//
-//			if (coll1.collide(coll2)) {
-//				cl_log_event("debug", "collision");
-//			}
-//		}
-
-		// check bounds collisions
-		foreach (const CL_SharedPtr<Bound> &bound, m_bounds) {
-			if (coll1.collide(bound->getCollisionOutline())) {
-				c1->performBoundCollision(*bound);
-			}
-		}
+	PROFILE_ZONE(Dbg::Z_COLLISIONS);
+
+	// TODO: car collisions
+	foreach (Car *car, m_cars) {
+		checkBoundCollisions(*car);
 	}
+}
 
+void Level::checkBoundCollisions(Car &p_car) const
+{
+	foreach (const CL_SharedPtr<Bound> &bound, m_bounds) {
+		if (p_car.collides(bound->getSegment())) {
+			p_car.performBoundCollision(*bound);
+		}
+	}
 }
-#endif // CLIENT
 
 CL_Pointf Level::real(const CL_Pointf &p_point) const
 {
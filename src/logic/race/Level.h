@@ -28,13 +28,16 @@
 
 #pragma once
 
+#include <boost/shared_ptr.hpp>
 #include <ClanLib/core.h>
 
 #include "common.h"
+#include "LevelGeometry.h"
 #include "Track.h"
 #include "TyreStripes.h"
 #include "Sandpit.h"
 #include "common/GroundBlockType.h"
+#include "debug/MemoryTracker.h"
 #include "resistance/ResistanceMap.h"
 
 namespace Race {
@@ -63,6 +66,12 @@ class Level
 
 		DEPRECATED(void update(unsigned p_timeElapsed));
 
+		/**
+		 * Marks bound hit on car touching any bound, it bounces off on its
+		 * next step. Done for every car on update.
+		 */
+		void checkBoundCollisions(Car &p_car) const;
+
 		const Sandpit &sandpitAt(unsigned p_index) const;
 
 
@@ -98,6 +107,12 @@ class Level
 
 		const TyreStripes &getTyreStripes() const { return m_tyreStripes; }
 
+		/**
+		 * @return Drawing data of loaded level, empty when not loaded. It is
+		 * never changed, reload makes a new one.
+		 */
+		const boost::shared_ptr<const LevelGeometry> &getGeometry() const { return m_geometry; }
+
 
 
 
@@ -141,6 +156,12 @@ class Level
 		/** Tyre stripes */
 		TyreStripes m_tyreStripes;
 
+		/** Drawing data shared with graphics */
+		boost::shared_ptr<const LevelGeometry> m_geometry;
+
+		/** Level tagged memory before initialization, for leak report */
+		Dbg::MemoryTracker::TagStats m_memoryBaseline;
+
 
 
 		Level(const Level& p_level);
@@ -167,6 +188,9 @@ class Level
 
 		CL_SharedPtr<RaceResistance::Geometry> buildResistanceGeometry(int p_x, int p_y, Common::GroundBlockType p_blockType) const;
 
+		/** Copies loaded level data needed for drawing */
+		void buildGeometry();
+
 
 		// helpers
 
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <vector>
+#include <ClanLib/core.h>
+
+#include "common/GroundBlockType.h"
+#include "Sandpit.h"
+
+namespace Race {
+
+/**
+ * Immutable copy of level data needed for drawing. The level builds a new
+ * one on every load and race snapshots share it, so graphics never read
+ * the level that the logic thread may reload at any time.
+ */
+struct LevelGeometry {
+
+		LevelGeometry() :
+			m_width(0),
+			m_height(0)
+		{}
+
+		Common::GroundBlockType getBlockType(int p_x, int p_y) const { return m_blocks[p_y * m_width + p_x]; }
+
+
+		/** Level size in blocks */
+		int m_width, m_height;
+
+		/** Block types, row after row */
+		std::vector<Common::GroundBlockType> m_blocks;
+
+		/** Bound segments */
+		std::vector<CL_LineSegment2f> m_bounds;
+
+		std::vector<Sandpit> m_sandpits;
+
+		/** Checkpoint positions in track order */
+		std::vector<CL_Pointf> m_checkpoints;
+};
+
+} // namespace
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "LogicThread.h"
+
+#include <assert.h>
+
+#include "common.h"
+#include "common/Game.h"
+#include "common/Player.h"
+#include "debug/DebugProperties.h"
+#include "debug/Profiler.h"
+#include "logic/race/OfflineRaceLogic.h"
+#include "logic/race/OnlineRaceLogic.h"
+#include "logic/race/Replay.h"
+
+namespace Race {
+
+/** Level used by offline race */
+const CL_String OFFLINE_LEVEL = "resources/level.xml";
+
+/** Directory for recorded replays */
+const CL_String REPLAY_DIR = "replays";
+
+LogicThread::LogicThread(const CL_String &p_hostname, int p_port) :
+	m_hostname(p_hostname),
+	m_port(p_port),
+	m_logic(NULL),
+	m_running(false),
+	m_timeScale(100),
+	m_readyEvent(false, false),
+	m_stopEvent(true, false)
+{
+}
+
+LogicThread::~LogicThread()
+{
+	if (m_running) {
+		stop();
+	}
+}
+
+void LogicThread::start()
+{
+	assert(!m_running);
+
+	m_stopEvent.reset();
+	m_thread.start(this, &LogicThread::run);
+
+	m_readyEvent.wait();
+	m_running = true;
+}
+
+void LogicThread::stop()
+{
+	assert(m_running);
+
+	m_stopEvent.set();
+	m_thread.join();
+
+	m_running = false;
+}
+
+void LogicThread::run()
+{
+	// logic is created here, so its network client delivers events
+	// to this thread
+	if (m_hostname == "") {
+		m_logic = new Race::OfflineRaceLogic(OFFLINE_LEVEL);
+	} else {
+		m_logic = new Race::OnlineRaceLogic(m_hostname, m_port);
+	}
+
+	m_logic->initialize();
+
+	Replay *replay = NULL;
+
+	if (m_hostname == "" && Dbg::RECORD_REPLAY.get()) {
+		const Car &car = Game::getInstance().getPlayer().getCar();
+
+		replay = new Replay(OFFLINE_LEVEL, 1);
+		replay->setStart(0, car.getPosition(), car.getRotation());
+
+		m_logic->setRecording(replay);
+	}
+
+	m_readyEvent.set();
+
+	unsigned lastTime = CL_System::get_time();
+
+	// time to process is kept in percents of ms to apply time scale
+	const unsigned tickScaled = TICK * 100;
+	unsigned timeToProcess = 0;
+
+	while (!m_stopEvent.wait(0)) {
+
+		const unsigned timeScale = m_timeScale;
+
+		try {
+			CL_KeepAlive::process(0);
+
+			const unsigned now = CL_System::get_time();
+			timeToProcess += (now - lastTime) * timeScale;
+			lastTime = now;
+
+			if (timeToProcess > MAX_CATCH_UP_TICKS * tickScaled) {
+				timeToProcess = MAX_CATCH_UP_TICKS * tickScaled;
+			}
+
+			while (timeToProcess >= tickScaled) {
+				m_logic->update(TICK);
+				timeToProcess -= tickScaled;
+			}
+
+		} catch (CL_Exception e) {
+			cl_log_event(LOG_ERROR, "Logic thread: %1", e.message);
+		}
+
+		// sleep until next tick or stop request
+		m_stopEvent.wait(timeScale > 0 ? (tickScaled - timeToProcess) / timeScale : TICK);
+	}
+
+	if (replay != NULL) {
+		m_logic->setRecording(NULL);
+
+		try {
+			CL_Directory::create(REPLAY_DIR);
+			replay->save(cl_format("%1/replay_%2.rpl", REPLAY_DIR, CL_System::get_time()));
+		} catch (CL_Exception e) {
+			cl_log_event(LOG_ERROR, "Cannot save replay: %1", e.message);
+		}
+
+		delete replay;
+	}
+
+	delete m_logic;
+	m_logic = NULL;
+
+	// let next race thread profile in our place
+	Dbg::Profiler::releaseThread();
+}
+
+} // namespace
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <ClanLib/core.h>
+
+#include "boost/utility.hpp"
+
+namespace Race {
+
+class RaceLogic;
+
+/**
+ * Runs race logic and its network client in own thread at fixed tick.
+ * Results are visible to other threads only through logic snapshots.
+ */
+class LogicThread : public boost::noncopyable {
+
+	public:
+
+		/** Logic tick in miliseconds */
+		static const unsigned TICK = 1000 / 60;
+
+
+		/**
+		 * @param p_hostname Server to play on. Empty means offline race.
+		 * @param p_port Server port.
+		 */
+		LogicThread(const CL_String &p_hostname, int p_port);
+
+		virtual ~LogicThread();
+
+
+		/** Starts the thread and waits until logic is initialized */
+		void start();
+
+		/** Stops the thread and destroys the logic */
+		void stop();
+
+
+		bool isRunning() const { return m_running; }
+
+		/** Sets logic speed in percents of real time. Can be called from any thread. */
+		void setTimeScale(unsigned p_percent) { m_timeScale = p_percent; }
+
+		RaceLogic &getLogic() { return *m_logic; }
+
+	private:
+
+		/** Maximum ticks done at once when thread was stalled */
+		static const unsigned MAX_CATCH_UP_TICKS = 10;
+
+		/** Server hostname */
+		CL_String m_hostname;
+
+		/** Server port */
+		int m_port;
+
+		/** Logic created by the thread */
+		RaceLogic *m_logic;
+
+		/** Running state */
+		bool m_running;
+
+		/** Logic speed in percents */
+		volatile unsigned m_timeScale;
+
+		/** The thread */
+		CL_Thread m_thread;
+
+		/** Set when logic is ready */
+		CL_Event m_readyEvent;
+
+		/** Set to request stop */
+		CL_Event m_stopEvent;
+
+
+		void run();
+};
+
+} // namespace
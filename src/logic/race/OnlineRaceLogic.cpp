@@ -29,30 +29,51 @@
 #include "OnlineRaceLogic.h"
 
 #include <assert.h>
+#include <algorithm>
+#include <math.h>
+#include <stdlib.h>
 
 #include "Car.h"
 #include "common/Game.h"
+#include "common/Properties.h"
 #include "network/packets/GameState.h"
+#include "network/packets/CarInput.h"
 #include "network/packets/CarState.h"
+#include "network/packets/PlayerJoined.h"
+#include "network/packets/Snapshot.h"
 
 namespace Race {
 
+/** Remote cars are shown that much behind the server, in ms */
+const IntProperty INTERPOLATION_DELAY("net_interpolationDelay", 100);
+
+/** Remote time that far from target is set, not slewed, in ms */
+const int MAX_CLOCK_ERROR = 250;
+
+/** Part of remote time error corrected per snapshot is its inverse */
+const int CLOCK_SLEW = 8;
+
+/** View extent change in pixels worth telling the server */
+const float MIN_VIEW_CHANGE = 1.0f;
+
 OnlineRaceLogic::OnlineRaceLogic(const CL_String &p_host, int p_port) :
 	m_initialized(false),
 	m_host(p_host),
-	m_port(p_port)
+	m_port(p_port),
+	m_players(Net::MAX_PLAYERS, (Player*) NULL),
+	m_stateBuffers(Net::MAX_PLAYERS),
+	m_tickRate(1),
+	m_interpolationDelay(std::max(INTERPOLATION_DELAY.get(), 0)),
+	m_remoteTime(0),
+	m_remoteTimeSet(false)
 {
 	assert(p_port > 0 && p_port <= 0xFFFF);
 
 	m_client.setServerAddr(m_host);
 	m_client.setServerPort(m_port);
 
-	// connect signal and slots from player's car
 	Game &game = Game::getInstance();
 	m_localPlayer = &game.getPlayer();
-	Car &car = m_localPlayer->getCar();
-
-	m_slots.connect(car.sig_inputChanged(), this, &OnlineRaceLogic::onInputChange);
 
 	// connect signals and slots from client
 	m_slots.connect(m_client.sig_connected(), this, &OnlineRaceLogic::onConnected);
@@ -60,20 +81,15 @@ OnlineRaceLogic::OnlineRaceLogic(const CL_String &p_host, int p_port) :
 	m_slots.connect(m_client.sig_playerJoined(), this, &OnlineRaceLogic::onPlayerJoined);
 	m_slots.connect(m_client.sig_playerLeaved(), this, &OnlineRaceLogic::onPlayerLeaved);
 	m_slots.connect(m_client.sig_gameStateReceived(), this, &OnlineRaceLogic::onGameState);
-	m_slots.connect(m_client.sig_carStateReceived(), this, &OnlineRaceLogic::onCarState);
+	m_slots.connect(m_client.sig_snapshotReceived(), this, &OnlineRaceLogic::onSnapshot);
 }
 
 OnlineRaceLogic::~OnlineRaceLogic()
 {
-	TPlayerMapPair pair;
-	foreach (pair, m_playerMap) {
-		Player *player = pair.second;
-
-		// remove car from level
-		m_level.removeCar(&player->getCar());
-
-		// remove player
-		delete player;
+	for (Net::TPlayerId id = 0; id < Net::MAX_PLAYERS; ++id) {
+		if (m_players[id] != NULL) {
+			removePlayer(id);
+		}
 	}
 }
 
@@ -96,6 +112,69 @@ void OnlineRaceLogic::destroy()
 	}
 }
 
+void OnlineRaceLogic::update(unsigned p_timeElapsed)
+{
+	// may rewind local car
+	m_client.update();
+
+	updateRemoteCars(p_timeElapsed);
+
+	m_prediction.update();
+	RaceLogic::update(p_timeElapsed);
+
+	// local car is simulated once it is on the level
+	if (m_level.isLoaded()) {
+		m_prediction.record(m_controls, m_localPlayer->getCar());
+
+		Net::CarInput input;
+		m_prediction.prepareInput(input);
+
+		if (input.getInputCount() > 0) {
+			m_client.sendCarInput(input);
+		}
+
+		updateViewExtent();
+	}
+}
+
+void OnlineRaceLogic::updateViewExtent()
+{
+	CL_Sizef extent;
+
+	{
+		CL_MutexSection lock(&m_inputMutex);
+		extent = m_viewExtent;
+	}
+
+	if (
+			fabs(extent.width - m_sentViewExtent.width) >= MIN_VIEW_CHANGE ||
+			fabs(extent.height - m_sentViewExtent.height) >= MIN_VIEW_CHANGE
+	) {
+		m_client.sendViewExtent(extent);
+		m_sentViewExtent = extent;
+	}
+}
+
+void OnlineRaceLogic::filterInput(Input &p_input)
+{
+	p_input.m_turn = Net::CarInput::roundTurn(p_input.m_turn);
+
+	m_controls.m_acceleration = p_input.m_acceleration;
+	m_controls.m_brake = p_input.m_brake;
+	m_controls.m_handbrake = p_input.m_handbrake;
+	m_controls.m_turn = p_input.m_turn;
+}
+
+void OnlineRaceLogic::filterSnapshot(RaceSnapshot &p_snapshot)
+{
+	if (p_snapshot.m_localCar >= 0) {
+		RaceSnapshot::CarState &state = p_snapshot.m_cars[p_snapshot.m_localCar];
+
+		state.m_position += m_prediction.getPositionOffset();
+		state.m_rotationRad += m_prediction.getRotationOffset();
+	}
+}
+
 void OnlineRaceLogic::onConnected()
 {
 }
@@ -104,39 +183,60 @@ void OnlineRaceLogic::onDisconnected()
 {
 }
 
-void OnlineRaceLogic::onPlayerJoined(const CL_String &p_name)
+void OnlineRaceLogic::addPlayer(Net::TPlayerId p_id, Player *p_player)
 {
-	// check player existence
-	TPlayerMap::iterator itor = m_playerMap.find(p_name);
+	assert(p_id < Net::MAX_PLAYERS && m_players[p_id] == NULL);
 
-	if (itor == m_playerMap.end()) {
-		// create new player
-		Player *player = new Player(p_name);
-		m_playerMap[p_name] = player;
+	m_players[p_id] = p_player;
+	m_playerMap[p_player->getName()] = p_player;
 
-		// add his car to level
-		m_level.addCar(&player->getCar());
-	} else {
-		cl_log_event(LOG_ERROR, "Player named '%1' already in list", p_name);
+	// remote cars do not simulate, they are placed from received states
+	if (p_player != m_localPlayer) {
+		p_player->getCar().setLocked(true);
 	}
 
+	m_level.addCar(&p_player->getCar());
 }
 
-void OnlineRaceLogic::onPlayerLeaved(const CL_String &p_name)
+void OnlineRaceLogic::removePlayer(Net::TPlayerId p_id)
 {
-	// get the player
-	TPlayerMap::iterator itor = m_playerMap.find(p_name);
+	assert(p_id < Net::MAX_PLAYERS && m_players[p_id] != NULL);
+
+	Player *player = m_players[p_id];
+
+	// remove car from level
+	m_level.removeCar(&player->getCar());
 
-	if (itor != m_playerMap.end()) {
-		Player *player = itor->second;
+	m_players[p_id] = NULL;
+	m_playerMap.erase(player->getName());
 
-		// remove car from level
-		m_level.removeCar(&player->getCar());
+	m_stateBuffers[p_id].clear();
 
-		// remove player
+	// local player is owned by the game
+	if (player != m_localPlayer) {
 		delete player;
+	}
+}
+
+void OnlineRaceLogic::onPlayerJoined(const Net::PlayerJoined &p_playerJoined)
+{
+	const Net::TPlayerId id = p_playerJoined.getPlayerId();
+
+	// check player existence
+	if (m_players[id] == NULL) {
+		addPlayer(id, new Player(p_playerJoined.getName()));
+	} else {
+		cl_log_event(LOG_ERROR, "Player of id %1 already in list", id);
+	}
+
+}
+
+void OnlineRaceLogic::onPlayerLeaved(Net::TPlayerId p_id)
+{
+	if (p_id < Net::MAX_PLAYERS && m_players[p_id] != NULL) {
+		removePlayer(p_id);
 	} else {
-		cl_log_event(LOG_ERROR, "No player named '%1' in list", p_name);
+		cl_log_event(LOG_ERROR, "No player of id %1 in list", p_id);
 	}
 }
 
@@ -146,51 +246,103 @@ void OnlineRaceLogic::onGameState(const Net::GameState &p_gameState)
 	const CL_String &levelName = p_gameState.getLevel();
 	m_level.initialize(levelName);
 
+	// server simulates our inputs from now
+	m_prediction.clear();
+
+	m_tickRate = p_gameState.getTickRate();
+	m_remoteTimeSet = false;
+
+	// new session, server does not know the view yet
+	m_sentViewExtent = CL_Sizef();
+
 	// add rest of players
 	const unsigned playerCount = p_gameState.getPlayerCount();
 
 	Player *player;
-	Car *car;
 
 	for (unsigned i = 0; i < playerCount; ++i) {
-		const CL_String &playerName = p_gameState.getPlayerName(i);
+		const Net::TPlayerId id = p_gameState.getPlayerId(i);
 
-		if (playerName == m_localPlayer->getName()) {
+		if (m_players[id] != NULL) {
+			cl_log_event(LOG_ERROR, "Player of id %1 already in list", id);
+			continue;
+		}
+
+		if (id == p_gameState.getLocalPlayerId()) {
 			// this is local player, so it exists now
 			player = m_localPlayer;
 		} else {
 			// this is remote player
-			player = new Player(playerName);
+			player = new Player(p_gameState.getPlayerName(i));
 		}
 
-		// put player to player list
-		m_playerMap[playerName] = player;
-
 		// prepare car and put it to level
-		car = &player->getCar();
-		car->applyCarState(p_gameState.getCarState(i));
+		player->getCar().applyCarState(p_gameState.getCarState(i));
 
-		m_level.addCar(car);
+		addPlayer(id, player);
 	}
 
 }
 
-void OnlineRaceLogic::onCarState(const Net::CarState &p_carState)
+void OnlineRaceLogic::pushCarState(unsigned p_time, const Net::CarState &p_carState)
 {
-	const CL_String &playerName = p_carState.getName();
-	TPlayerMap::iterator itor = m_playerMap.find(playerName);
+	const Net::TPlayerId id = p_carState.getPlayerId();
 
-	if (itor != m_playerMap.end()) {
-		itor->second->getCar().applyCarState(p_carState);
+	if (m_players[id] != NULL) {
+		m_stateBuffers[id].push(p_time, p_carState);
 	} else {
-		cl_log_event(LOG_ERROR, "Player %1 do not exists", playerName);
+		cl_log_event(LOG_ERROR, "Player of id %1 do not exists", id);
 	}
 }
 
-void OnlineRaceLogic::onInputChange(const Car &p_car)
+void OnlineRaceLogic::syncRemoteTime(unsigned p_serverTime)
 {
-	const Net::CarState carState = p_car.prepareCarState();
-	m_client.sendCarState(carState);
+	const unsigned target = p_serverTime - m_interpolationDelay;
+	const int error = (int) (target - m_remoteTime);
+
+	// slewed slowly so jitter does not shake the cars
+	if (!m_remoteTimeSet || abs(error) > MAX_CLOCK_ERROR) {
+		m_remoteTime = target;
+		m_remoteTimeSet = true;
+	} else {
+		m_remoteTime += error / CLOCK_SLEW;
+	}
+}
+
+void OnlineRaceLogic::updateRemoteCars(unsigned p_timeElapsed)
+{
+	m_remoteTime += p_timeElapsed;
+
+	Net::CarState state;
+
+	for (Net::TPlayerId id = 0; id < Net::MAX_PLAYERS; ++id) {
+		Player *player = m_players[id];
+
+		if (player != NULL && player != m_localPlayer && m_stateBuffers[id].sample(m_remoteTime, state)) {
+			player->getCar().applyCarState(state);
+		}
+	}
+}
+
+void OnlineRaceLogic::onSnapshot(const Net::Snapshot &p_snapshot)
+{
+	const unsigned tick = p_snapshot.getTick();
+	const unsigned serverTime = tick / m_tickRate * 1000 + tick % m_tickRate * 1000 / m_tickRate;
+
+	syncRemoteTime(serverTime);
+
+	const size_t count = p_snapshot.getCarStateCount();
+
+	for (size_t i = 0; i < count; ++i) {
+		const Net::CarState &carState = p_snapshot.getCarState(i);
+
+		// local car runs ahead of server, only mispredictions are taken
+		if (m_players[carState.getPlayerId()] == m_localPlayer) {
+			m_prediction.reconcile(m_level, m_localPlayer->getCar(), p_snapshot.getInputAck(), carState);
+		} else {
+			pushCarState(serverTime, carState);
+		}
+	}
 }
 
 } // namespace
@@ -28,15 +28,19 @@
 
 #pragma once
 
-#include <map>
+#include <vector>
 #include <ClanLib/core.h>
 
 #include "RaceLogic.h"
+#include "logic/race/Prediction.h"
+#include "logic/race/StateBuffer.h"
 #include "network/client/Client.h"
 
 namespace Net {
 	class CarState;
 	class GameState;
+	class PlayerJoined;
+	class Snapshot;
 }
 
 namespace Race {
@@ -56,6 +60,8 @@ class OnlineRaceLogic: public Race::RaceLogic {
 
 		virtual void destroy();
 
+		virtual void update(unsigned p_timeElapsed);
+
 	private:
 
 		/** Initialized state */
@@ -76,6 +82,61 @@ class OnlineRaceLogic: public Race::RaceLogic {
 		/** Local player */
 		Player *m_localPlayer;
 
+		/** Players indexed by server assigned id, NULL for free ids */
+		typedef std::vector<Player*> TPlayerTable;
+
+		TPlayerTable m_players;
+
+		/** Local car prediction against server simulation */
+		Prediction m_prediction;
+
+		/** Controls applied at last update */
+		Net::CarInput::Controls m_controls;
+
+		/** Received states of remote cars, indexed by player id */
+		std::vector<StateBuffer> m_stateBuffers;
+
+		/** Server snapshots per second */
+		unsigned m_tickRate;
+
+		/** How far behind the server remote cars are shown in ms */
+		unsigned m_interpolationDelay;
+
+		/** Server time remote cars are shown at in ms */
+		unsigned m_remoteTime;
+
+		/** Remote time was set by a snapshot */
+		bool m_remoteTimeSet;
+
+		/** View extent server knows about */
+		CL_Sizef m_sentViewExtent;
+
+
+		/** Puts player to id table and name map, adds his car to level */
+		void addPlayer(Net::TPlayerId p_id, Player *p_player);
+
+		/** Removes player and his car, deletes remote players */
+		void removePlayer(Net::TPlayerId p_id);
+
+		/** Moves remote cars to their states at remote time */
+		void updateRemoteCars(unsigned p_timeElapsed);
+
+		/** Keeps remote time the interpolation delay behind server time */
+		void syncRemoteTime(unsigned p_serverTime);
+
+		/** Sends view extent when it changed */
+		void updateViewExtent();
+
+		/** Buffers state of remote car for given server time */
+		void pushCarState(unsigned p_time, const Net::CarState &p_carState);
+
+
+		/** Rounds turn the way server does and remembers the controls */
+		virtual void filterInput(Input &p_input);
+
+		/** Adds visual offset of the local car correction */
+		virtual void filterSnapshot(RaceSnapshot &p_snapshot);
+
 
 		// signal handlers
 
@@ -83,15 +144,13 @@ class OnlineRaceLogic: public Race::RaceLogic {
 
 		void onDisconnected();
 
-		void onPlayerJoined(const CL_String &p_name);
+		void onPlayerJoined(const Net::PlayerJoined &p_playerJoined);
 
-		void onPlayerLeaved(const CL_String &p_name);
+		void onPlayerLeaved(Net::TPlayerId p_id);
 
 		void onGameState(const Net::GameState &p_gameState);
 
-		void onCarState(const Net::CarState &p_carState);
-
-		void onInputChange(const Car &p_car);
+		void onSnapshot(const Net::Snapshot &p_snapshot);
 
 };
 
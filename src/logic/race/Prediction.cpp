@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Prediction.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <math.h>
+
+#include "debug/Metrics.h"
+#include "logic/race/Car.h"
+#include "logic/race/Level.h"
+
+namespace Race {
+
+/** Quantization steps a field may be off by, server rounds differently */
+const unsigned TOLERANCE = 2;
+
+/** Part of visual offset left after each tick */
+const float OFFSET_DECAY = 0.8f;
+
+/** Offsets below these are dropped */
+const float MIN_POSITION_OFFSET = 0.05f;
+
+const float MIN_ROTATION_OFFSET = 0.001f;
+
+/** Corrections longer than that are not smoothed, car just jumps */
+const float MAX_SMOOTHED_DISTANCE = 64.0f;
+
+const float PI = 3.14159265f;
+
+const unsigned Prediction::HISTORY;
+
+const Dbg::Counter MISPREDICTIONS_METRIC("mispredictions");
+
+namespace {
+
+	/** @return True if states differ by rounding only */
+	bool matches(const Net::CarState &p_predicted, const Net::CarState &p_actual)
+	{
+		Net::CarState::Quantized predicted, actual;
+
+		p_predicted.quantize(predicted);
+		p_actual.quantize(actual);
+
+		for (unsigned i = Net::CarState::F_PLAYER_ID + 1; i < Net::CarState::FIELD_COUNT; ++i) {
+			const unsigned mask = (1u << Net::CarState::getFieldBits((Net::CarState::Field) i)) - 1;
+
+			// rotation wraps
+			const unsigned up = (predicted.m_codes[i] - actual.m_codes[i]) & mask;
+			const unsigned down = (actual.m_codes[i] - predicted.m_codes[i]) & mask;
+
+			if (std::min(up, down) > TOLERANCE) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	/** @return Angle wrapped to [-PI, PI] */
+	float wrapAngle(float p_angle)
+	{
+		return p_angle - 2.0f * PI * floor((p_angle + PI) / (2.0f * PI));
+	}
+
+	void applyControls(Car &p_car, const Net::CarInput::Controls &p_controls)
+	{
+		p_car.setAcceleration(p_controls.m_acceleration);
+		p_car.setBrake(p_controls.m_brake);
+		p_car.setHandbrake(p_controls.m_handbrake);
+		p_car.setTurn(p_controls.m_turn);
+	}
+
+} // namespace
+
+Prediction::Prediction() :
+	m_entries(HISTORY),
+	m_sequence(0),
+	m_ackedSequence(0),
+	m_rotationOffset(0.0f)
+{
+}
+
+void Prediction::clear()
+{
+	m_entries.assign(HISTORY, Entry());
+	m_sequence = 0;
+	m_ackedSequence = 0;
+	m_positionOffset = CL_Vec2f();
+	m_rotationOffset = 0.0f;
+}
+
+unsigned Prediction::record(const Net::CarInput::Controls &p_controls, const Car &p_car)
+{
+	++m_sequence;
+
+	Entry &entry = m_entries[m_sequence % HISTORY];
+
+	entry.m_sequence = m_sequence;
+	entry.m_controls = p_controls;
+	entry.m_state = p_car.prepareCarState();
+
+	return m_sequence;
+}
+
+void Prediction::reconcile(const Level &p_level, Car &p_car, unsigned p_sequence, const Net::CarState &p_state)
+{
+	// nothing simulated yet, old snapshot or input forgotten already
+	if (
+			p_sequence == 0 ||
+			(int) (p_sequence - m_ackedSequence) <= 0 ||
+			(int) (m_sequence - p_sequence) < 0 ||
+			m_sequence - p_sequence >= HISTORY
+	) {
+		return;
+	}
+
+	m_ackedSequence = p_sequence;
+
+	const Entry &acked = m_entries[p_sequence % HISTORY];
+	assert(acked.m_sequence == p_sequence);
+
+	if (matches(acked.m_state, p_state)) {
+		return;
+	}
+
+	MISPREDICTIONS_METRIC.increment();
+
+	const CL_Vec2f drawnPosition = p_car.getPosition() + m_positionOffset;
+	const float drawnRotation = p_car.getRotationRad() + m_rotationOffset;
+
+	// rewind and replay inputs server did not simulate yet, bounds are
+	// checked after every step as level update does
+	p_car.applyCarState(p_state);
+	p_level.checkBoundCollisions(p_car);
+
+	m_entries[p_sequence % HISTORY].m_state = p_car.prepareCarState();
+
+	for (unsigned sequence = p_sequence + 1; sequence != m_sequence + 1; ++sequence) {
+		Entry &entry = m_entries[sequence % HISTORY];
+
+		applyControls(p_car, entry.m_controls);
+		p_car.update1_60();
+		p_level.checkBoundCollisions(p_car);
+
+		entry.m_state = p_car.prepareCarState();
+	}
+
+	// car is drawn where it was and slides to the corrected place
+	const CL_Vec2f offset = drawnPosition - p_car.getPosition();
+
+	if (offset.length() <= MAX_SMOOTHED_DISTANCE) {
+		m_positionOffset = offset;
+		m_rotationOffset = wrapAngle(drawnRotation - p_car.getRotationRad());
+	} else {
+		m_positionOffset = CL_Vec2f();
+		m_rotationOffset = 0.0f;
+	}
+}
+
+void Prediction::update()
+{
+	m_positionOffset *= OFFSET_DECAY;
+	m_rotationOffset *= OFFSET_DECAY;
+
+	if (m_positionOffset.length() < MIN_POSITION_OFFSET) {
+		m_positionOffset = CL_Vec2f();
+	}
+
+	if (fabs(m_rotationOffset) < MIN_ROTATION_OFFSET) {
+		m_rotationOffset = 0.0f;
+	}
+}
+
+void Prediction::prepareInput(Net::CarInput &p_input) const
+{
+	const unsigned pending = m_sequence - m_ackedSequence;
+	const unsigned count = std::min(pending, Net::CarInput::MAX_INPUTS);
+
+	p_input.setFirstSequence(m_sequence - count + 1);
+
+	for (unsigned sequence = m_sequence - count + 1; sequence != m_sequence + 1; ++sequence) {
+		p_input.addControls(m_entries[sequence % HISTORY].m_controls);
+	}
+}
+
+} // namespace
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <vector>
+#include <ClanLib/core.h>
+
+#include "network/packets/CarInput.h"
+#include "network/packets/CarState.h"
+
+namespace Race {
+
+class Car;
+class Level;
+
+/**
+ * Client side prediction of the local car. Input of every logic tick is
+ * recorded with the state it led to under increasing sequence number.
+ * When server state after an acknowledged input differs from the one
+ * predicted, car is rewound to it and inputs not acknowledged yet are
+ * simulated again. The jump is hidden by visual offset decaying over the
+ * next ticks.
+ */
+class Prediction {
+
+	public:
+
+		/** Ticks remembered, has to cover round trip time */
+		static const unsigned HISTORY = 64;
+
+		Prediction();
+
+		/** Forgets all inputs, sequence numbers start over */
+		void clear();
+
+		/**
+		 * Records input of the tick just simulated and car state after it.
+		 * @return Sequence number of the input
+		 */
+		unsigned record(const Net::CarInput::Controls &p_controls, const Car &p_car);
+
+		/**
+		 * Takes server state of car after input of given sequence. On
+		 * misprediction car is rewound to it and replayed on its level.
+		 */
+		void reconcile(const Level &p_level, Car &p_car, unsigned p_sequence, const Net::CarState &p_state);
+
+		/** Decays the visual offset, call once per tick */
+		void update();
+
+		/** Fills packet with the newest inputs not acknowledged yet */
+		void prepareInput(Net::CarInput &p_input) const;
+
+
+		/** @return Offset of drawn position from simulated one */
+		const CL_Vec2f &getPositionOffset() const { return m_positionOffset; }
+
+		/** @return Offset of drawn rotation in radians */
+		float getRotationOffset() const { return m_rotationOffset; }
+
+	private:
+
+		struct Entry {
+
+				unsigned m_sequence;
+
+				Net::CarInput::Controls m_controls;
+
+				/** Car state after the input */
+				Net::CarState m_state;
+
+				Entry() :
+					m_sequence(0)
+				{}
+		};
+
+		/** Entries indexed by sequence modulo HISTORY */
+		std::vector<Entry> m_entries;
+
+		/** Sequence of the newest input, zero when none */
+		unsigned m_sequence;
+
+		/** Sequence of the newest input server simulated */
+		unsigned m_ackedSequence;
+
+		CL_Vec2f m_positionOffset;
+
+		float m_rotationOffset;
+};
+
+} // namespace
@@ -28,14 +28,21 @@
 
 #include "RaceLogic.h"
 
+#include <assert.h>
+
 #include "common/Game.h"
 #include "common/Player.h"
+#include "debug/MemoryTracker.h"
+#include "debug/Profiler.h"
+#include "logic/race/Replay.h"
+#include "logic/race/StateHash.h"
 
 namespace Race {
 
-RaceLogic::RaceLogic()
+RaceLogic::RaceLogic() :
+	m_recording(NULL),
+	m_stateHash(0)
 {
-
 }
 
 RaceLogic::~RaceLogic()
@@ -44,12 +51,110 @@ RaceLogic::~RaceLogic()
 
 void RaceLogic::update(unsigned p_timeElapsed)
 {
+	PROFILE_ZONE(Dbg::Z_LOGIC_UPDATE);
+
+	applyInput();
 	updateCarPhysics(p_timeElapsed);
 	updateLevel(p_timeElapsed);
+
+	m_stateHash = StateHash::calculate(m_level);
+	publishSnapshot();
+}
+
+void RaceLogic::setInput(const Input &p_input)
+{
+	CL_MutexSection lock(&m_inputMutex);
+	m_input = p_input;
+}
+
+void RaceLogic::setViewExtent(const CL_Sizef &p_extent)
+{
+	CL_MutexSection lock(&m_inputMutex);
+	m_viewExtent = p_extent;
+}
+
+void RaceLogic::setRecording(Replay *p_replay)
+{
+	assert((p_replay == NULL || p_replay->getCarCount() == 1) && "only local car can be recorded");
+	m_recording = p_replay;
+}
+
+void RaceLogic::applyInput()
+{
+	Input input;
+
+	{
+		CL_MutexSection lock(&m_inputMutex);
+		input = m_input;
+	}
+
+	filterInput(input);
+
+	if (m_recording != NULL) {
+		m_recording->addTick(&input);
+	}
+
+	Race::Car &car = Game::getInstance().getPlayer().getCar();
+
+	car.setAcceleration(input.m_acceleration);
+	car.setBrake(input.m_brake);
+	car.setHandbrake(input.m_handbrake);
+	car.setTurn(input.m_turn);
+}
+
+void RaceLogic::publishSnapshot()
+{
+	RaceSnapshot &snapshot = m_snapshots.getWriteBuffer();
+
+	snapshot.m_levelLoaded = m_level.isLoaded();
+	snapshot.m_level = m_level.getGeometry();
+	snapshot.m_stateHash = m_stateHash;
+	snapshot.m_localCar = -1;
+
+	// cars
+	const Race::Car *localCar = &Game::getInstance().getPlayer().getCar();
+	const unsigned carCount = m_level.getCarCount();
+
+	snapshot.m_cars.resize(carCount);
+
+	for (unsigned i = 0; i < carCount; ++i) {
+		const Race::Car &car = m_level.getCar(i);
+		RaceSnapshot::CarState &state = snapshot.m_cars[i];
+
+		state.m_car = &car;
+		state.m_position = car.getPosition();
+		state.m_rotationRad = car.getRotationRad();
+		state.m_moveVector = car.getMoveVector();
+		state.m_speed = car.getSpeed();
+		state.m_drifting = car.isDrifting();
+
+		if (&car == localCar) {
+			snapshot.m_localCar = i;
+		}
+	}
+
+	// tyre stripes
+	const TyreStripes::stripeList_t &stripes = m_level.getTyreStripes().getStripeList();
+	snapshot.m_stripes.resize(stripes.size());
+
+	unsigned i = 0;
+
+	foreach (const TyreStripes::Stripe &stripe, stripes) {
+		snapshot.m_stripes[i].m_from = stripe.getFromPoint();
+		snapshot.m_stripes[i].m_to = stripe.getToPoint();
+		++i;
+	}
+
+	filterSnapshot(snapshot);
+
+	m_snapshots.publish();
 }
 
 void RaceLogic::updateCarPhysics(unsigned p_timeElapsed)
 {
+	PROFILE_ZONE(Dbg::Z_CAR_PHYSICS);
+	MEMORY_SCOPE(Dbg::MT_PHYSICS);
+
 	const unsigned carCount = m_level.getCarCount();
 	for (unsigned i = 0; i < carCount; ++i) {
 		Race::Car &car = m_level.getCar(i);
@@ -33,18 +33,43 @@
 #include <ClanLib/core.h>
 
 #include "common.h"
+#include "common/TripleBuffer.h"
 #include "logic/race/Level.h"
+#include "logic/race/RaceSnapshot.h"
 
 class Player;
 
 namespace Race {
 
+class Replay;
+
 class RaceLogic {
 
 	public:
 
 		typedef std::list<Player*> TPlayerList;
 
+		typedef TripleBuffer<RaceSnapshot> TSnapshotBuffer;
+
+		/** Local player controls */
+		struct Input {
+
+				bool m_acceleration;
+
+				bool m_brake;
+
+				bool m_handbrake;
+
+				float m_turn;
+
+				Input() :
+					m_acceleration(false),
+					m_brake(false),
+					m_handbrake(false),
+					m_turn(0.0f)
+				{}
+		};
+
 		RaceLogic();
 
 		virtual ~RaceLogic();
@@ -61,8 +86,35 @@ class RaceLogic {
 
 		const Player &getPlayer(const CL_String& p_name) const;
 
+		/**
+		 * @return Snapshots published after each update. Only one thread
+		 * may read them.
+		 */
+		TSnapshotBuffer &getSnapshots() const { return m_snapshots; }
+
+		/**
+		 * Sets local player controls. Can be called from any thread, input
+		 * is applied at the next update.
+		 */
+		void setInput(const Input &p_input);
+
+		/**
+		 * Sets size of level area shown around local car, server sends
+		 * more updates of cars in it. Can be called from any thread.
+		 */
+		void setViewExtent(const CL_Sizef &p_extent);
+
+		/**
+		 * Records local player input of every update into given single car
+		 * replay. NULL stops recording. Replay is not owned.
+		 */
+		void setRecording(Replay *p_replay);
+
+		/** @return State hash calculated after last update */
+		unsigned getStateHash() const { return m_stateHash; }
 
-		void update(unsigned p_timeElapsed);
+
+		virtual void update(unsigned p_timeElapsed);
 
 	protected:
 
@@ -75,6 +127,24 @@ class RaceLogic {
 
 		TPlayerMap m_playerMap;
 
+		/** Published race state */
+		mutable TSnapshotBuffer m_snapshots;
+
+		/** Input waiting for next update */
+		Input m_input;
+
+		/** Level area shown around local car, guarded by input lock */
+		CL_Sizef m_viewExtent;
+
+		/** Input lock */
+		CL_Mutex m_inputMutex;
+
+		/** Replay being recorded or NULL */
+		Replay *m_recording;
+
+		/** Hash of state after last update */
+		unsigned m_stateHash;
+
 
 		// update routines
 
@@ -82,6 +152,16 @@ class RaceLogic {
 
 		void updateLevel(unsigned p_timeElapsed);
 
+		void applyInput();
+
+		void publishSnapshot();
+
+		/** Lets subclass alter local input before it is recorded and applied */
+		virtual void filterInput(Input &p_input) {}
+
+		/** Lets subclass alter race state before it is published */
+		virtual void filterSnapshot(RaceSnapshot &p_snapshot) {}
+
 };
 
 } // namespace
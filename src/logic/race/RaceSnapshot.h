@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <ClanLib/core.h>
+
+#include "LevelGeometry.h"
+
+namespace Race {
+
+class Car;
+
+/**
+ * Immutable copy of race state that changes every tick. It is published
+ * by the logic and read by the graphics, so drawing never touches objects
+ * that logic is updating.
+ */
+struct RaceSnapshot {
+
+		struct CarState {
+
+				/** Logic car (identity only, must not be dereferenced) */
+				const Race::Car *m_car;
+
+				CL_Pointf m_position;
+
+				float m_rotationRad;
+
+				CL_Vec2f m_moveVector;
+
+				float m_speed;
+
+				/** Drifting cars emit smoke */
+				bool m_drifting;
+		};
+
+		struct Stripe {
+
+				CL_Pointf m_from, m_to;
+		};
+
+		RaceSnapshot() :
+			m_levelLoaded(false),
+			m_localCar(-1),
+			m_stateHash(0)
+		{}
+
+
+		/** Level load state */
+		bool m_levelLoaded;
+
+		/** Drawing data of loaded level, shared by snapshots of one load */
+		boost::shared_ptr<const LevelGeometry> m_level;
+
+		/** Index of local player car or -1 */
+		int m_localCar;
+
+		/** Race state hash of this tick */
+		unsigned m_stateHash;
+
+		/** All cars on level */
+		std::vector<CarState> m_cars;
+
+		/** All tyre stripes */
+		std::vector<Stripe> m_stripes;
+};
+
+} // namespace
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Replay.h"
+
+#include <assert.h>
+
+#include "common.h"
+
+namespace Race {
+
+/** Replay file magic, "RPL1" */
+const unsigned REPLAY_MAGIC = 0x52504c31;
+
+/** Input flags */
+const unsigned char FLAG_ACCELERATION = 1;
+const unsigned char FLAG_BRAKE = 2;
+const unsigned char FLAG_HANDBRAKE = 4;
+
+Replay::Replay()
+{
+}
+
+Replay::Replay(const CL_String &p_levelName, unsigned p_carCount) :
+	m_levelName(p_levelName),
+	m_starts(p_carCount)
+{
+}
+
+Replay::~Replay()
+{
+}
+
+void Replay::setStart(unsigned p_car, const CL_Pointf &p_position, float p_rotation)
+{
+	assert(p_car < m_starts.size() && "car out of range");
+
+	m_starts[p_car].m_position = p_position;
+	m_starts[p_car].m_rotation = p_rotation;
+}
+
+void Replay::addTick(const RaceLogic::Input *p_inputs)
+{
+	m_inputs.insert(m_inputs.end(), p_inputs, p_inputs + getCarCount());
+}
+
+void Replay::save(const CL_String &p_filename) const
+{
+	CL_File file(p_filename, CL_File::create_always, CL_File::access_write);
+
+	file.write_uint32(REPLAY_MAGIC);
+	file.write_string_a(m_levelName);
+	file.write_uint32(getCarCount());
+	file.write_uint32(getTickCount());
+
+	foreach (const CarStart &start, m_starts) {
+		file.write_float(start.m_position.x);
+		file.write_float(start.m_position.y);
+		file.write_float(start.m_rotation);
+	}
+
+	foreach (const RaceLogic::Input &input, m_inputs) {
+		unsigned char flags = 0;
+
+		flags |= input.m_acceleration ? FLAG_ACCELERATION : 0;
+		flags |= input.m_brake ? FLAG_BRAKE : 0;
+		flags |= input.m_handbrake ? FLAG_HANDBRAKE : 0;
+
+		file.write_uint8(flags);
+		file.write_float(input.m_turn);
+	}
+}
+
+void Replay::load(const CL_String &p_filename)
+{
+	CL_File file(p_filename, CL_File::open_existing, CL_File::access_read);
+
+	if (file.read_uint32() != REPLAY_MAGIC) {
+		throw CL_Exception(cl_format("%1 is not a replay file", p_filename));
+	}
+
+	m_levelName = file.read_string_a();
+
+	const unsigned carCount = file.read_uint32();
+	const unsigned tickCount = file.read_uint32();
+
+	m_starts.resize(carCount);
+	m_inputs.resize(carCount * tickCount);
+
+	foreach (CarStart &start, m_starts) {
+		start.m_position.x = file.read_float();
+		start.m_position.y = file.read_float();
+		start.m_rotation = file.read_float();
+	}
+
+	foreach (RaceLogic::Input &input, m_inputs) {
+		const unsigned char flags = file.read_uint8();
+
+		input.m_acceleration = (flags & FLAG_ACCELERATION) != 0;
+		input.m_brake = (flags & FLAG_BRAKE) != 0;
+		input.m_handbrake = (flags & FLAG_HANDBRAKE) != 0;
+		input.m_turn = file.read_float();
+	}
+}
+
+} // namespace
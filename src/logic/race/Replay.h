@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <vector>
+#include <ClanLib/core.h>
+
+#include "logic/race/RaceLogic.h"
+
+namespace Race {
+
+/**
+ * Recorded race input stream. Holds level name, start pose of every car
+ * and inputs of all cars for every logic tick.
+ */
+class Replay {
+
+	public:
+
+		/** Car pose at the first tick */
+		struct CarStart {
+
+				CL_Pointf m_position;
+
+				/** Rotation in degrees */
+				float m_rotation;
+
+				CarStart() : m_rotation(0.0f) {}
+		};
+
+
+		Replay();
+
+		Replay(const CL_String &p_levelName, unsigned p_carCount);
+
+		virtual ~Replay();
+
+
+		const CL_String &getLevelName() const { return m_levelName; }
+
+		unsigned getCarCount() const { return m_starts.size(); }
+
+		unsigned getTickCount() const { return getCarCount() == 0 ? 0 : m_inputs.size() / getCarCount(); }
+
+		const CarStart &getStart(unsigned p_car) const { return m_starts[p_car]; }
+
+		const RaceLogic::Input &getInput(unsigned p_tick, unsigned p_car) const { return m_inputs[p_tick * getCarCount() + p_car]; }
+
+
+		void setStart(unsigned p_car, const CL_Pointf &p_position, float p_rotation);
+
+		/** Adds next tick, <code>p_inputs</code> holds input of every car */
+		void addTick(const RaceLogic::Input *p_inputs);
+
+
+		void save(const CL_String &p_filename) const;
+
+		/** Loads replay, throws CL_Exception on bad file */
+		void load(const CL_String &p_filename);
+
+	private:
+
+		/** Level file */
+		CL_String m_levelName;
+
+		/** Start poses */
+		std::vector<CarStart> m_starts;
+
+		/** Inputs, tick after tick */
+		std::vector<RaceLogic::Input> m_inputs;
+};
+
+} // namespace
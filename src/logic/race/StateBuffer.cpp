@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "StateBuffer.h"
+
+#include <algorithm>
+#include <math.h>
+
+namespace Race {
+
+const unsigned StateBuffer::CAPACITY;
+
+const unsigned StateBuffer::MAX_EXTRAPOLATION;
+
+const float PI = 3.14159265f;
+
+namespace {
+
+	/** @return State at p_part of the way from p_from to p_to */
+	Net::CarState interpolate(const Net::CarState &p_from, const Net::CarState &p_to, float p_part, float p_duration)
+	{
+		const float s = p_part;
+		const float s2 = s * s;
+		const float s3 = s2 * s;
+
+		// cubic Hermite basis, tangents scaled to the interval
+		const float h00 = 2.0f * s3 - 3.0f * s2 + 1.0f;
+		const float h10 = s3 - 2.0f * s2 + s;
+		const float h01 = -2.0f * s3 + 3.0f * s2;
+		const float h11 = s3 - s2;
+
+		const CL_Vec2f position =
+				CL_Vec2f(p_from.getPosition()) * h00 +
+				p_from.getMovement() * (h10 * p_duration) +
+				CL_Vec2f(p_to.getPosition()) * h01 +
+				p_to.getMovement() * (h11 * p_duration);
+
+		// shortest way around
+		const float from = p_from.getRotation().to_radians();
+		float turn = p_to.getRotation().to_radians() - from;
+		turn -= 2.0f * PI * floor((turn + PI) / (2.0f * PI));
+
+		Net::CarState state(s < 0.5f ? p_from : p_to);
+
+		state.setPosition(CL_Pointf(position.x, position.y));
+		state.setRotation(CL_Angle::from_radians(from + turn * s));
+		state.setMovement(p_from.getMovement() * (1.0f - s) + p_to.getMovement() * s);
+		state.setSpeed(p_from.getSpeed() * (1.0f - s) + p_to.getSpeed() * s);
+		state.setTurn(p_from.getTurn() * (1.0f - s) + p_to.getTurn() * s);
+
+		return state;
+	}
+
+} // namespace
+
+void StateBuffer::push(unsigned p_time, const Net::CarState &p_state)
+{
+	if (!m_entries.empty() && (int) (p_time - m_entries.back().m_time) <= 0) {
+		return;
+	}
+
+	Entry entry;
+	entry.m_time = p_time;
+	entry.m_state = p_state;
+
+	m_entries.push_back(entry);
+
+	if (m_entries.size() > CAPACITY) {
+		m_entries.pop_front();
+	}
+}
+
+bool StateBuffer::sample(unsigned p_time, Net::CarState &p_state) const
+{
+	if (m_entries.empty()) {
+		return false;
+	}
+
+	const Entry &oldest = m_entries.front();
+	const Entry &newest = m_entries.back();
+
+	// nothing older to show
+	if ((int) (p_time - oldest.m_time) <= 0) {
+		p_state = oldest.m_state;
+		return true;
+	}
+
+	// states are late, keep moving for a while
+	if ((int) (p_time - newest.m_time) >= 0) {
+		const unsigned ahead = std::min(p_time - newest.m_time, MAX_EXTRAPOLATION);
+		const CL_Vec2f position = CL_Vec2f(newest.m_state.getPosition()) + newest.m_state.getMovement() * (ahead / 1000.0f);
+
+		p_state = newest.m_state;
+		p_state.setPosition(CL_Pointf(position.x, position.y));
+
+		return true;
+	}
+
+	size_t next = 1;
+
+	while ((int) (p_time - m_entries[next].m_time) > 0) {
+		++next;
+	}
+
+	const Entry &from = m_entries[next - 1];
+	const Entry &to = m_entries[next];
+
+	const unsigned duration = to.m_time - from.m_time;
+	p_state = interpolate(from.m_state, to.m_state, (float) (p_time - from.m_time) / duration, duration / 1000.0f);
+
+	return true;
+}
+
+} // namespace
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <deque>
+#include <ClanLib/core.h>
+
+#include "network/packets/CarState.h"
+
+namespace Race {
+
+/**
+ * Server states of one remote car stamped with server time. Car is shown
+ * some time behind the newest state, between two received ones, so it
+ * moves smoothly at any send rate. Position is Hermite interpolated with
+ * movement vectors as tangents. When states are late, car goes on along
+ * its last movement for a bounded time and then stops.
+ */
+class StateBuffer {
+
+	public:
+
+		/** States kept at most */
+		static const unsigned CAPACITY = 16;
+
+		/** Extrapolation time limit in ms */
+		static const unsigned MAX_EXTRAPOLATION = 200;
+
+		StateBuffer() {}
+
+		/** Adds state of given server time in ms, states not newer are dropped */
+		void push(unsigned p_time, const Net::CarState &p_state);
+
+		/** @return False when there is no state to show */
+		bool sample(unsigned p_time, Net::CarState &p_state) const;
+
+		void clear() { m_entries.clear(); }
+
+	private:
+
+		struct Entry {
+
+				unsigned m_time;
+
+				Net::CarState m_state;
+		};
+
+		/** Entries from the oldest one */
+		std::deque<Entry> m_entries;
+};
+
+} // namespace
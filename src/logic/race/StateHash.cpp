@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "StateHash.h"
+
+#include <string.h>
+
+#include "logic/race/Car.h"
+#include "logic/race/Checkpoint.h"
+#include "logic/race/Level.h"
+
+namespace Race {
+
+namespace {
+
+	/** FNV-1a constants */
+	const unsigned FNV_OFFSET = 2166136261u;
+	const unsigned FNV_PRIME = 16777619u;
+
+	void hashWord(unsigned &p_hash, unsigned p_word)
+	{
+		for (int i = 0; i < 4; ++i) {
+			p_hash ^= (p_word >> (i * 8)) & 0xFF;
+			p_hash *= FNV_PRIME;
+		}
+	}
+
+	/** @return Float bits with -0 folded to 0 */
+	unsigned floatBits(float p_value)
+	{
+		if (p_value == 0.0f) {
+			p_value = 0.0f;
+		}
+
+		unsigned bits;
+		memcpy(&bits, &p_value, sizeof(bits));
+
+		return bits;
+	}
+
+	void diffField(const char *p_name, float p_a, float p_b, std::vector<CL_String> &p_lines)
+	{
+		if (floatBits(p_a) != floatBits(p_b)) {
+			p_lines.push_back(cl_format("%1: %2 != %3 (delta %4)", CL_String(p_name), p_a, p_b, p_b - p_a));
+		}
+	}
+
+	void diffField(const char *p_name, int p_a, int p_b, std::vector<CL_String> &p_lines)
+	{
+		if (p_a != p_b) {
+			p_lines.push_back(cl_format("%1: %2 != %3", CL_String(p_name), p_a, p_b));
+		}
+	}
+
+} // namespace
+
+StateHash::CarFields StateHash::getFields(const Car &p_car)
+{
+	CarFields fields;
+
+	fields.m_x = p_car.getPosition().x;
+	fields.m_y = p_car.getPosition().y;
+	fields.m_rotation = p_car.getRotationRad();
+	fields.m_moveX = p_car.getMoveVector().x;
+	fields.m_moveY = p_car.getMoveVector().y;
+	fields.m_speed = p_car.getSpeed();
+	fields.m_lap = p_car.getLap();
+	fields.m_checkpoint = p_car.getCurrentCheckpoint() != NULL ? p_car.getCurrentCheckpoint()->getId() : 0;
+
+	return fields;
+}
+
+void StateHash::getFields(const Level &p_level, TCarFieldsList &p_fields)
+{
+	const unsigned carCount = p_level.getCarCount();
+
+	p_fields.resize(carCount);
+
+	for (unsigned i = 0; i < carCount; ++i) {
+		p_fields[i] = getFields(p_level.getCar(i));
+	}
+}
+
+unsigned StateHash::calculate(const TCarFieldsList &p_fields)
+{
+	unsigned hash = FNV_OFFSET;
+
+	for (TCarFieldsList::const_iterator itor = p_fields.begin(); itor != p_fields.end(); ++itor) {
+		hashWord(hash, floatBits(itor->m_x));
+		hashWord(hash, floatBits(itor->m_y));
+		hashWord(hash, floatBits(itor->m_rotation));
+		hashWord(hash, floatBits(itor->m_moveX));
+		hashWord(hash, floatBits(itor->m_moveY));
+		hashWord(hash, floatBits(itor->m_speed));
+		hashWord(hash, itor->m_lap);
+		hashWord(hash, itor->m_checkpoint);
+	}
+
+	return hash;
+}
+
+unsigned StateHash::calculate(const Level &p_level)
+{
+	TCarFieldsList fields;
+	getFields(p_level, fields);
+
+	return calculate(fields);
+}
+
+unsigned StateHash::diff(const CarFields &p_a, const CarFields &p_b, std::vector<CL_String> &p_lines)
+{
+	const unsigned lineCount = p_lines.size();
+
+	diffField("x", p_a.m_x, p_b.m_x, p_lines);
+	diffField("y", p_a.m_y, p_b.m_y, p_lines);
+	diffField("rotation", p_a.m_rotation, p_b.m_rotation, p_lines);
+	diffField("move x", p_a.m_moveX, p_b.m_moveX, p_lines);
+	diffField("move y", p_a.m_moveY, p_b.m_moveY, p_lines);
+	diffField("speed", p_a.m_speed, p_b.m_speed, p_lines);
+	diffField("lap", p_a.m_lap, p_b.m_lap, p_lines);
+	diffField("checkpoint", p_a.m_checkpoint, p_b.m_checkpoint, p_lines);
+
+	return p_lines.size() - lineCount;
+}
+
+} // namespace
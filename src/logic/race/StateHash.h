@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <vector>
+#include <ClanLib/core.h>
+
+namespace Race {
+
+class Car;
+class Level;
+
+/**
+ * Canonical race state hash. Covers everything car physics depends on,
+ * so two runs with the same inputs must give the same hash every tick.
+ */
+class StateHash {
+
+	public:
+
+		/** Hashed fields of single car */
+		struct CarFields {
+
+				float m_x, m_y;
+
+				float m_rotation;
+
+				float m_moveX, m_moveY;
+
+				float m_speed;
+
+				int m_lap;
+
+				/** Current checkpoint id, 0 when none */
+				int m_checkpoint;
+		};
+
+		typedef std::vector<CarFields> TCarFieldsList;
+
+
+		static CarFields getFields(const Car &p_car);
+
+		/** Collects fields of all level cars in level order */
+		static void getFields(const Level &p_level, TCarFieldsList &p_fields);
+
+		static unsigned calculate(const TCarFieldsList &p_fields);
+
+		static unsigned calculate(const Level &p_level);
+
+		/**
+		 * Describes fields which differ, one line per field.
+		 * @return Number of differing fields
+		 */
+		static unsigned diff(const CarFields &p_a, const CarFields &p_b, std::vector<CL_String> &p_lines);
+
+	private:
+
+		StateHash();
+};
+
+} // namespace
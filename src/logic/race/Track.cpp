@@ -80,7 +80,7 @@ void Track::clear()
 		delete checkpoint;
 	}
 
-	m_checkpoints.clear();
+	TCheckpointVector().swap(m_checkpoints);
 	m_closed = false;
 }
 
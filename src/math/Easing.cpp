@@ -28,25 +28,73 @@
 
 #include "Easing.h"
 
-#include <iostream>
 #include <assert.h>
 
 namespace Math {
 
-inline float easingCalculateNone(float p_from, float p_to, Easing p_easing, float p_progress)
+typedef float (*TEasingFunction)(float p_progress);
+
+static float easingNone(float p_progress)
 {
-	return p_from + ((p_to - p_from) * p_progress);
+	return p_progress;
 }
 
-float easingCalculate(float p_from, float p_to, Easing p_easing, float p_progress)
+static float easingInQuad(float p_progress)
 {
-	switch (p_easing) {
-		case E_NONE:
-			return easingCalculateNone(p_from, p_to, p_easing, p_progress);
-			break;
-		default:
-			assert(0 && "Easing not implemented yet");
+	return p_progress * p_progress;
+}
+
+static float easingOutQuad(float p_progress)
+{
+	return p_progress * (2.0f - p_progress);
+}
+
+static float easingInOutQuad(float p_progress)
+{
+	if (p_progress < 0.5f) {
+		return 2.0f * p_progress * p_progress;
 	}
+
+	const float inv = 1.0f - p_progress;
+	return 1.0f - 2.0f * inv * inv;
+}
+
+static float easingInCubic(float p_progress)
+{
+	return p_progress * p_progress * p_progress;
+}
+
+static float easingOutCubic(float p_progress)
+{
+	const float inv = 1.0f - p_progress;
+	return 1.0f - inv * inv * inv;
+}
+
+static float easingInOutCubic(float p_progress)
+{
+	if (p_progress < 0.5f) {
+		return 4.0f * p_progress * p_progress * p_progress;
+	}
+
+	const float inv = 1.0f - p_progress;
+	return 1.0f - 4.0f * inv * inv * inv;
+}
+
+/** Easing functions indexed by Easing value */
+static const TEasingFunction EASING_FUNCTIONS[E_COUNT] = {
+	easingNone,
+	easingInQuad,
+	easingOutQuad,
+	easingInOutQuad,
+	easingInCubic,
+	easingOutCubic,
+	easingInOutCubic
+};
+
+float easingCalculate(float p_from, float p_to, Easing p_easing, float p_progress)
+{
+	assert(p_easing >= 0 && p_easing < E_COUNT && "unknown easing");
+	return p_from + ((p_to - p_from) * EASING_FUNCTIONS[p_easing](p_progress));
 }
 
 }
@@ -30,8 +30,21 @@
 
 namespace Math {
 	enum Easing {
-		E_NONE
+		E_NONE,
+		E_IN_QUAD,
+		E_OUT_QUAD,
+		E_IN_OUT_QUAD,
+		E_IN_CUBIC,
+		E_OUT_CUBIC,
+		E_IN_OUT_CUBIC,
+
+		/** Number of easing modes, not a mode itself */
+		E_COUNT
 	};
 
+	/**
+	 * Calculates the value between <code>p_from</code> and <code>p_to</code>
+	 * at <code>p_progress</code> (0.0 - 1.0) using selected easing.
+	 */
 	float easingCalculate(float p_from, float p_to, Easing p_easing, float p_progress);
 }
@@ -30,14 +30,13 @@
 
 #include <assert.h>
 
-#include "common.h"
-
 namespace Math {
 
 Float::Float() :
 	m_value(0.0f),
 	m_timeFromStart(0),
-	m_currentAnimation(NULL)
+	m_keyframeCount(0),
+	m_cursor(0)
 {
 }
 
@@ -49,66 +48,119 @@ void Float::animate(float p_startValue, float p_endValue, unsigned p_duration, E
 {
 	const unsigned startTime = m_timeFromStart + p_delay;
 
-	Animation *animation = new Animation();
-	animation->m_from = p_startValue;
-	animation->m_to = p_endValue;
-	animation->m_startTime = startTime;
-	animation->m_endTime = startTime + p_duration;
-	animation->m_easing = p_easing;
+	compact();
 
-	m_animationMap[startTime] = animation;
-}
+	// binary search for the first keyframe starting not before startTime
+	unsigned low = 0, high = m_keyframeCount;
 
-void Float::update(unsigned p_timeElapsed)
-{
-	m_timeFromStart += p_timeElapsed;
+	while (low < high) {
+		const unsigned mid = (low + high) / 2;
 
-	// look for next animation
-	for (TAnimationMap::iterator itor = m_animationMap.begin(); itor != m_animationMap.end();) {
-		if (itor->first <= m_timeFromStart) {
-			setCurrentAnimation(itor->second);
-			m_animationMap.erase(itor++);
+		if (m_keyframes[mid].m_startTime < startTime) {
+			low = mid + 1;
 		} else {
-			++itor;
+			high = mid;
 		}
 	}
 
-	if (m_currentAnimation != NULL) {
+	const bool replace = low < m_keyframeCount && m_keyframes[low].m_startTime == startTime;
 
-		if (m_currentAnimation->m_endTime <= m_timeFromStart) {
+	if (!replace) {
 
-			// check current animation validity
-			delete m_currentAnimation;
-			m_currentAnimation = NULL;
+		if (m_keyframeCount == MAX_KEYFRAMES) {
 
-		} else {
+			if (low == 0) {
+				// starts before all the others
+				return;
+			}
+
+			// drop the keyframe starting first
+			for (unsigned i = 1; i < m_keyframeCount; ++i) {
+				m_keyframes[i - 1] = m_keyframes[i];
+			}
 
-			// make progress
+			--m_keyframeCount;
+			--low;
+		}
 
-			const float progress =
-					(m_timeFromStart - m_currentAnimation->m_startTime) /
-					(float) (m_currentAnimation->m_endTime - m_currentAnimation->m_startTime);
+		// make room for the new keyframe
+		for (unsigned i = m_keyframeCount; i > low; --i) {
+			m_keyframes[i] = m_keyframes[i - 1];
+		}
+
+		++m_keyframeCount;
+	}
+
+	Keyframe &keyframe = m_keyframes[low];
+	keyframe.m_from = p_startValue;
+	keyframe.m_to = p_endValue;
+	keyframe.m_startTime = startTime;
+	keyframe.m_endTime = startTime + p_duration;
+	keyframe.m_easing = p_easing;
+}
+
+void Float::update(unsigned p_timeElapsed)
+{
+	m_timeFromStart += p_timeElapsed;
 
-			// this should be value between 0.0 and 1.0
-			assert(progress >= 0.0f && progress <= 1.0f);
+	while (m_cursor < m_keyframeCount) {
 
-			m_value = easingCalculate(
-					m_currentAnimation->m_from, m_currentAnimation->m_to,
-					m_currentAnimation->m_easing,
-					progress
-			);
+		const Keyframe &keyframe = m_keyframes[m_cursor];
 
+		if (keyframe.m_startTime > m_timeFromStart) {
+			// nothing runs yet
+			break;
 		}
+
+		// started keyframe overrides the previous one
+		if (m_cursor + 1 < m_keyframeCount && m_keyframes[m_cursor + 1].m_startTime <= m_timeFromStart) {
+			++m_cursor;
+			continue;
+		}
+
+		if (keyframe.m_endTime <= m_timeFromStart) {
+			// finished, so leave the final value
+			m_value = keyframe.m_to;
+			++m_cursor;
+			continue;
+		}
+
+		// make progress
+
+		const float progress =
+				(m_timeFromStart - keyframe.m_startTime) /
+				(float) (keyframe.m_endTime - keyframe.m_startTime);
+
+		// this should be value between 0.0 and 1.0
+		assert(progress >= 0.0f && progress <= 1.0f);
+
+		m_value = easingCalculate(keyframe.m_from, keyframe.m_to, keyframe.m_easing, progress);
+
+		break;
+	}
+}
+
+void Float::updateAll(Float *const *p_floats, unsigned p_count, unsigned p_timeElapsed)
+{
+	for (unsigned i = 0; i < p_count; ++i) {
+		p_floats[i]->update(p_timeElapsed);
 	}
 }
 
-void Float::setCurrentAnimation(Animation *p_animation)
+void Float::compact()
 {
-	if (m_currentAnimation != NULL) {
-		delete m_currentAnimation;
+	if (m_cursor == 0) {
+		return;
+	}
+
+	const unsigned left = m_keyframeCount - m_cursor;
+
+	for (unsigned i = 0; i < left; ++i) {
+		m_keyframes[i] = m_keyframes[m_cursor + i];
 	}
 
-	m_currentAnimation = p_animation;
+	m_keyframeCount = left;
+	m_cursor = 0;
 }
 
 } // namespace
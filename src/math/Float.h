@@ -28,24 +28,33 @@
 
 #pragma once
 
-#include <map>
 #include "boost/utility.hpp"
 
 #include "Easing.h"
 
 namespace Math {
 
+/**
+ * Animated float value. Animations are kept as keyframes in a fixed-size
+ * inline table sorted by start time, so animating does not allocate.
+ */
 class Float : public boost::noncopyable {
 
-		struct Animation {
+		struct Keyframe {
 				float m_from, m_to;
 				unsigned m_startTime, m_endTime;
-				unsigned m_duration;
 				Easing m_easing;
 		};
 
 	public:
 
+		/**
+		 * Maximum number of pending keyframes. Smoke, the busiest user,
+		 * schedules two per value.
+		 */
+		static const unsigned MAX_KEYFRAMES = 4;
+
+
 		Float();
 
 		virtual ~Float();
@@ -55,7 +64,16 @@ class Float : public boost::noncopyable {
 
 		void set(float p_value) { m_value = p_value; }
 
+		/** @return True when there are no running or pending animations */
+		bool isFinished() const { return m_cursor == m_keyframeCount; }
+
 
+		/**
+		 * Schedules the animation. Animation that starts at the same time
+		 * as already scheduled one replaces it. When keyframe table is full
+		 * then the keyframe starting first gives way, it is the first one
+		 * overridden by the others anyway. That may be the new one.
+		 */
 		void animate(float p_startValue, float p_endValue, unsigned p_duration, Easing p_easing = E_NONE, unsigned p_delay = 0);
 
 		/**
@@ -68,23 +86,35 @@ class Float : public boost::noncopyable {
 		 */
 		void update(unsigned p_timeElapsed);
 
+		/**
+		 * Updates <code>p_count</code> floats at once.
+		 *
+		 * @param p_floats Floats to update.
+		 * @param p_count Number of floats.
+		 * @param p_timeElapsed Time in miliseconds.
+		 */
+		static void updateAll(Float *const *p_floats, unsigned p_count, unsigned p_timeElapsed);
+
 	private:
 
 		/** Current value container */
 		float m_value;
 
 		/** Time registered from the begining */
-		size_t m_timeFromStart;
+		unsigned m_timeFromStart;
+
+		/** Animations to do in time. Sorted by the start time. */
+		Keyframe m_keyframes[MAX_KEYFRAMES];
 
-		/** Animations to do in time. Key is the start time. */
-		typedef std::map<size_t, Animation*> TAnimationMap;
+		/** Number of used keyframes */
+		unsigned m_keyframeCount;
 
-		TAnimationMap m_animationMap;
+		/** Index of currently running or next pending keyframe */
+		unsigned m_cursor;
 
-		/** Currently running animation */
-		Animation *m_currentAnimation;
 
-		void setCurrentAnimation(Animation *p_animation);
+		/** Removes keyframes that are already done */
+		void compact();
 
 };
 
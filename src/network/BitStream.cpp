@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "BitStream.h"
+
+#include <assert.h>
+#include <math.h>
+
+namespace Net {
+
+namespace {
+
+	/** @return Largest value of p_bits wide field */
+	unsigned maxValue(unsigned p_bits)
+	{
+		return p_bits == 32 ? 0xFFFFFFFFu : (1u << p_bits) - 1;
+	}
+
+	/** @return Steps of signed field on one side of zero */
+	unsigned halfRange(unsigned p_bits)
+	{
+		return maxValue(p_bits - 1);
+	}
+
+	/** @return Value clamped to [-1, 1], NaN gives zero */
+	float clampUnit(float p_value)
+	{
+		if (p_value > 1.0f) {
+			return 1.0f;
+		} else if (p_value < -1.0f) {
+			return -1.0f;
+		} else if (p_value != p_value) {
+			return 0.0f;
+		}
+
+		return p_value;
+	}
+
+} // namespace
+
+unsigned quantize(float p_value, float p_min, float p_max, unsigned p_bits)
+{
+	assert(p_max > p_min && "bad range");
+
+	float ratio = (p_value - p_min) / (p_max - p_min);
+
+	if (!(ratio > 0.0f)) {
+		// also catches NaN
+		ratio = 0.0f;
+	} else if (ratio > 1.0f) {
+		ratio = 1.0f;
+	}
+
+	return (unsigned) floor(ratio * maxValue(p_bits) + 0.5f);
+}
+
+unsigned quantizeSigned(float p_value, float p_max, unsigned p_bits)
+{
+	assert(p_max > 0.0f && p_bits >= 2 && "bad range");
+
+	const int half = halfRange(p_bits);
+	const int steps = (int) floor(clampUnit(p_value / p_max) * half + 0.5f);
+
+	return steps + half;
+}
+
+float dequantize(unsigned p_code, float p_min, float p_max, unsigned p_bits)
+{
+	assert(p_max > p_min && "bad range");
+	return p_min + (p_max - p_min) * ((float) p_code / maxValue(p_bits));
+}
+
+float dequantizeSigned(unsigned p_code, float p_max, unsigned p_bits)
+{
+	assert(p_max > 0.0f && p_bits >= 2 && "bad range");
+
+	const int half = halfRange(p_bits);
+	const int steps = (int) p_code - half;
+
+	// the highest code is never written
+	return p_max * clampUnit((float) steps / half);
+}
+
+BitWriter::BitWriter() :
+	m_bitCount(0)
+{
+}
+
+void BitWriter::write(unsigned p_value, unsigned p_bits)
+{
+	assert(p_bits > 0 && p_bits <= 32 && "bad field width");
+	assert(p_value <= maxValue(p_bits) && "value does not fit the field");
+
+	for (int i = p_bits - 1; i >= 0; --i) {
+		if (m_bitCount % 8 == 0) {
+			m_bytes.push_back(0);
+		}
+
+		if ((p_value >> i) & 1) {
+			m_bytes.back() |= 0x80 >> (m_bitCount % 8);
+		}
+
+		++m_bitCount;
+	}
+}
+
+void BitWriter::writeFloat(float p_value, float p_min, float p_max, unsigned p_bits)
+{
+	write(quantize(p_value, p_min, p_max, p_bits), p_bits);
+}
+
+void BitWriter::writeSignedFloat(float p_value, float p_max, unsigned p_bits)
+{
+	write(quantizeSigned(p_value, p_max, p_bits), p_bits);
+}
+
+CL_String8 BitWriter::getData() const
+{
+	if (m_bytes.empty()) {
+		return CL_String8();
+	}
+
+	return CL_String8(reinterpret_cast<const char*>(&m_bytes[0]), m_bytes.size());
+}
+
+BitReader::BitReader(const CL_String8 &p_data) :
+	m_data(p_data),
+	m_bitCount(p_data.size() * 8),
+	m_position(0)
+{
+}
+
+unsigned BitReader::read(unsigned p_bits)
+{
+	assert(p_bits > 0 && p_bits <= 32 && "bad field width");
+
+	if (p_bits > getRemainingBits()) {
+		throw CL_Exception("bit stream is too short");
+	}
+
+	unsigned value = 0;
+
+	for (unsigned i = 0; i < p_bits; ++i) {
+		const unsigned char byte = m_data[m_position / 8];
+		value = (value << 1) | ((byte >> (7 - m_position % 8)) & 1);
+
+		++m_position;
+	}
+
+	return value;
+}
+
+float BitReader::readFloat(float p_min, float p_max, unsigned p_bits)
+{
+	return dequantize(read(p_bits), p_min, p_max, p_bits);
+}
+
+float BitReader::readSignedFloat(float p_max, unsigned p_bits)
+{
+	return dequantizeSigned(read(p_bits), p_max, p_bits);
+}
+
+} // namespace
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <vector>
+#include <ClanLib/core.h>
+
+namespace Net {
+
+/** @return Value quantized to p_bits wide code over [p_min, p_max], clamped */
+unsigned quantize(float p_value, float p_min, float p_max, unsigned p_bits);
+
+/** @return Value quantized over [-p_max, p_max] with zero kept exact */
+unsigned quantizeSigned(float p_value, float p_max, unsigned p_bits);
+
+/** @return Value of code made by quantize() with the same range */
+float dequantize(unsigned p_code, float p_min, float p_max, unsigned p_bits);
+
+/** @return Value of code made by quantizeSigned() with the same range */
+float dequantizeSigned(unsigned p_code, float p_max, unsigned p_bits);
+
+/**
+ * Packs unsigned fields of any width up to 32 bits into bytes, most
+ * significant bit first. Floats are quantized to a given range.
+ */
+class BitWriter {
+
+	public:
+
+		BitWriter();
+
+		/** Writes lowest p_bits of p_value, value must fit */
+		void write(unsigned p_value, unsigned p_bits);
+
+		/** Writes value quantized to [p_min, p_max], values outside are clamped */
+		void writeFloat(float p_value, float p_min, float p_max, unsigned p_bits);
+
+		/** Writes value quantized to [-p_max, p_max] with zero kept exact */
+		void writeSignedFloat(float p_value, float p_max, unsigned p_bits);
+
+		/** @return Written bytes, the last one is padded with zeros */
+		CL_String8 getData() const;
+
+		unsigned getBitCount() const { return m_bitCount; }
+
+	private:
+
+		std::vector<unsigned char> m_bytes;
+
+		unsigned m_bitCount;
+};
+
+/** Reads fields written by BitWriter */
+class BitReader {
+
+	public:
+
+		explicit BitReader(const CL_String8 &p_data);
+
+		/** Reads unsigned field, throws CL_Exception when data ends */
+		unsigned read(unsigned p_bits);
+
+		/** Reads float field written with the same range and width */
+		float readFloat(float p_min, float p_max, unsigned p_bits);
+
+		/** Reads float field written by writeSignedFloat() */
+		float readSignedFloat(float p_max, unsigned p_bits);
+
+		unsigned getRemainingBits() const { return m_bitCount - m_position; }
+
+	private:
+
+		const CL_String8 m_data;
+
+		const unsigned m_bitCount;
+
+		unsigned m_position;
+};
+
+} // namespace
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "EventCodec.h"
+
+#include <string.h>
+
+#include "network/BitStream.h"
+#include "network/events.h"
+
+namespace Net {
+
+namespace {
+
+	/** Argument type codes on wire */
+	enum ValueType {
+		VT_NULL,
+		VT_INTEGER,
+		VT_UINTEGER,
+		VT_STRING,
+		VT_BOOLEAN,
+		VT_NUMBER
+	};
+
+	const unsigned TYPE_BITS = 3;
+
+	/** Opcode takes place of event name */
+	const unsigned OPCODE_BITS = 5;
+
+	const unsigned LENGTH_BITS = 16;
+
+	const unsigned MAX_LENGTH = (1 << LENGTH_BITS) - 1;
+
+	const unsigned COUNT_BITS = 8;
+
+	const unsigned MAX_ARGUMENTS = (1 << COUNT_BITS) - 1;
+
+	void writeString(BitWriter &p_writer, const CL_String8 &p_string)
+	{
+		if (p_string.size() > MAX_LENGTH) {
+			throw CL_Exception("event codec: string too long");
+		}
+
+		p_writer.write(p_string.size(), LENGTH_BITS);
+
+		for (CL_String8::size_type i = 0; i < p_string.size(); ++i) {
+			p_writer.write((unsigned char) p_string[i], 8);
+		}
+	}
+
+	CL_String8 readString(BitReader &p_reader)
+	{
+		const unsigned length = p_reader.read(LENGTH_BITS);
+
+		if (length * 8 > p_reader.getRemainingBits()) {
+			throw CL_Exception("event codec: string too long");
+		}
+
+		CL_String8 string(length, 0);
+
+		for (unsigned i = 0; i < length; ++i) {
+			string[i] = (char) p_reader.read(8);
+		}
+
+		return string;
+	}
+
+} // namespace
+
+void EventCodec::write(BitWriter &p_writer, const CL_NetGameEvent &p_event)
+{
+	const unsigned opcode = getOpcode(p_event);
+
+	if (opcode == OPCODE_COUNT) {
+		throw CL_Exception("event codec: event without opcode");
+	}
+
+	p_writer.write(opcode, OPCODE_BITS);
+
+	const unsigned count = p_event.get_argument_count();
+
+	if (count > MAX_ARGUMENTS) {
+		throw CL_Exception("event codec: too many arguments");
+	}
+
+	p_writer.write(count, COUNT_BITS);
+
+	for (unsigned i = 0; i < count; ++i) {
+		const CL_NetGameEventValue value = p_event.get_argument(i);
+
+		switch (value.get_type()) {
+			case CL_NetGameEventValue::null:
+				p_writer.write(VT_NULL, TYPE_BITS);
+				break;
+			case CL_NetGameEventValue::integer:
+				p_writer.write(VT_INTEGER, TYPE_BITS);
+				p_writer.write((unsigned) value.to_integer(), 32);
+				break;
+			case CL_NetGameEventValue::uinteger:
+				p_writer.write(VT_UINTEGER, TYPE_BITS);
+				p_writer.write(value.to_uinteger(), 32);
+				break;
+			case CL_NetGameEventValue::string:
+				p_writer.write(VT_STRING, TYPE_BITS);
+				writeString(p_writer, value.to_string());
+				break;
+			case CL_NetGameEventValue::boolean:
+				p_writer.write(VT_BOOLEAN, TYPE_BITS);
+				p_writer.write(value.to_boolean() ? 1 : 0, 1);
+				break;
+			case CL_NetGameEventValue::number: {
+				p_writer.write(VT_NUMBER, TYPE_BITS);
+
+				const float number = value.to_number();
+				unsigned bits;
+
+				memcpy(&bits, &number, sizeof(bits));
+				p_writer.write(bits, 32);
+				break;
+			}
+			default:
+				throw CL_Exception("event codec: unsupported argument type");
+		}
+	}
+}
+
+CL_NetGameEvent EventCodec::read(BitReader &p_reader)
+{
+	const unsigned opcode = p_reader.read(OPCODE_BITS);
+
+	if (opcode >= OPCODE_COUNT) {
+		throw CL_Exception("event codec: bad opcode");
+	}
+
+	const char name[2] = { (char) (OPCODE_BASE + opcode), 0 };
+	CL_NetGameEvent event(name);
+
+	const unsigned count = p_reader.read(COUNT_BITS);
+
+	for (unsigned i = 0; i < count; ++i) {
+		switch (p_reader.read(TYPE_BITS)) {
+			case VT_NULL:
+				event.add_argument(CL_NetGameEventValue());
+				break;
+			case VT_INTEGER:
+				event.add_argument((int) p_reader.read(32));
+				break;
+			case VT_UINTEGER:
+				event.add_argument(p_reader.read(32));
+				break;
+			case VT_STRING:
+				event.add_argument(readString(p_reader));
+				break;
+			case VT_BOOLEAN:
+				event.add_argument(p_reader.read(1) == 1);
+				break;
+			case VT_NUMBER: {
+				const unsigned bits = p_reader.read(32);
+				float number;
+
+				memcpy(&number, &bits, sizeof(number));
+				event.add_argument(number);
+				break;
+			}
+			default:
+				throw CL_Exception("event codec: bad argument type");
+		}
+	}
+
+	return event;
+}
+
+} // namespace
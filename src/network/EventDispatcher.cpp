@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "EventDispatcher.h"
+
+namespace Net {
+
+namespace {
+
+	/** Metric names of opcodes, received messages and UDP bytes */
+	const char *const METRIC_NAMES[OPCODE_COUNT][2] = {
+		{ "client_info received", "client_info udp bytes received" },
+		{ "client_view received", "client_view udp bytes received" },
+		{ "game_state received", "game_state udp bytes received" },
+		{ "goodbye received", "goodbye udp bytes received" },
+		{ "udp_token received", "udp_token udp bytes received" },
+		{ "player_joined received", "player_joined udp bytes received" },
+		{ "player_leaved received", "player_leaved udp bytes received" },
+		{ "car_state received", "car_state udp bytes received" },
+		{ "car_input received", "car_input udp bytes received" },
+		{ "snapshot received", "snapshot udp bytes received" },
+		{ "snapshot_ack received", "snapshot_ack udp bytes received" }
+	};
+
+} // namespace
+
+OpcodeCounter::OpcodeCounter(unsigned p_opcode) :
+	m_messages(METRIC_NAMES[p_opcode][0]),
+	m_bytes(METRIC_NAMES[p_opcode][1])
+{
+	assert(p_opcode < OPCODE_COUNT && "bad opcode");
+}
+
+} // namespace
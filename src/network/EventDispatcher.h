@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <assert.h>
+#include <ClanLib/core.h>
+#include <ClanLib/network.h>
+
+#include "boost/utility.hpp"
+#include "debug/Metrics.h"
+#include "network/events.h"
+
+namespace Net {
+
+/**
+ * Messages and bytes received of one opcode. Only UDP payload sizes are
+ * known, events over TCP add to the messages only.
+ */
+class OpcodeCounter {
+
+	public:
+
+		explicit OpcodeCounter(unsigned p_opcode);
+
+		void count(unsigned p_bytes) const
+		{
+			m_messages.increment();
+			m_bytes.increment(p_bytes);
+		}
+
+	private:
+
+		const Dbg::Counter m_messages;
+
+		const Dbg::Counter m_bytes;
+};
+
+/**
+ * Table of event handlers indexed by opcode, filled once at construction
+ * of the owner. THandler is a member function pointer of the owner, the
+ * owner calls what it gets with its own arguments.
+ */
+template<typename THandler>
+class EventDispatcher : public boost::noncopyable {
+
+	public:
+
+		EventDispatcher()
+		{
+			for (unsigned i = 0; i < OPCODE_COUNT; ++i) {
+				m_handlers[i] = NULL;
+				m_counters[i] = NULL;
+			}
+		}
+
+		virtual ~EventDispatcher()
+		{
+			for (unsigned i = 0; i < OPCODE_COUNT; ++i) {
+				delete m_counters[i];
+			}
+		}
+
+
+		/** Registers handler of opcode, its events are counted from now */
+		void add(EventOpcode p_opcode, THandler p_handler)
+		{
+			assert(m_handlers[p_opcode] == NULL && "opcode handler already registered");
+
+			m_handlers[p_opcode] = p_handler;
+			m_counters[p_opcode] = new OpcodeCounter(p_opcode);
+		}
+
+		/**
+		 * Counts the event if it has a handler.
+		 * @param p_bytes Encoded event size known by transport, 0 if unknown
+		 * @return Handler of event opcode, NULL if there is none
+		 */
+		THandler find(const CL_NetGameEvent &p_event, unsigned p_bytes) const
+		{
+			const unsigned opcode = getOpcode(p_event);
+
+			if (opcode == OPCODE_COUNT || m_handlers[opcode] == NULL) {
+				return NULL;
+			}
+
+			m_counters[opcode]->count(p_bytes);
+
+			return m_handlers[opcode];
+		}
+
+	private:
+
+		THandler m_handlers[OPCODE_COUNT];
+
+		/** Counters of opcodes having handler */
+		const OpcodeCounter *m_counters[OPCODE_COUNT];
+};
+
+} // namespace
@@ -30,22 +30,50 @@
 
 #include "common/Game.h"
 #include "common.h"
+#include "debug/MemoryTracker.h"
+#include "debug/Metrics.h"
+#include "debug/Profiler.h"
 #include "network/events.h"
 #include "../packets/Goodbye.h"
 #include "../packets/ClientInfo.h"
 #include "../packets/GameState.h"
-#include "../packets/CarState.h"
+#include "../packets/CarInput.h"
+#include "../packets/PlayerJoined.h"
+#include "../packets/Snapshot.h"
 
 namespace Net {
 
+/** Hello datagrams period until server answers over UDP in ms */
+const unsigned HELLO_PERIOD = 250;
+
+const Dbg::Counter EVENTS_RECEIVED_METRIC("events received");
+
+const Dbg::Counter EVENTS_SENT_METRIC("events sent");
+
 Client::Client() :
 	m_port(DEFAULT_PORT),
-	m_connected(false)
+	m_connected(false),
+	m_snapshots(SNAPSHOT_HISTORY),
+	m_udpActive(false),
+	m_udpReady(false),
+	m_lastHelloTime(0)
 //	m_raceClient(this)
 {
 	m_slots.connect(m_gameClient.sig_connected(), this, &Client::onConnected);
 	m_slots.connect(m_gameClient.sig_disconnected(), this, &Client::onDisconnected);
 	m_slots.connect(m_gameClient.sig_event_received(), this, &Client::onEventReceived);
+
+	// connect / disconnect procedure
+	m_dispatcher.add(OP_GOODBYE, &Client::onGoodbye);
+	m_dispatcher.add(OP_GAME_STATE, &Client::onGameState);
+	m_dispatcher.add(OP_UDP_TOKEN, &Client::onUdpToken);
+
+	// player events
+	m_dispatcher.add(OP_PLAYER_JOINED, &Client::onPlayerJoined);
+	m_dispatcher.add(OP_PLAYER_LEAVED, &Client::onPlayerLeaved);
+
+	// race events
+	m_dispatcher.add(OP_SNAPSHOT, &Client::onSnapshot);
 }
 
 void Client::connect() {
@@ -82,6 +110,9 @@ void Client::onConnected()
 	m_connected = true;
 	INVOKE_0(connected);
 
+	// baselines of previous session are useless
+	m_snapshots.assign(SNAPSHOT_HISTORY, Snapshot());
+
 	// I am connected
 	// Sending player info
 	ClientInfo playerInfo;
@@ -100,62 +131,123 @@ void Client::onDisconnected()
 
 	m_connected = false;
 
+	// server forgets the UDP session too
+	m_udpActive = false;
+	m_udpReady = false;
+
 	INVOKE_0(disconnected);
 }
 
 void Client::onEventReceived(const CL_NetGameEvent &p_event)
 {
-	cl_log_event("event", "Event %1 arrived", p_event.to_string());
+	// ClanLib does not tell message sizes
+	handleEvent(p_event, 0);
+}
+
+void Client::handleEvent(const CL_NetGameEvent &p_event, unsigned p_bytes)
+{
+	PROFILE_ZONE(Dbg::Z_EVENT);
+	MEMORY_SCOPE(Dbg::MT_NETWORK);
+	EVENTS_RECEIVED_METRIC.increment();
 
 	try {
-		const CL_String eventName = p_event.get_name();
-		bool unhandled = false;
+		const TEventHandler handler = m_dispatcher.find(p_event, p_bytes);
 
-		// connect / disconnect procedure
+		if (handler != NULL) {
+			(this->*handler)(p_event);
+		} else {
+			cl_log_event("error", "Event %1 remains unhandled", p_event.get_name());
+		}
+	} catch (CL_Exception e) {
+		cl_log_event("exception", e.message);
+	}
 
-		if (eventName == EVENT_GOODBYE) {
-			onGoodbye(p_event);
-		} else if (eventName == EVENT_GAME_STATE) {
-			onGameState(p_event);
-		} else
+}
 
-		// player events
+void Client::onGoodbye(const CL_NetGameEvent &p_event)
+{
+	Goodbye goodbye;
+	goodbye.parseEvent(p_event);
 
-		if (eventName == EVENT_PLAYER_JOINED) {
-			onPlayerJoined(p_event);
-		} else if (eventName == EVENT_PLAYER_LEAVED) {
-			onPlayerLeaved(p_event);
-		} else
+	cl_log_event("event", "Server says goodbye: %1", goodbye.getStringMessage());
+	disconnect();
+}
 
-		// race events
+void Client::onUdpToken(const CL_NetGameEvent &p_event)
+{
+	const unsigned token = p_event.get_argument(0);
 
-		if (eventName == EVENT_CAR_STATE) {
-			onCarState(p_event);
+	try {
+		if (!m_udpSocket.isBound()) {
+			m_udpSocket.bind("0");
 		}
 
-		// unknown events remain unhandled
+		m_serverName = CL_SocketName(m_addr, CL_StringHelp::int_to_local8(m_port));
+		m_channel = UdpChannel(token);
+
+		m_udpActive = true;
+		m_udpReady = false;
+
+		// say hello at next update
+		m_lastHelloTime = CL_System::get_time() - HELLO_PERIOD;
+	} catch (CL_Exception e) {
+		cl_log_event("exception", "Cannot open UDP socket, using TCP only: %1", e.message);
+	}
+}
 
-		{
-			unhandled = true;
+void Client::update()
+{
+	if (!m_udpActive) {
+		return;
+	}
+
+	CL_String8 datagram;
+	CL_SocketName from;
+
+	std::vector<CL_NetGameEvent> events;
+	std::vector<unsigned> sizes;
+
+	while (m_udpSocket.receive(datagram, from)) {
+		unsigned token;
+
+		if (!UdpChannel::readToken(datagram, token) || token != m_channel.getToken()) {
+			continue;
 		}
 
-		if (unhandled) {
-			cl_log_event("error", "Event %1 remains unhandled", p_event.to_string());
+		events.clear();
+		sizes.clear();
+
+		try {
+			m_channel.receive(datagram, events, &sizes);
+		} catch (CL_Exception e) {
+			cl_log_event("exception", e.message);
+			continue;
 		}
 
-	} catch (CL_Exception e) {
-		cl_log_event("exception", e.message);
+		if (!m_udpReady) {
+			cl_log_event("network", "UDP session established");
+			m_udpReady = true;
+		}
+
+		for (size_t i = 0; i < events.size(); ++i) {
+			handleEvent(events[i], sizes[i]);
+		}
 	}
 
-}
+	const unsigned now = CL_System::get_time();
 
-void Client::onGoodbye(const CL_NetGameEvent &p_event)
-{
-	Goodbye goodbye;
-	goodbye.parseEvent(p_event);
+	// ack datagram tells server our address
+	if (!m_udpReady && now - m_lastHelloTime >= HELLO_PERIOD) {
+		m_channel.sendAck();
+		m_lastHelloTime = now;
+	}
 
-	cl_log_event("event", "Server says goodbye: %1", goodbye.getStringMessage());
-	disconnect();
+	std::vector<CL_String8> datagrams;
+	m_channel.flush(now, datagrams);
+
+	foreach (const CL_String8 &datagram, datagrams) {
+		m_udpSocket.send(datagram, m_serverName);
+	}
 }
 
 void Client::onGameState(const CL_NetGameEvent &p_gameState)
@@ -173,34 +265,62 @@ void Client::onGameState(const CL_NetGameEvent &p_gameState)
 
 void Client::onPlayerJoined(const CL_NetGameEvent &p_event)
 {
-	const CL_String name = p_event.get_argument(0);
-	cl_log_event("event", "Player '%1' joined the game", name);
-	INVOKE_1(playerJoined, name);
+	PlayerJoined packet;
+	packet.parseEvent(p_event);
+
+	cl_log_event("event", "Player '%1' joined the game with id %2", packet.getName(), packet.getPlayerId());
+	INVOKE_1(playerJoined, packet);
 }
 
 void Client::onPlayerLeaved(const CL_NetGameEvent &p_event)
 {
-	const CL_String name = p_event.get_argument(0);
-	cl_log_event("event", "Player '%1' leaved the game", name);
-	INVOKE_1(playerLeaved, name);
+	const TPlayerId id = p_event.get_argument(0);
+	cl_log_event("event", "Player %1 leaved the game", id);
+	INVOKE_1(playerLeaved, id);
 }
 
-void Client::onCarState(const CL_NetGameEvent &p_event)
+void Client::onSnapshot(const CL_NetGameEvent &p_event)
 {
-	CarState state;
-	state.parseEvent(p_event);
+	const unsigned baselineTick = Snapshot::getBaselineTick(p_event);
+
+	// throws when baseline is not kept anymore
+	Snapshot snapshot;
+	snapshot.parseEvent(p_event, &m_snapshots[baselineTick % SNAPSHOT_HISTORY]);
+
+	m_snapshots[snapshot.getTick() % SNAPSHOT_HISTORY] = snapshot;
+
+	// server may use it as baseline from now
+	send(CL_NetGameEvent(EVENT_SNAPSHOT_ACK, snapshot.getTick()), false);
 
-	INVOKE_1(carStateReceived, state);
+	INVOKE_1(snapshotReceived, snapshot);
+}
+
+void Client::send(const CL_NetGameEvent &p_event, bool p_reliable)
+{
+	PROFILE_ZONE(Dbg::Z_PACKET_SEND);
+	EVENTS_SENT_METRIC.increment();
+
+	if (m_udpReady) {
+		// goes out with next update
+		if (!m_channel.send(p_event, p_reliable)) {
+			cl_log_event("network", "UDP session stalled, disconnecting");
+
+			m_udpReady = false;
+			disconnect();
+		}
+	} else {
+		m_gameClient.send_event(p_event);
+	}
 }
 
-void Client::send(const CL_NetGameEvent &p_event)
+void Client::sendCarInput(const Net::CarInput &p_input)
 {
-	m_gameClient.send_event(p_event);
+	send(p_input.buildEvent(), false);
 }
 
-void Client::sendCarState(const Net::CarState &p_state)
+void Client::sendViewExtent(const CL_Sizef &p_extent)
 {
-	send(p_state.buildEvent());
+	send(CL_NetGameEvent(EVENT_CLIENT_VIEW, p_extent.width, p_extent.height));
 }
 
 } // namespace
@@ -33,13 +33,19 @@
 
 #include "common.h"
 #include "common/Player.h"
+#include "network/EventDispatcher.h"
 #include "logic/race/Car.h"
 #include "logic/race/Level.h"
+#include "network/packets/Packet.h"
+#include "network/packets/Snapshot.h"
+#include "network/udp/UdpChannel.h"
+#include "network/udp/UdpSocket.h"
 
 namespace Net {
 
-class CarState;
+class CarInput;
 class GameState;
+class PlayerJoined;
 
 class Client {
 
@@ -56,13 +62,13 @@ class Client {
 		SIGNAL_1(const Net::GameState&, gameStateReceived);
 
 		/** New player joined */
-		SIGNAL_1(const CL_String&, playerJoined);
+		SIGNAL_1(const Net::PlayerJoined&, playerJoined);
 
-		/** Player leaved */
-		SIGNAL_1(const CL_String&, playerLeaved);
+		/** Player of given id leaved */
+		SIGNAL_1(Net::TPlayerId, playerLeaved);
 
-		/** Got new car state */
-		SIGNAL_1(const Net::CarState&, carStateReceived);
+		/** Got car states of server tick */
+		SIGNAL_1(const Net::Snapshot&, snapshotReceived);
 
 	public:
 
@@ -74,8 +80,15 @@ class Client {
 
 		void disconnect();
 
+		/** Exchanges UDP datagrams, call at least at server tick rate */
+		void update();
 
-		void sendCarState(const Net::CarState &p_state);
+
+		/** Sends inputs unreliably, they are repeated until acknowledged */
+		void sendCarInput(const Net::CarInput &p_input);
+
+		/** Tells server how much of the level is shown around local car */
+		void sendViewExtent(const CL_Sizef &p_extent);
 
 
 		const CL_String& getServerAddr() const { return m_addr; }
@@ -90,6 +103,8 @@ class Client {
 
 	private:
 
+		typedef void (Client::*TEventHandler)(const CL_NetGameEvent&);
+
 		/** Server addr */
 		CL_String m_addr;
 
@@ -105,8 +120,31 @@ class Client {
 		/** The slot container */
 		CL_SlotContainer m_slots;
 
+		/** Handlers of server events */
+		EventDispatcher<TEventHandler> m_dispatcher;
+
+		/** Received snapshots, indexed by tick modulo SNAPSHOT_HISTORY */
+		std::vector<Snapshot> m_snapshots;
+
+		/** UDP session, active once token is received */
+		UdpChannel m_channel;
+
+		UdpSocket m_udpSocket;
+
+		CL_SocketName m_serverName;
 
-		void send(const CL_NetGameEvent &p_event);
+		/** Token received and socket bound */
+		bool m_udpActive;
+
+		/** Server answered over UDP */
+		bool m_udpReady;
+
+		/** Time of last hello datagram */
+		unsigned m_lastHelloTime;
+
+
+		/** Sends over UDP once server answered there, over TCP before */
+		void send(const CL_NetGameEvent &p_event, bool p_reliable = true);
 
 		//
 		// connection events
@@ -118,22 +156,30 @@ class Client {
 		/** This client has been disconnected */
 		void onDisconnected();
 
-		/** Event received */
+		/** Event received over TCP */
 		void onEventReceived(const CL_NetGameEvent &p_event);
 
+		/**
+		 * Dispatches event arrived over TCP or UDP.
+		 * @param p_bytes Encoded event size, 0 when transport does not tell
+		 */
+		void handleEvent(const CL_NetGameEvent &p_event, unsigned p_bytes);
+
 		//
 		// game events receivers
 		//
 
 		void onGoodbye(const CL_NetGameEvent &p_event);
 
+		void onUdpToken(const CL_NetGameEvent &p_event);
+
 		void onGameState(const CL_NetGameEvent &p_gameState);
 
 		void onPlayerJoined(const CL_NetGameEvent &p_event);
 
 		void onPlayerLeaved(const CL_NetGameEvent &p_event);
 
-		void onCarState(const CL_NetGameEvent &p_event);
+		void onSnapshot(const CL_NetGameEvent &p_event);
 
 };
 
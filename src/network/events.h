@@ -29,25 +29,83 @@
 #pragma once
 
 #include <ClanLib/core.h>
+#include <ClanLib/network.h>
 
 
+// Every event name is a single character, the opcode of the event. The
+// name is the only header of events sent over TCP, so it is kept short
+// and dispatched without comparing strings. Characters go from
+// OPCODE_BASE in EventOpcode order.
+
 // connect / disconnect procedure
 
-#define EVENT_CLIENT_INFO 	"client_info"
+#define EVENT_CLIENT_INFO 	"a"
+
+// level area shown by client around its car, resent on change
+#define EVENT_CLIENT_VIEW	"b"
 
-#define EVENT_GAME_STATE 	"game_state"
+#define EVENT_GAME_STATE 	"c"
 
-#define EVENT_GOODBYE		"goodbye"
+#define EVENT_GOODBYE		"d"
+
+// UDP session token, sent over TCP after game state
+#define EVENT_UDP_TOKEN		"e"
 
 // player events
 
-#define EVENT_PLAYER_JOINED "player_joined"
+#define EVENT_PLAYER_JOINED "f"
 
-#define EVENT_PLAYER_LEAVED "player_leaved"
+#define EVENT_PLAYER_LEAVED "g"
 
 // race events
 
-#define EVENT_CAR_STATE		"car_state"
+// car state, sent only inline in game states, snapshots carry the rest
+#define EVENT_CAR_STATE		"h"
+
+// client controls of recent logic ticks, server simulates them
+#define EVENT_CAR_INPUT		"i"
+
+// aggregated car states of one server tick
+#define EVENT_SNAPSHOT		"j"
+
+// newest snapshot received by client, baseline of next deltas
+#define EVENT_SNAPSHOT_ACK	"k"
+
+namespace Net {
+
+/** Event opcodes, index of event handlers and counters */
+enum EventOpcode {
+	OP_CLIENT_INFO,
+	OP_CLIENT_VIEW,
+	OP_GAME_STATE,
+	OP_GOODBYE,
+	OP_UDP_TOKEN,
+	OP_PLAYER_JOINED,
+	OP_PLAYER_LEAVED,
+	OP_CAR_STATE,
+	OP_CAR_INPUT,
+	OP_SNAPSHOT,
+	OP_SNAPSHOT_ACK,
+	OPCODE_COUNT
+};
+
+/** Name character of the first opcode */
+const char OPCODE_BASE = 'a';
+
+/** @return Opcode of event, OPCODE_COUNT if its name is not an opcode */
+inline unsigned getOpcode(const CL_NetGameEvent &p_event)
+{
+	const CL_String &name = p_event.get_name();
+
+	if (name.length() != 1) {
+		return OPCODE_COUNT;
+	}
+
+	const unsigned opcode = (unsigned char) (name[0] - OPCODE_BASE);
+	return opcode < OPCODE_COUNT ? opcode : OPCODE_COUNT;
+}
+
+} // namespace
 
 
 //#define EVENT_PREFIX_GENERAL		"general"
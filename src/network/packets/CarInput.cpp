@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "CarInput.h"
+
+#include <assert.h>
+
+#include "common.h"
+#include "network/BitStream.h"
+#include "network/events.h"
+
+namespace Net {
+
+/** Bits of input count, up to MAX_INPUTS inclusive */
+const unsigned COUNT_BITS = 4;
+
+const unsigned TURN_BITS = 8;
+
+const unsigned CarInput::MAX_INPUTS;
+
+CL_NetGameEvent CarInput::buildEvent() const
+{
+	CL_NetGameEvent event(EVENT_CAR_INPUT);
+	event.add_argument(m_firstSequence);
+
+	BitWriter writer;
+	writer.write(m_controls.size(), COUNT_BITS);
+
+	foreach (const Controls &controls, m_controls) {
+		writer.write(controls.m_acceleration, 1);
+		writer.write(controls.m_brake, 1);
+		writer.write(controls.m_handbrake, 1);
+		writer.writeSignedFloat(controls.m_turn, 1.0f, TURN_BITS);
+	}
+
+	event.add_argument(writer.getData());
+
+	return event;
+}
+
+void CarInput::parseEvent(const CL_NetGameEvent &p_event)
+{
+	assert(p_event.get_name() == EVENT_CAR_INPUT);
+
+	if (p_event.get_argument_count() != 2) {
+		throw CL_Exception("car input: bad argument count");
+	}
+
+	const unsigned firstSequence = p_event.get_argument(0);
+
+	const CL_String8 data = p_event.get_argument(1);
+	BitReader reader(data);
+
+	const unsigned count = reader.read(COUNT_BITS);
+
+	if (count > MAX_INPUTS) {
+		throw CL_Exception("car input: bad input count");
+	}
+
+	std::vector<Controls> controls(count);
+
+	for (unsigned i = 0; i < count; ++i) {
+		controls[i].m_acceleration = reader.read(1) != 0;
+		controls[i].m_brake = reader.read(1) != 0;
+		controls[i].m_handbrake = reader.read(1) != 0;
+		controls[i].m_turn = reader.readSignedFloat(1.0f, TURN_BITS);
+	}
+
+	m_firstSequence = firstSequence;
+	m_controls.swap(controls);
+}
+
+float CarInput::roundTurn(float p_turn)
+{
+	return dequantizeSigned(quantizeSigned(p_turn, 1.0f, TURN_BITS), 1.0f, TURN_BITS);
+}
+
+void CarInput::addControls(const Controls &p_controls)
+{
+	assert(m_controls.size() < MAX_INPUTS && "too many inputs");
+	m_controls.push_back(p_controls);
+}
+
+} // namespace
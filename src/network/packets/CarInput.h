@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <vector>
+#include <ClanLib/core.h>
+
+#include "Packet.h"
+
+namespace Net {
+
+/**
+ * Local car controls of consecutive client logic ticks, oldest first.
+ * Every packet repeats the newest inputs server did not acknowledge yet,
+ * so a single lost datagram loses no input.
+ */
+class CarInput : public Net::Packet {
+
+	public:
+
+		/** Inputs in one packet at most */
+		static const unsigned MAX_INPUTS = 8;
+
+		/** Car controls of one tick */
+		struct Controls {
+
+				bool m_acceleration;
+
+				bool m_brake;
+
+				bool m_handbrake;
+
+				float m_turn;
+
+				Controls() :
+					m_acceleration(false),
+					m_brake(false),
+					m_handbrake(false),
+					m_turn(0.0f)
+				{}
+		};
+
+		CarInput() :
+			m_firstSequence(0)
+		{}
+
+		virtual ~CarInput() {}
+
+
+		virtual CL_NetGameEvent buildEvent() const;
+
+		/** Parses event, throws CL_Exception on malformed input */
+		virtual void parseEvent(const CL_NetGameEvent &p_event);
+
+		/**
+		 * @return Turn as server will see it. Client has to drive with
+		 * rounded turn too or its prediction drifts away.
+		 */
+		static float roundTurn(float p_turn);
+
+
+		size_t getInputCount() const { return m_controls.size(); }
+
+		/** @return Sequence number of input, consecutive from the first one */
+		unsigned getSequence(size_t p_index) const { return m_firstSequence + p_index; }
+
+		const Controls &getControls(size_t p_index) const { return m_controls[p_index]; }
+
+
+		void setFirstSequence(unsigned p_sequence) { m_firstSequence = p_sequence; }
+
+		void addControls(const Controls &p_controls);
+
+	private:
+
+		/** Sequence number of the oldest input */
+		unsigned m_firstSequence;
+
+		std::vector<Controls> m_controls;
+};
+
+} // namespace
@@ -29,28 +29,64 @@
 #include "CarState.h"
 
 #include <assert.h>
+#include <math.h>
 
+#include "network/BitStream.h"
 #include "network/events.h"
 
 namespace Net {
 
-CL_NetGameEvent CarState::buildEvent() const
-{
-	CL_NetGameEvent event(EVENT_CAR_STATE);
+/** Field widths of packed state */
+const unsigned POSITION_BITS = 16;
+
+const unsigned ROTATION_BITS = 12;
+
+const unsigned MOVEMENT_BITS = 16;
+
+const unsigned SPEED_BITS = 16;
 
-	event.add_argument(m_name);
+const unsigned ACCEL_BITS = 2;
 
-	event.add_argument(m_position.x);
-	event.add_argument(m_position.y);
+const unsigned TURN_BITS = 8;
 
-	event.add_argument(m_rotation.to_radians());
+/** Widths in field order */
+const unsigned FIELD_BITS[CarState::FIELD_COUNT] = {
+		PLAYER_ID_BITS,
+		POSITION_BITS, POSITION_BITS,
+		ROTATION_BITS,
+		MOVEMENT_BITS, MOVEMENT_BITS,
+		SPEED_BITS,
+		ACCEL_BITS,
+		TURN_BITS
+};
 
-	event.add_argument(m_movement.x);
-	event.add_argument(m_movement.y);
+/** Packed state size in bits */
+const unsigned STATE_BITS = PLAYER_ID_BITS + 2 * POSITION_BITS + ROTATION_BITS + 2 * MOVEMENT_BITS + SPEED_BITS + ACCEL_BITS + TURN_BITS;
 
-	event.add_argument(m_speed);
-	event.add_argument(m_accel);
-	event.add_argument(m_turn);
+/** Speed and movement range, above car maximum speed */
+const float MAX_SPEED = 512.0f;
+
+/** Extent used until level is known, 64 x 64 blocks */
+const float DEFAULT_LEVEL_EXTENT = 64 * 200.0f;
+
+const float TWO_PI = 2.0f * 3.14159265f;
+
+CL_Sizef CarState::m_levelExtent(DEFAULT_LEVEL_EXTENT, DEFAULT_LEVEL_EXTENT);
+
+void CarState::setLevelExtent(const CL_Sizef &p_extent)
+{
+	assert(p_extent.width > 0.0f && p_extent.height > 0.0f && "bad level extent");
+	m_levelExtent = p_extent;
+}
+
+CL_NetGameEvent CarState::buildEvent() const
+{
+	CL_NetGameEvent event(EVENT_CAR_STATE);
+
+	BitWriter writer;
+	write(writer);
+
+	event.add_argument(writer.getData());
 
 	return event;
 }
@@ -59,21 +95,93 @@ void CarState::parseEvent(const CL_NetGameEvent &p_event)
 {
 	assert(p_event.get_name() == EVENT_CAR_STATE);
 
-	int arg = 0;
+	if (p_event.get_argument_count() != 1) {
+		throw CL_Exception("car state: bad argument count");
+	}
+
+	const CL_String8 data = p_event.get_argument(0);
+
+	if (data.size() != (STATE_BITS + 7) / 8) {
+		throw CL_Exception("car state: bad state size");
+	}
+
+	BitReader reader(data);
+	read(reader);
+}
+
+void CarState::write(BitWriter &p_writer) const
+{
+	Quantized quantized;
+	quantize(quantized);
+
+	for (unsigned i = 0; i < FIELD_COUNT; ++i) {
+		p_writer.write(quantized.m_codes[i], FIELD_BITS[i]);
+	}
+}
+
+void CarState::read(BitReader &p_reader)
+{
+	Quantized quantized;
+
+	for (unsigned i = 0; i < FIELD_COUNT; ++i) {
+		quantized.m_codes[i] = p_reader.read(FIELD_BITS[i]);
+	}
 
-	m_name = p_event.get_argument(arg++);
+	dequantize(quantized);
+}
+
+void CarState::quantize(Quantized &p_quantized) const
+{
+	assert(m_playerId < MAX_PLAYERS && "bad player id");
 
-	m_position.x = p_event.get_argument(arg++);
-	m_position.y = p_event.get_argument(arg++);
+	unsigned *codes = p_quantized.m_codes;
 
-	m_rotation = CL_Angle::from_radians(p_event.get_argument(arg++));
+	codes[F_PLAYER_ID] = m_playerId;
 
-	m_movement.x = p_event.get_argument(arg++);
-	m_movement.y = p_event.get_argument(arg++);
+	codes[F_POSITION_X] = Net::quantize(m_position.x, 0.0f, m_levelExtent.width, POSITION_BITS);
+	codes[F_POSITION_Y] = Net::quantize(m_position.y, 0.0f, m_levelExtent.height, POSITION_BITS);
 
-	m_speed = p_event.get_argument(arg++);
-	m_accel = p_event.get_argument(arg++);
-	m_turn = p_event.get_argument(arg++);
+	// full turn wraps to zero
+	const float turns = m_rotation.to_radians() / TWO_PI;
+	const unsigned rotationSteps = 1 << ROTATION_BITS;
+	codes[F_ROTATION] = (unsigned) floor((turns - floor(turns)) * rotationSteps + 0.5f) % rotationSteps;
+
+	codes[F_MOVEMENT_X] = quantizeSigned(m_movement.x, MAX_SPEED, MOVEMENT_BITS);
+	codes[F_MOVEMENT_Y] = quantizeSigned(m_movement.y, MAX_SPEED, MOVEMENT_BITS);
+	codes[F_SPEED] = quantizeSigned(m_speed, MAX_SPEED, SPEED_BITS);
+
+	// -1 (brake), 0, 1 (accelerate)
+	codes[F_ACCELERATION] = m_accel > 0.0f ? 2 : (m_accel < 0.0f ? 0 : 1);
+	codes[F_TURN] = quantizeSigned(m_turn, 1.0f, TURN_BITS);
+}
+
+void CarState::dequantize(const Quantized &p_quantized)
+{
+	const unsigned *codes = p_quantized.m_codes;
+
+	if (codes[F_PLAYER_ID] >= MAX_PLAYERS || codes[F_ACCELERATION] > 2) {
+		throw CL_Exception("car state: bad field code");
+	}
+
+	m_playerId = codes[F_PLAYER_ID];
+
+	m_position.x = Net::dequantize(codes[F_POSITION_X], 0.0f, m_levelExtent.width, POSITION_BITS);
+	m_position.y = Net::dequantize(codes[F_POSITION_Y], 0.0f, m_levelExtent.height, POSITION_BITS);
+
+	m_rotation = CL_Angle::from_radians(codes[F_ROTATION] * TWO_PI / (1 << ROTATION_BITS));
+
+	m_movement.x = dequantizeSigned(codes[F_MOVEMENT_X], MAX_SPEED, MOVEMENT_BITS);
+	m_movement.y = dequantizeSigned(codes[F_MOVEMENT_Y], MAX_SPEED, MOVEMENT_BITS);
+	m_speed = dequantizeSigned(codes[F_SPEED], MAX_SPEED, SPEED_BITS);
+
+	m_accel = (float) codes[F_ACCELERATION] - 1.0f;
+	m_turn = dequantizeSigned(codes[F_TURN], 1.0f, TURN_BITS);
+}
+
+unsigned CarState::getFieldBits(Field p_field)
+{
+	assert(p_field < FIELD_COUNT);
+	return FIELD_BITS[p_field];
 }
 
 } // namespace
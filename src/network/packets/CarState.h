@@ -34,20 +34,76 @@
 
 namespace Net {
 
+class BitReader;
+class BitWriter;
+
+/**
+ * Car state update. Player id and physical state travel as one bit packed
+ * argument: positions quantized to the level extent, rotation, movement,
+ * speed, acceleration and turn, 14 bytes together.
+ */
 class CarState : public Net::Packet {
 
 	public:
 
-		CarState() {}
+		/** Quantized fields in wire order */
+		enum Field {
+			F_PLAYER_ID,
+			F_POSITION_X,
+			F_POSITION_Y,
+			F_ROTATION,
+			F_MOVEMENT_X,
+			F_MOVEMENT_Y,
+			F_SPEED,
+			F_ACCELERATION,
+			F_TURN,
+			FIELD_COUNT
+		};
+
+		/** State exactly as sent, one code per field */
+		struct Quantized {
+				unsigned m_codes[FIELD_COUNT];
+		};
+
+		CarState() :
+			m_playerId(0),
+			m_speed(0.0f),
+			m_accel(0.0f),
+			m_turn(0.0f)
+		{}
 
 		virtual ~CarState() {}
 
 
 		virtual CL_NetGameEvent buildEvent() const;
 
+		/** Parses event, throws CL_Exception on malformed state */
 		virtual void parseEvent(const CL_NetGameEvent &p_event);
 
-		const CL_String &getName() const { return m_name; }
+		/** Appends packed state to bit stream */
+		void write(BitWriter &p_writer) const;
+
+		/** Reads packed state, throws CL_Exception on malformed state */
+		void read(BitReader &p_reader);
+
+		void quantize(Quantized &p_quantized) const;
+
+		/** Sets state from codes, throws CL_Exception on invalid code */
+		void dequantize(const Quantized &p_quantized);
+
+		/** @return Width of field code in bits */
+		static unsigned getFieldBits(Field p_field);
+
+
+		/**
+		 * Sets level size in pixels positions are quantized to. Both sides
+		 * must use the same extent, server announces it in game state.
+		 */
+		static void setLevelExtent(const CL_Sizef &p_extent);
+
+		static const CL_Sizef &getLevelExtent() { return m_levelExtent; }
+
+		TPlayerId getPlayerId() const { return m_playerId; }
 
 		const CL_Pointf &getPosition() const { return m_position; }
 
@@ -62,7 +118,7 @@ class CarState : public Net::Packet {
 		float getTurn() const { return m_turn; }
 
 
-		void setName(const CL_String &p_name) { m_name = p_name; }
+		void setPlayerId(TPlayerId p_playerId) { m_playerId = p_playerId; }
 
 		void setPosition(const CL_Pointf &p_position) { m_position = p_position; }
 
@@ -78,7 +134,11 @@ class CarState : public Net::Packet {
 
 	private:
 
-		CL_String m_name;
+		/** Quantization extent of positions */
+		static CL_Sizef m_levelExtent;
+
+
+		TPlayerId m_playerId;
 
 		CL_Pointf m_position;
 
@@ -29,16 +29,32 @@
 #include "GameState.h"
 
 #include <assert.h>
+#include <float.h>
 
 #include "network/events.h"
 
 namespace Net {
 
+namespace {
+
+	/** @return True for positive finite size, NaN fails every comparison */
+	bool isValidExtent(float p_value)
+	{
+		return p_value > 0.0f && p_value <= FLT_MAX;
+	}
+
+} // namespace
+
 CL_NetGameEvent GameState::buildEvent() const
 {
 	CL_NetGameEvent event(EVENT_GAME_STATE);
 
 	event.add_argument(m_level);
+	event.add_argument(m_levelExtent.width);
+	event.add_argument(m_levelExtent.height);
+
+	event.add_argument(m_localPlayerId);
+	event.add_argument(m_tickRate);
 
 	const size_t playerCount = m_names.size();
 	event.add_argument(playerCount);
@@ -66,15 +82,34 @@ void GameState::parseEvent(const CL_NetGameEvent &p_event)
 	assert(p_event.get_name() == EVENT_GAME_STATE);
 
 	unsigned arg = 0;
-	m_level = p_event.get_argument(arg++);
+	const CL_String level = p_event.get_argument(arg++);
+
+	const float width = p_event.get_argument(arg++);
+	const float height = p_event.get_argument(arg++);
+
+	if (!isValidExtent(width) || !isValidExtent(height)) {
+		throw CL_Exception("game state: bad level extent");
+	}
+
+	const TPlayerId localPlayerId = p_event.get_argument(arg++);
+
+	if (localPlayerId >= MAX_PLAYERS) {
+		throw CL_Exception("game state: bad player id");
+	}
+
+	const unsigned tickRate = p_event.get_argument(arg++);
+
+	if (tickRate == 0) {
+		throw CL_Exception("game state: bad tick rate");
+	}
 
 	const size_t playerCount = p_event.get_argument(arg++);
 
-	m_names.clear();
-	m_carStates.clear();
+	std::vector<CL_String> names;
+	std::vector<CL_NetGameEvent> carStateEvents;
 
 	for (size_t i = 0; i < playerCount; ++i) {
-		m_names.push_back(p_event.get_argument(arg++));
+		names.push_back(p_event.get_argument(arg++));
 
 		// read inline car state event
 		const size_t argumentCount = p_event.get_argument(arg++);
@@ -84,11 +119,33 @@ void GameState::parseEvent(const CL_NetGameEvent &p_event)
 			carStateEvent.add_argument(p_event.get_argument(arg++));
 		}
 
-		CarState carState;
-		carState.parseEvent(carStateEvent);
+		carStateEvents.push_back(carStateEvent);
+	}
+
+	// inline car states are quantized to the new extent, previous one
+	// stays when any of them is bad
+	const CL_Sizef extent(width, height);
+	const CL_Sizef previousExtent = CarState::getLevelExtent();
+
+	CarState::setLevelExtent(extent);
+
+	std::vector<CarState> carStates(carStateEvents.size());
 
-		m_carStates.push_back(carState);
+	try {
+		for (size_t i = 0; i < carStateEvents.size(); ++i) {
+			carStates[i].parseEvent(carStateEvents[i]);
+		}
+	} catch (CL_Exception e) {
+		CarState::setLevelExtent(previousExtent);
+		throw;
 	}
+
+	m_level = level;
+	m_levelExtent = extent;
+	m_localPlayerId = localPlayerId;
+	m_tickRate = tickRate;
+	m_names.swap(names);
+	m_carStates.swap(carStates);
 }
 
 void GameState::addPlayer(const CL_String &p_name, const CarState &p_carState)
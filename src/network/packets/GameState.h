@@ -40,7 +40,10 @@ class GameState : public Packet {
 
 	public:
 
-		GameState() {}
+		GameState() :
+			m_localPlayerId(0),
+			m_tickRate(0)
+		{}
 
 		virtual ~GameState() {}
 
@@ -52,21 +55,45 @@ class GameState : public Packet {
 
 		const CL_String &getLevel() const { return m_level; }
 
+		/** Level size in pixels, car state positions are quantized to it */
+		const CL_Sizef &getLevelExtent() const { return m_levelExtent; }
+
+		/** @return Id assigned to player receiving this state */
+		TPlayerId getLocalPlayerId() const { return m_localPlayerId; }
+
+		/** @return Server snapshots per second, snapshot ticks are counted in them */
+		unsigned getTickRate() const { return m_tickRate; }
+
 		size_t getPlayerCount() const { return m_names.size(); }
 
+		TPlayerId getPlayerId(size_t p_index) const { return m_carStates[p_index].getPlayerId(); }
+
 		const CL_String &getPlayerName(size_t p_index) const { return m_names[p_index]; }
 
 		const CarState &getCarState(size_t p_index) const { return m_carStates[p_index]; }
 
 
+		/** Adds player, car state carries player id */
 		void addPlayer(const CL_String &p_name, const CarState &p_carState);
 
 		void setLevel(const CL_String &p_level) { m_level = p_level; }
 
+		void setLevelExtent(const CL_Sizef &p_extent) { m_levelExtent = p_extent; }
+
+		void setLocalPlayerId(TPlayerId p_playerId) { m_localPlayerId = p_playerId; }
+
+		void setTickRate(unsigned p_tickRate) { m_tickRate = p_tickRate; }
+
 	private:
 
 		CL_String m_level;
 
+		CL_Sizef m_levelExtent;
+
+		TPlayerId m_localPlayerId;
+
+		unsigned m_tickRate;
+
 		std::vector<CL_String> m_names;
 
 		std::vector<CarState> m_carStates;
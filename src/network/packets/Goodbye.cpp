@@ -55,6 +55,8 @@ CL_String Goodbye::getStringMessage() const
 			return "Unsupported protocol version";
 		case NAME_ALREADY_IN_USE:
 			return "Name already in use";
+		case SERVER_FULL:
+			return "Server is full";
 		default:
 			assert(0 && "unknown goodbye reason");
 	}
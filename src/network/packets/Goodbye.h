@@ -38,7 +38,8 @@ class Goodbye : public Packet {
 
 		enum GoodbyeReason {
 			UNSUPPORTED_PROTOCOL_VERSION,
-			NAME_ALREADY_IN_USE
+			NAME_ALREADY_IN_USE,
+			SERVER_FULL
 		};
 
 		Goodbye() {}
@@ -32,6 +32,15 @@
 
 namespace Net {
 
+/** Compact player id assigned by server at join time */
+typedef unsigned TPlayerId;
+
+/** Bits needed to send player id */
+const unsigned PLAYER_ID_BITS = 6;
+
+/** Maximum number of players, valid ids are lower */
+const unsigned MAX_PLAYERS = 1 << PLAYER_ID_BITS;
+
 class Packet {
 
 	public:
@@ -34,7 +34,8 @@
 
 namespace Net {
 
-PlayerJoined::PlayerJoined()
+PlayerJoined::PlayerJoined() :
+	m_playerId(0)
 {
 }
 
@@ -46,6 +47,7 @@ CL_NetGameEvent PlayerJoined::buildEvent() const
 {
 	CL_NetGameEvent event(EVENT_PLAYER_JOINED);
 	event.add_argument(m_name);
+	event.add_argument(m_playerId);
 
 	return event;
 }
@@ -54,6 +56,11 @@ void PlayerJoined::parseEvent(const CL_NetGameEvent &p_event)
 {
 	assert(p_event.get_name() == EVENT_PLAYER_JOINED);
 	m_name = p_event.get_argument(0);
+	m_playerId = p_event.get_argument(1);
+
+	if (m_playerId >= MAX_PLAYERS) {
+		throw CL_Exception("player joined: bad player id");
+	}
 }
 
 } // namespace
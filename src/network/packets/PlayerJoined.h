@@ -50,12 +50,18 @@ class PlayerJoined: public Net::Packet {
 
 		const CL_String &getName() const { return m_name; }
 
+		TPlayerId getPlayerId() const { return m_playerId; }
+
 
 		void setName(const CL_String &p_name) { m_name = p_name; }
 
+		void setPlayerId(TPlayerId p_playerId) { m_playerId = p_playerId; }
+
 	private:
 
 		CL_String m_name;
+
+		TPlayerId m_playerId;
 };
 
 }
@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Snapshot.h"
+
+#include <assert.h>
+#include <algorithm>
+
+#include "common.h"
+#include "network/BitStream.h"
+#include "network/events.h"
+
+namespace Net {
+
+namespace {
+
+	/** Bits of car state count, up to MAX_PLAYERS inclusive */
+	const unsigned COUNT_BITS = PLAYER_ID_BITS + 1;
+
+	/** Bits of field difference small enough to send instead of code */
+	const unsigned DELTA_BITS = 8;
+
+	const int MAX_DELTA = (1 << (DELTA_BITS - 1)) - 1;
+
+	const int NO_INDEX = -1;
+
+	/** Fills player id -> car state index table of baseline */
+	void indexStates(const std::vector<CarState::Quantized> &p_states, int p_index[MAX_PLAYERS])
+	{
+		std::fill(p_index, p_index + MAX_PLAYERS, NO_INDEX);
+
+		const int count = p_states.size();
+
+		for (int i = 0; i < count; ++i) {
+			p_index[p_states[i].m_codes[CarState::F_PLAYER_ID]] = i;
+		}
+	}
+
+	/** @return Field difference wrapped to its width, as signed value */
+	int fieldDelta(unsigned p_code, unsigned p_base, unsigned p_bits)
+	{
+		const unsigned mask = (1u << p_bits) - 1;
+		const unsigned half = 1u << (p_bits - 1);
+
+		const unsigned delta = (p_code - p_base) & mask;
+		return delta >= half ? (int) delta - (int) (mask + 1) : (int) delta;
+	}
+
+	/** Writes all fields but player id */
+	void writeFull(BitWriter &p_writer, const CarState::Quantized &p_state)
+	{
+		for (unsigned i = CarState::F_PLAYER_ID + 1; i < CarState::FIELD_COUNT; ++i) {
+			p_writer.write(p_state.m_codes[i], CarState::getFieldBits((CarState::Field) i));
+		}
+	}
+
+	void readFull(BitReader &p_reader, CarState::Quantized &p_state)
+	{
+		for (unsigned i = CarState::F_PLAYER_ID + 1; i < CarState::FIELD_COUNT; ++i) {
+			p_state.m_codes[i] = p_reader.read(CarState::getFieldBits((CarState::Field) i));
+		}
+	}
+
+	/**
+	 * Writes fields against base: 0 for unchanged car, otherwise 1 and
+	 * per field 0 when unchanged, 10 with small difference or 11 with
+	 * the whole code.
+	 */
+	void writeDelta(BitWriter &p_writer, const CarState::Quantized &p_state, const CarState::Quantized &p_base)
+	{
+		const unsigned first = CarState::F_PLAYER_ID + 1;
+
+		if (std::equal(p_state.m_codes + first, p_state.m_codes + CarState::FIELD_COUNT, p_base.m_codes + first)) {
+			p_writer.write(0, 1);
+			return;
+		}
+
+		p_writer.write(1, 1);
+
+		for (unsigned i = first; i < CarState::FIELD_COUNT; ++i) {
+			const unsigned bits = CarState::getFieldBits((CarState::Field) i);
+			const unsigned code = p_state.m_codes[i];
+
+			if (code == p_base.m_codes[i]) {
+				p_writer.write(0, 1);
+				continue;
+			}
+
+			const int delta = fieldDelta(code, p_base.m_codes[i], bits);
+
+			if (bits > DELTA_BITS && delta >= -MAX_DELTA && delta <= MAX_DELTA) {
+				p_writer.write(2, 2);
+				p_writer.write(delta + MAX_DELTA, DELTA_BITS);
+			} else {
+				p_writer.write(3, 2);
+				p_writer.write(code, bits);
+			}
+		}
+	}
+
+	void readDelta(BitReader &p_reader, CarState::Quantized &p_state, const CarState::Quantized &p_base)
+	{
+		const unsigned first = CarState::F_PLAYER_ID + 1;
+
+		std::copy(p_base.m_codes + first, p_base.m_codes + CarState::FIELD_COUNT, p_state.m_codes + first);
+
+		if (p_reader.read(1) == 0) {
+			return;
+		}
+
+		for (unsigned i = first; i < CarState::FIELD_COUNT; ++i) {
+			const unsigned bits = CarState::getFieldBits((CarState::Field) i);
+
+			if (p_reader.read(1) == 0) {
+				continue;
+			}
+
+			if (p_reader.read(1) == 0) {
+				const int delta = (int) p_reader.read(DELTA_BITS) - MAX_DELTA;
+				p_state.m_codes[i] = (p_base.m_codes[i] + delta) & ((1u << bits) - 1);
+			} else {
+				p_state.m_codes[i] = p_reader.read(bits);
+			}
+		}
+	}
+
+} // namespace
+
+CL_NetGameEvent Snapshot::buildEvent() const
+{
+	return buildEvent(NULL);
+}
+
+CL_NetGameEvent Snapshot::buildEvent(const Snapshot *p_baseline) const
+{
+	assert((p_baseline == NULL || p_baseline->m_tick != m_tick) && "baseline of the same tick");
+
+	CL_NetGameEvent event(EVENT_SNAPSHOT);
+
+	event.add_argument(m_tick);
+	event.add_argument(p_baseline != NULL ? p_baseline->m_tick : m_tick);
+
+	int baseIndex[MAX_PLAYERS];
+	indexStates(p_baseline != NULL ? p_baseline->m_quantized : std::vector<CarState::Quantized>(), baseIndex);
+
+	BitWriter writer;
+	writer.write(m_quantized.size(), COUNT_BITS);
+
+	foreach (const CarState::Quantized &state, m_quantized) {
+		const unsigned id = state.m_codes[CarState::F_PLAYER_ID];
+		writer.write(id, PLAYER_ID_BITS);
+
+		// cars not in baseline are sent whole
+		if (baseIndex[id] != NO_INDEX) {
+			writeDelta(writer, state, p_baseline->m_quantized[baseIndex[id]]);
+		} else {
+			writeFull(writer, state);
+		}
+	}
+
+	event.add_argument(writer.getData());
+	event.add_argument(m_inputAck);
+
+	return event;
+}
+
+void Snapshot::parseEvent(const CL_NetGameEvent &p_event)
+{
+	parseEvent(p_event, NULL);
+}
+
+void Snapshot::parseEvent(const CL_NetGameEvent &p_event, const Snapshot *p_baseline)
+{
+	assert(p_event.get_name() == EVENT_SNAPSHOT);
+
+	if (p_event.get_argument_count() != 4) {
+		throw CL_Exception("snapshot: bad argument count");
+	}
+
+	const unsigned tick = p_event.get_argument(0);
+	const unsigned baselineTick = p_event.get_argument(1);
+	const unsigned inputAck = p_event.get_argument(3);
+
+	if (baselineTick == tick) {
+		p_baseline = NULL;
+	} else if (p_baseline == NULL || p_baseline->m_tick != baselineTick) {
+		throw CL_Exception("snapshot: baseline is missing");
+	}
+
+	const CL_String8 data = p_event.get_argument(2);
+	BitReader reader(data);
+
+	const unsigned count = reader.read(COUNT_BITS);
+
+	if (count > MAX_PLAYERS) {
+		throw CL_Exception("snapshot: bad car state count");
+	}
+
+	int baseIndex[MAX_PLAYERS];
+	indexStates(p_baseline != NULL ? p_baseline->m_quantized : std::vector<CarState::Quantized>(), baseIndex);
+
+	std::vector<CarState::Quantized> quantized(count);
+	std::vector<CarState> carStates(count);
+
+	for (unsigned i = 0; i < count; ++i) {
+		CarState::Quantized &state = quantized[i];
+
+		const unsigned id = reader.read(PLAYER_ID_BITS);
+		state.m_codes[CarState::F_PLAYER_ID] = id;
+
+		if (baseIndex[id] != NO_INDEX) {
+			readDelta(reader, state, p_baseline->m_quantized[baseIndex[id]]);
+		} else {
+			readFull(reader, state);
+		}
+
+		carStates[i].dequantize(state);
+	}
+
+	// commit only fully parsed snapshot, baseline may be this one
+	m_tick = tick;
+	m_inputAck = inputAck;
+	m_quantized.swap(quantized);
+	m_carStates.swap(carStates);
+}
+
+unsigned Snapshot::getBaselineTick(const CL_NetGameEvent &p_event)
+{
+	assert(p_event.get_name() == EVENT_SNAPSHOT);
+
+	if (p_event.get_argument_count() != 4) {
+		throw CL_Exception("snapshot: bad argument count");
+	}
+
+	return p_event.get_argument(1);
+}
+
+void Snapshot::addCarState(const CarState &p_carState)
+{
+	assert(m_carStates.size() < MAX_PLAYERS && "too many car states");
+
+	CarState::Quantized quantized;
+	p_carState.quantize(quantized);
+
+	m_carStates.push_back(p_carState);
+	m_quantized.push_back(quantized);
+}
+
+void Snapshot::clear()
+{
+	m_carStates.clear();
+	m_quantized.clear();
+}
+
+} // namespace
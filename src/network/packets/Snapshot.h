@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <vector>
+#include <ClanLib/core.h>
+#include <ClanLib/network.h>
+
+#include "Packet.h"
+#include "CarState.h"
+
+namespace Net {
+
+/** Snapshots kept by both sides as possible delta baselines */
+const unsigned SNAPSHOT_HISTORY = 32;
+
+/**
+ * World state of one server network tick: latest car states chosen for
+ * the receiver packed into one binary argument. Snapshot is either a
+ * keyframe or a delta against a baseline snapshot the receiver has
+ * acknowledged, where unchanged cars and fields take a single bit.
+ */
+class Snapshot : public Packet {
+
+	public:
+
+		Snapshot() :
+			m_tick(0),
+			m_inputAck(0)
+		{}
+
+		virtual ~Snapshot() {}
+
+
+		/** Builds keyframe */
+		virtual CL_NetGameEvent buildEvent() const;
+
+		/** Builds delta against baseline, NULL baseline builds keyframe */
+		CL_NetGameEvent buildEvent(const Snapshot *p_baseline) const;
+
+		/** Parses keyframe, throws CL_Exception on malformed snapshot */
+		virtual void parseEvent(const CL_NetGameEvent &p_event);
+
+		/**
+		 * Parses snapshot against the baseline of getBaselineTick(). Throws
+		 * CL_Exception on malformed snapshot or wrong baseline.
+		 */
+		void parseEvent(const CL_NetGameEvent &p_event, const Snapshot *p_baseline);
+
+		/** @return Tick of event baseline, equal to event tick for keyframe */
+		static unsigned getBaselineTick(const CL_NetGameEvent &p_event);
+
+
+		/** @return Server network tick this snapshot was taken at */
+		unsigned getTick() const { return m_tick; }
+
+		/**
+		 * @return Sequence of the last receiver's input simulated before
+		 * the snapshot was taken, zero when none
+		 */
+		unsigned getInputAck() const { return m_inputAck; }
+
+		size_t getCarStateCount() const { return m_carStates.size(); }
+
+		const CarState &getCarState(size_t p_index) const { return m_carStates[p_index]; }
+
+
+		void setTick(unsigned p_tick) { m_tick = p_tick; }
+
+		void setInputAck(unsigned p_sequence) { m_inputAck = p_sequence; }
+
+		void addCarState(const CarState &p_carState);
+
+		void clear();
+
+	private:
+
+		unsigned m_tick;
+
+		/** Differs per receiver, not delta compressed */
+		unsigned m_inputAck;
+
+		std::vector<CarState> m_carStates;
+
+		/** Car states as sent, deltas are taken on them */
+		std::vector<CarState::Quantized> m_quantized;
+};
+
+} // namespace
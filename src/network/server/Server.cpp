@@ -0,0 +1,872 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Server.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <functional>
+#include <math.h>
+#include <stdlib.h>
+
+#include "common.h"
+#include "common/Properties.h"
+#include "debug/MemoryTracker.h"
+#include "debug/Metrics.h"
+#include "debug/Profiler.h"
+#include "logic/race/Block.h"
+#include "network/events.h"
+#include "network/version.h"
+#include "../packets/Goodbye.h"
+#include "../packets/GameState.h"
+#include "../packets/ClientInfo.h"
+#include "../packets/PlayerJoined.h"
+#include "../packets/Snapshot.h"
+
+namespace Net {
+
+/** Source of UDP session tokens, they must not be guessable */
+const CL_String RANDOM_DEVICE = "/dev/urandom";
+
+/** Level file raced on, read at server start */
+const StringProperty LEVEL("net_level", "resources/level.xml");
+
+/** Snapshots sent to every client per second */
+const IntProperty TICK_RATE("net_tickRate", 20);
+
+const unsigned MIN_TICK_RATE = 1;
+
+const unsigned MAX_TICK_RATE = 60;
+
+/** Car simulation steps per second, the same as client logic rate */
+const unsigned STEP_RATE = 60;
+
+/** Steps simulated at most in one update, the rest is skipped */
+const unsigned MAX_CATCH_UP_STEPS = 10;
+
+/** Inputs queued at most, car of client running faster is stepped more */
+const unsigned MAX_QUEUED_INPUTS = 6;
+
+/** Snapshot bytes per second sent to one client, own car goes over it */
+const IntProperty CLIENT_BANDWIDTH("net_clientBandwidth", 3000);
+
+/** Estimated snapshot bytes of one car, keyframe size as upper bound */
+const unsigned CAR_STATE_BYTES = 14;
+
+/** Estimated snapshot bytes besides cars */
+const unsigned SNAPSHOT_HEADER_BYTES = 16;
+
+/** Cars closer to client view than that are treated as in view */
+const float VIEW_MARGIN = 100.0f;
+
+/** Distance from view at which priority halves */
+const float PRIORITY_FALLOFF = 300.0f;
+
+/** Priority of the farthest cars, they are still sent now and then */
+const float MIN_PRIORITY = 0.05f;
+
+/** Accepted view extent range */
+const float MIN_VIEW_EXTENT = 100.0f;
+
+const float MAX_VIEW_EXTENT = 4000.0f;
+
+/** Connections served at once, joined players and those still joining */
+const unsigned MAX_CONNECTIONS = 2 * MAX_PLAYERS;
+
+/** Connection data key of slot index */
+const CL_String SLOT_KEY = "slot";
+
+/** State traffic over UDP, events keep going over TCP when off */
+const BoolProperty UDP_ENABLED("net_udp", true);
+
+const Dbg::Counter EVENTS_RECEIVED_METRIC("events received");
+
+const Dbg::Counter EVENTS_SENT_METRIC("events sent");
+
+const Dbg::Counter SNAPSHOT_BYTES_METRIC("snapshot bytes");
+
+const Dbg::Counter KEYFRAMES_METRIC("keyframes");
+
+const Dbg::Gauge CONNECTIONS_METRIC("connections");
+
+/** Datagrams with known token from other host than the TCP peer */
+const Dbg::Counter FOREIGN_DATAGRAM_METRIC("udp foreign dropped");
+
+const float Server::DEFAULT_VIEW_WIDTH = 400.0f;
+
+const float Server::DEFAULT_VIEW_HEIGHT = 300.0f;
+
+namespace {
+
+	/**
+	 * @return Update priority of car at given position for client viewing
+	 * the area around p_viewCenter, 1 in view and falling with distance
+	 */
+	float priority(const CL_Pointf &p_viewCenter, const CL_Sizef &p_viewExtent, const CL_Pointf &p_position)
+	{
+		const float outX = std::max(fabs(p_position.x - p_viewCenter.x) - p_viewExtent.width / 2 - VIEW_MARGIN, 0.0f);
+		const float outY = std::max(fabs(p_position.y - p_viewCenter.y) - p_viewExtent.height / 2 - VIEW_MARGIN, 0.0f);
+
+		const float outside = sqrt(outX * outX + outY * outY);
+
+		return std::max(1.0f / (1.0f + outside / PRIORITY_FALLOFF), MIN_PRIORITY);
+	}
+
+	/** @return Ticks of given rate in elapsed time, without drift */
+	unsigned ticksIn(unsigned p_elapsed, unsigned p_rate)
+	{
+		return p_elapsed / 1000 * p_rate + p_elapsed % 1000 * p_rate / 1000;
+	}
+
+} // namespace
+
+size_t Server::NameHash::operator()(const CL_String &p_name) const
+{
+	// FNV-1a over name bytes
+	unsigned hash = 2166136261u;
+
+	const char *data = p_name.data();
+	const size_t length = p_name.length();
+
+	for (size_t i = 0; i < length; ++i) {
+		hash = (hash ^ (unsigned char) data[i]) * 16777619u;
+	}
+
+	return hash;
+}
+
+Server::Server() :
+	m_bindPort(DEFAULT_PORT),
+	m_running(false),
+	m_tickRate(0),
+	m_startTime(0),
+	m_tick(0),
+	m_step(0),
+	m_usedIds(MAX_PLAYERS, false),
+	m_udpEnabled(false)
+{
+	m_players.reserve(MAX_CONNECTIONS);
+	m_freeSlots.reserve(MAX_CONNECTIONS);
+
+	for (unsigned slot = 0; slot < MAX_CONNECTIONS; ++slot) {
+		m_players.push_back(Player());
+	}
+
+	for (unsigned slot = MAX_CONNECTIONS; slot > 0; --slot) {
+		m_freeSlots.push_back(slot - 1);
+	}
+
+	m_slots.connect(m_gameServer.sig_client_connected(), this, &Server::onClientConnected);
+	m_slots.connect(m_gameServer.sig_client_disconnected(), this, &Server::onClientDisconnected);
+	m_slots.connect(m_gameServer.sig_event_received(), this, &Server::onEventArrived);
+
+	// connection initialize events
+	m_dispatcher.add(OP_CLIENT_INFO, &Server::onClientInfo);
+	m_dispatcher.add(OP_CLIENT_VIEW, &Server::onClientView);
+
+	// race events
+	m_dispatcher.add(OP_CAR_INPUT, &Server::onCarInput);
+	m_dispatcher.add(OP_SNAPSHOT_ACK, &Server::onSnapshotAck);
+}
+
+Server::~Server()
+{
+	if (m_running) {
+		stop();
+	}
+}
+
+void Server::start()
+{
+	assert(!m_running);
+
+	try {
+		// car state positions are quantized to the level extent
+		m_levelFile = LEVEL.get();
+		m_level.initialize(m_levelFile);
+		CarState::setLevelExtent(getLevelExtent());
+
+		m_gameServer.start(CL_StringHelp::int_to_local8(m_bindPort));
+		m_running = true;
+
+		m_tickRate = std::min(std::max((unsigned) TICK_RATE.get(), MIN_TICK_RATE), MAX_TICK_RATE);
+		m_startTime = CL_System::get_time();
+		m_tick = 0;
+		m_step = 0;
+
+		cl_log_event("runtime", "Network tick rate is %1 Hz", m_tickRate);
+	} catch (const CL_Exception &e) {
+		cl_log_event("runtime", "Unable to start the server: %1", e.message);
+		return;
+	}
+
+	m_udpEnabled = UDP_ENABLED.get();
+
+	if (m_udpEnabled) {
+		try {
+			m_udpSocket.bind(CL_StringHelp::int_to_local8(m_bindPort));
+			m_random = CL_File(RANDOM_DEVICE, CL_File::open_existing, CL_File::access_read);
+		} catch (const CL_Exception &e) {
+			cl_log_event("runtime", "Unable to bind UDP port, using TCP only: %1", e.message);
+			m_udpEnabled = false;
+		}
+	}
+}
+
+void Server::stop()
+{
+	assert(m_running);
+
+	try {
+		m_gameServer.stop();
+		m_level.destroy();
+		m_running = false;
+	} catch (const CL_Exception &e) {
+		cl_log_event("runtime", "Unable to stop the server: %1", e.message);
+	}
+}
+
+void Server::update()
+{
+	if (!m_running) {
+		return;
+	}
+
+	if (m_udpEnabled) {
+		receiveDatagrams();
+	}
+
+	// counted from start so rate does not drift, late ticks are skipped
+	const unsigned elapsed = CL_System::get_time() - m_startTime;
+	const unsigned step = ticksIn(elapsed, STEP_RATE);
+
+	if (step - m_step > MAX_CATCH_UP_STEPS) {
+		m_step = step - MAX_CATCH_UP_STEPS;
+	}
+
+	while (m_step != step) {
+		++m_step;
+		simulate();
+	}
+
+	const unsigned tick = ticksIn(elapsed, m_tickRate);
+
+	if (tick != m_tick) {
+		m_tick = tick;
+		sendSnapshot();
+	}
+
+	if (m_udpEnabled) {
+		flushChannels();
+	}
+}
+
+void Server::receiveDatagrams()
+{
+	CL_String8 datagram;
+	CL_SocketName from;
+
+	std::vector<CL_NetGameEvent> events;
+	std::vector<unsigned> sizes;
+
+	while (m_udpSocket.receive(datagram, from)) {
+		unsigned token;
+
+		if (!UdpChannel::readToken(datagram, token)) {
+			continue;
+		}
+
+		const TTokenMap::const_iterator tokenItor = m_tokens.find(token);
+
+		if (tokenItor == m_tokens.end()) {
+			continue;
+		}
+
+		Player &player = m_players[tokenItor->second];
+
+		// token alone could be replayed from anywhere to take the session
+		if (from.get_address() != player.m_host) {
+			FOREIGN_DATAGRAM_METRIC.increment();
+			continue;
+		}
+
+		events.clear();
+		sizes.clear();
+
+		try {
+			player.m_channel.receive(datagram, events, &sizes);
+		} catch (CL_Exception e) {
+			cl_log_event("exception", e.message);
+			continue;
+		}
+
+		// datagram with valid token tells client address
+		if (!player.m_udpReady) {
+			cl_log_event("network", "UDP session of player '%1' established", player.m_name);
+		}
+
+		player.m_udpAddress = from;
+		player.m_udpReady = true;
+
+		for (size_t i = 0; i < events.size(); ++i) {
+			handleEvent(player, events[i], sizes[i]);
+		}
+	}
+}
+
+void Server::flushChannels()
+{
+	const unsigned now = CL_System::get_time();
+	std::vector<CL_String8> datagrams;
+
+	for (size_t i = 0; i < m_players.size(); ++i) {
+		Player &player = m_players[i];
+
+		if (!player.m_udpReady) {
+			continue;
+		}
+
+		datagrams.clear();
+		player.m_channel.flush(now, datagrams);
+
+		foreach (const CL_String8 &datagram, datagrams) {
+			m_udpSocket.send(datagram, player.m_udpAddress);
+		}
+	}
+}
+
+void Server::onClientConnected(CL_NetGameConnection *p_conn)
+{
+	cl_log_event("network", "Player %1 is connected", (unsigned) p_conn);
+
+	MEMORY_SCOPE(Dbg::MT_NETWORK);
+
+	if (m_freeSlots.empty()) {
+		cl_log_event("network", "No free slot for player %1", (unsigned) p_conn);
+
+		// send goodbye and drop the connection, it has no slot to be served from
+		Goodbye goodbye;
+		goodbye.setGoodbyeReason(Goodbye::SERVER_FULL);
+
+		EVENTS_SENT_METRIC.increment();
+		p_conn->send_event(goodbye.buildEvent());
+		p_conn->disconnect();
+
+		return;
+	}
+
+	const unsigned slot = m_freeSlots.back();
+	m_freeSlots.pop_back();
+
+	m_players[slot].m_connection = p_conn;
+
+	// kept off by one, no data means no slot
+	p_conn->set_data(SLOT_KEY, (void*) (size_t) (slot + 1));
+
+	CONNECTIONS_METRIC.set(MAX_CONNECTIONS - m_freeSlots.size());
+
+	// no signal invoke yet
+}
+
+void Server::onClientDisconnected(CL_NetGameConnection *p_netGameConnection)
+{
+	Player *found = findPlayer(p_netGameConnection);
+
+	if (found == NULL) {
+		cl_log_event("network", "Player %1 disconnects", (unsigned) p_netGameConnection);
+		return;
+	}
+
+	Player &player = *found;
+
+	cl_log_event("network", "Player %1 disconnects", player.m_name.empty() ? CL_StringHelp::uint_to_local8((unsigned) p_netGameConnection) : player.m_name);
+
+	// inform others and free the id if player was in the game
+	if (player.m_gameStateSent) {
+		m_level.removeCar(&player.m_car);
+
+		m_usedIds[player.m_id] = false;
+		m_names.erase(player.m_name);
+
+		sendToAll(CL_NetGameEvent(EVENT_PLAYER_LEAVED, player.m_id), &player);
+
+		INVOKE_1(playerLeaved, player.m_name);
+	}
+
+	// cleanup
+	m_tokens.erase(player.m_channel.getToken());
+
+	const unsigned slot = &player - &m_players[0];
+
+	player.reset();
+	p_netGameConnection->set_data(SLOT_KEY, NULL);
+
+	m_freeSlots.push_back(slot);
+
+	CONNECTIONS_METRIC.set(MAX_CONNECTIONS - m_freeSlots.size());
+}
+
+void Server::Player::reset()
+{
+	m_connection = NULL;
+	m_name.clear();
+	m_id = 0;
+	m_gameStateSent = false;
+	m_car.reset();
+	m_inputs.clear();
+	m_receivedInput = 0;
+	m_simulatedInput = 0;
+	std::fill(m_sentSnapshots.begin(), m_sentSnapshots.end(), Snapshot());
+	m_viewExtent = CL_Sizef(DEFAULT_VIEW_WIDTH, DEFAULT_VIEW_HEIGHT);
+	std::fill(m_priorities.begin(), m_priorities.end(), 0.0f);
+	m_acked = false;
+	m_ackedTick = 0;
+	m_channel = UdpChannel();
+	m_udpReady = false;
+	m_udpAddress = CL_SocketName();
+	m_host.clear();
+}
+
+Server::Player *Server::findPlayer(CL_NetGameConnection *p_connection)
+{
+	const size_t slot = (size_t) p_connection->get_data(SLOT_KEY);
+	return slot != 0 ? &m_players[slot - 1] : NULL;
+}
+
+void Server::onEventArrived(CL_NetGameConnection *p_connection, const CL_NetGameEvent &p_event)
+{
+	Player *player = findPlayer(p_connection);
+
+	if (player == NULL) {
+		cl_log_event("event", "Event %1 from player %2 without slot ignored", p_event.get_name(), (unsigned) p_connection);
+		return;
+	}
+
+	// ClanLib does not tell message sizes
+	handleEvent(*player, p_event, 0);
+}
+
+void Server::handleEvent(Player &p_player, const CL_NetGameEvent &p_event, unsigned p_bytes)
+{
+	PROFILE_ZONE(Dbg::Z_EVENT);
+	MEMORY_SCOPE(Dbg::MT_NETWORK);
+	EVENTS_RECEIVED_METRIC.increment();
+
+	try {
+		const TEventHandler handler = m_dispatcher.find(p_event, p_bytes);
+
+		if (handler != NULL) {
+			(this->*handler)(p_player, p_event);
+		} else {
+			cl_log_event("event", "Event %1 remains unhandled", p_event.get_name());
+		}
+	} catch (CL_Exception e) {
+		cl_log_event("exception", e.message);
+	}
+}
+
+void Server::onCarInput(Player &p_player, const CL_NetGameEvent &p_event)
+{
+	if (!p_player.m_gameStateSent) {
+		cl_log_event("event", "Car input from not joined player %1 ignored", (unsigned) p_player.m_connection);
+		return;
+	}
+
+	CarInput carInput;
+	carInput.parseEvent(p_event);
+
+	const size_t count = carInput.getInputCount();
+
+	for (size_t i = 0; i < count; ++i) {
+		const unsigned sequence = carInput.getSequence(i);
+
+		// repeated or reordered, lost inputs are skipped
+		if ((int) (sequence - p_player.m_receivedInput) <= 0) {
+			continue;
+		}
+
+		p_player.m_inputs.push_back(std::make_pair(sequence, carInput.getControls(i)));
+		p_player.m_receivedInput = sequence;
+	}
+}
+
+void Server::onSnapshotAck(Player &p_player, const CL_NetGameEvent &p_event)
+{
+	const unsigned tick = p_event.get_argument(0);
+
+	// only newer snapshots still kept can be baselines
+	const bool newer = !p_player.m_acked || (int) (tick - p_player.m_ackedTick) > 0;
+	const bool kept = p_player.m_sentSnapshots[tick % SNAPSHOT_HISTORY].getTick() == tick;
+
+	if (newer && kept) {
+		p_player.m_acked = true;
+		p_player.m_ackedTick = tick;
+	}
+}
+
+void Server::onClientInfo(Player &p_player, const CL_NetGameEvent &p_event)
+{
+	ClientInfo clientInfo;
+	clientInfo.parseEvent(p_event);
+
+	// check the version
+	if (clientInfo.getProtocolVersion().getMajor() != PROTOCOL_VERSION_MAJOR) {
+		cl_log_event("event", "Unsupported protocol version for player '%1'", (unsigned) p_player.m_connection);
+
+		// send goodbye
+		Net::Goodbye goodbye;
+		goodbye.setGoodbyeReason(Goodbye::UNSUPPORTED_PROTOCOL_VERSION);
+
+		send(p_player, goodbye.buildEvent());
+		return;
+	}
+
+	if (p_player.m_gameStateSent) {
+		cl_log_event("event", "Repeated client info from player '%1' ignored", p_player.m_name);
+		return;
+	}
+
+	// check name availability
+	if (m_names.find(clientInfo.getName()) != m_names.end()) {
+		cl_log_event("event", "Name '%1' already in use for player '%2'", clientInfo.getName(), (unsigned) p_player.m_connection);
+
+		// send goodbye
+		Goodbye goodbye;
+		goodbye.setGoodbyeReason(Goodbye::NAME_ALREADY_IN_USE);
+
+		send(p_player, goodbye.buildEvent());
+		return;
+	}
+
+	// assign the id
+	TPlayerId id;
+
+	if (!takePlayerId(id)) {
+		cl_log_event("event", "No free player id for player '%1'", (unsigned) p_player.m_connection);
+
+		// send goodbye
+		Goodbye goodbye;
+		goodbye.setGoodbyeReason(Goodbye::SERVER_FULL);
+
+		send(p_player, goodbye.buildEvent());
+		return;
+	}
+
+	// set the name and id and inform all
+	p_player.m_name = clientInfo.getName();
+	p_player.m_id = id;
+
+	m_names.insert(p_player.m_name);
+
+	m_level.addCar(&p_player.m_car);
+	p_player.m_car.setStartPosition(id + 1);
+
+	// id may be reused, its car starts with no priority
+	for (size_t i = 0; i < m_players.size(); ++i) {
+		m_players[i].m_priorities[id] = 0.0f;
+	}
+
+	cl_log_event("event", "'%1' is now known as '%2' with id %3, sending gamestate...", (unsigned) p_player.m_connection, clientInfo.getName(), id);
+
+	PlayerJoined playerJoined;
+	playerJoined.setName(clientInfo.getName());
+	playerJoined.setPlayerId(id);
+
+	sendToAll(playerJoined.buildEvent(), &p_player);
+
+	// send the gamestate, joined player is in it too
+	p_player.m_gameStateSent = true;
+
+	GameState gamestate = prepareGameState();
+	gamestate.setLocalPlayerId(id);
+
+	send(p_player, gamestate.buildEvent());
+
+	// UDP session is keyed off this TCP session
+	if (m_udpEnabled) {
+		const unsigned token = makeToken();
+
+		m_tokens[token] = &p_player - &m_players[0];
+		p_player.m_channel = UdpChannel(token);
+		p_player.m_host = p_player.m_connection->get_remote_address().get_address();
+
+		send(p_player, CL_NetGameEvent(EVENT_UDP_TOKEN, token));
+	}
+}
+
+void Server::onClientView(Player &p_player, const CL_NetGameEvent &p_event)
+{
+	const float width = p_event.get_argument(0);
+	const float height = p_event.get_argument(1);
+
+	p_player.m_viewExtent.width = std::min(std::max(width, MIN_VIEW_EXTENT), MAX_VIEW_EXTENT);
+	p_player.m_viewExtent.height = std::min(std::max(height, MIN_VIEW_EXTENT), MAX_VIEW_EXTENT);
+}
+
+unsigned Server::makeToken()
+{
+	unsigned token;
+
+	do {
+		if (m_random.read(&token, sizeof(token)) != sizeof(token)) {
+			throw CL_Exception("Cannot read " + RANDOM_DEVICE);
+		}
+	} while (token == 0 || m_tokens.find(token) != m_tokens.end());
+
+	return token;
+}
+
+bool Server::takePlayerId(TPlayerId &p_id)
+{
+	for (TPlayerId id = 0; id < MAX_PLAYERS; ++id) {
+		if (!m_usedIds[id]) {
+			m_usedIds[id] = true;
+			p_id = id;
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+GameState Server::prepareGameState()
+{
+	GameState gamestate;
+
+	for (size_t i = 0; i < m_players.size(); ++i) {
+		const Player &player = m_players[i];
+
+		// only players having id
+		if (player.m_gameStateSent) {
+			gamestate.addPlayer(player.m_name, prepareCarState(player));
+		}
+	}
+
+	gamestate.setLevel(m_levelFile);
+	gamestate.setLevelExtent(getLevelExtent());
+	gamestate.setTickRate(m_tickRate);
+
+	return gamestate;
+}
+
+CarState Server::prepareCarState(const Player &p_player) const
+{
+	CarState state = p_player.m_car.prepareCarState();
+	state.setPlayerId(p_player.m_id);
+
+	return state;
+}
+
+void Server::simulate()
+{
+	PROFILE_ZONE(Dbg::Z_CAR_PHYSICS);
+
+	for (size_t i = 0; i < m_players.size(); ++i) {
+		Player &player = m_players[i];
+
+		if (!player.m_gameStateSent) {
+			continue;
+		}
+
+		// car waits for late input instead of guessing it
+		stepCar(player);
+
+		while (player.m_inputs.size() > MAX_QUEUED_INPUTS) {
+			stepCar(player);
+		}
+	}
+}
+
+void Server::stepCar(Player &p_player)
+{
+	if (p_player.m_inputs.empty()) {
+		return;
+	}
+
+	const unsigned sequence = p_player.m_inputs.front().first;
+	const CarInput::Controls &controls = p_player.m_inputs.front().second;
+
+	Race::Car &car = p_player.m_car;
+
+	car.setAcceleration(controls.m_acceleration);
+	car.setBrake(controls.m_brake);
+	car.setHandbrake(controls.m_handbrake);
+	car.setTurn(controls.m_turn);
+
+	car.update1_60();
+	m_level.checkBoundCollisions(car);
+
+	p_player.m_simulatedInput = sequence;
+	p_player.m_inputs.pop_front();
+}
+
+void Server::sendSnapshot()
+{
+	PROFILE_ZONE(Dbg::Z_PACKET_SEND);
+
+	// states of all joined cars, each client gets some of them
+	std::vector<const Player*> owners;
+	std::vector<CarState> states;
+
+	for (size_t i = 0; i < m_players.size(); ++i) {
+		if (m_players[i].m_gameStateSent) {
+			owners.push_back(&m_players[i]);
+			states.push_back(prepareCarState(m_players[i]));
+		}
+	}
+
+	const unsigned budget = std::max(CLIENT_BANDWIDTH.get(), 0) / m_tickRate;
+
+	// accumulated priority, state index
+	std::vector<std::pair<float, size_t> > candidates;
+
+	for (size_t p = 0; p < m_players.size(); ++p) {
+		Player &player = m_players[p];
+
+		if (!player.m_gameStateSent) {
+			continue;
+		}
+
+		Snapshot snapshot;
+		snapshot.setTick(m_tick);
+
+		// client rewinds its car to the state after this input
+		snapshot.setInputAck(player.m_simulatedInput);
+
+		unsigned bytes = SNAPSHOT_HEADER_BYTES;
+		candidates.clear();
+
+		for (size_t i = 0; i < owners.size(); ++i) {
+			if (owners[i] == &player) {
+				// own car always goes, prediction is checked against it
+				snapshot.addCarState(states[i]);
+				bytes += CAR_STATE_BYTES;
+			} else {
+				float &accumulated = player.m_priorities[owners[i]->m_id];
+				accumulated += priority(player.m_car.getPosition(), player.m_viewExtent, owners[i]->m_car.getPosition());
+
+				candidates.push_back(std::make_pair(accumulated, i));
+			}
+		}
+
+		// cars waiting long enough get through even when far away
+		std::sort(candidates.begin(), candidates.end(), std::greater<std::pair<float, size_t> >());
+
+		for (size_t i = 0; i < candidates.size() && bytes + CAR_STATE_BYTES <= budget; ++i) {
+			const size_t index = candidates[i].second;
+
+			snapshot.addCarState(states[index]);
+			player.m_priorities[owners[index]->m_id] = 0.0f;
+
+			bytes += CAR_STATE_BYTES;
+		}
+
+		// Delta against newest snapshot client acknowledged. Only cars sent
+		// in that snapshot are in the baseline, a car left out by the budget
+		// is sent in full when it comes back.
+		const Snapshot *baseline = NULL;
+
+		if (player.m_acked && m_tick - player.m_ackedTick < SNAPSHOT_HISTORY) {
+			baseline = &player.m_sentSnapshots[player.m_ackedTick % SNAPSHOT_HISTORY];
+		} else {
+			KEYFRAMES_METRIC.increment();
+		}
+
+		const CL_NetGameEvent event = snapshot.buildEvent(baseline);
+		SNAPSHOT_BYTES_METRIC.increment(CL_String8(event.get_argument(2)).size());
+
+		// stale snapshots are worthless, no need to resend
+		send(player, event, false);
+
+		player.m_sentSnapshots[m_tick % SNAPSHOT_HISTORY] = snapshot;
+	}
+}
+
+CL_Sizef Server::getLevelExtent() const
+{
+	return CL_Sizef(
+			m_level.getWidth() * Race::Block::WIDTH,
+			m_level.getHeight() * Race::Block::WIDTH
+	);
+}
+
+void Server::send(Player &p_player, const CL_NetGameEvent &p_event, bool p_reliable)
+{
+	PROFILE_ZONE(Dbg::Z_PACKET_SEND);
+	EVENTS_SENT_METRIC.increment();
+
+	if (p_player.m_udpReady) {
+		// goes out with next flush
+		if (!p_player.m_channel.send(p_event, p_reliable)) {
+			cl_log_event("network", "UDP session of player '%1' stalled, disconnecting", p_player.m_name);
+
+			p_player.m_udpReady = false;
+			p_player.m_connection->disconnect();
+		}
+	} else {
+		p_player.m_connection->send_event(p_event);
+	}
+}
+
+void Server::sendToAll(const CL_NetGameEvent &p_event, const Player *p_ignore, bool p_ignoreNotFullyConnected)
+{
+	PROFILE_ZONE(Dbg::Z_PACKET_SEND);
+
+	for (size_t i = 0; i < m_players.size(); ++i) {
+		Player &player = m_players[i];
+
+		if (player.m_connection == NULL || &player == p_ignore) {
+			continue;
+		}
+
+		if (p_ignoreNotFullyConnected && !player.m_gameStateSent) {
+			continue;
+		}
+
+		send(player, p_event);
+	}
+}
+
+//CL_NetGameConnection* Server::getConnectionForPlayer(const Player* player)
+//{
+//	CL_MutexSection lockSection(&m_lockMutex);
+//
+//	std::pair<CL_NetGameConnection*, Player*> pair;
+//
+//	foreach (pair, m_connections) {
+//		if (pair.second == player) {
+//			return pair.first;
+//		}
+//	}
+//
+//	return NULL;
+//}
+
+} // namespace
+
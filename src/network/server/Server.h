@@ -0,0 +1,296 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <deque>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+#include <ClanLib/core.h>
+#include <ClanLib/network.h>
+
+#include "common.h"
+#include "logic/race/Car.h"
+#include "logic/race/Level.h"
+#include "../EventDispatcher.h"
+#include "../packets/CarInput.h"
+#include "../packets/CarState.h"
+#include "../packets/GameState.h"
+#include "../packets/Snapshot.h"
+#include "../udp/UdpChannel.h"
+#include "../udp/UdpSocket.h"
+
+namespace Net {
+
+class Server {
+
+	SIGNAL_1(const CL_String&, playerJoined);
+
+	SIGNAL_1(const CL_String&, playerLeaved);
+
+		/** Received inputs waiting for simulation, with their sequences */
+		typedef std::deque<std::pair<unsigned, CarInput::Controls> > TInputQueue;
+
+		/** View extent assumed until client tells it, default client viewport */
+		static const float DEFAULT_VIEW_WIDTH;
+
+		static const float DEFAULT_VIEW_HEIGHT;
+
+		struct Player {
+
+				/** Owning connection, NULL if the slot is free */
+				CL_NetGameConnection *m_connection;
+
+				CL_String m_name;
+
+				/** Id assigned at join time */
+				TPlayerId m_id;
+
+				bool m_gameStateSent;
+
+				/** Authoritative car, driven by client inputs */
+				Race::Car m_car;
+
+				TInputQueue m_inputs;
+
+				/** Sequence of newest received input */
+				unsigned m_receivedInput;
+
+				/** Sequence of last simulated input, acknowledged in snapshots */
+				unsigned m_simulatedInput;
+
+				/** Snapshots sent, indexed by tick modulo SNAPSHOT_HISTORY */
+				std::vector<Snapshot> m_sentSnapshots;
+
+				/** Level area client shows around its car */
+				CL_Sizef m_viewExtent;
+
+				/**
+				 * Priority of each car accumulated since it was last sent
+				 * to this client, indexed by player id
+				 */
+				std::vector<float> m_priorities;
+
+				/** Client acknowledged any snapshot */
+				bool m_acked;
+
+				/** Newest acknowledged snapshot tick */
+				unsigned m_ackedTick;
+
+				/** UDP session, keyed by token sent over TCP */
+				UdpChannel m_channel;
+
+				/** Client UDP address is known */
+				bool m_udpReady;
+
+				CL_SocketName m_udpAddress;
+
+				/** Address of TCP peer, datagrams of the session come from it */
+				CL_String m_host;
+
+				Player() :
+					m_connection(NULL),
+					m_id(0),
+					m_gameStateSent(false),
+					m_receivedInput(0),
+					m_simulatedInput(0),
+					m_sentSnapshots(SNAPSHOT_HISTORY),
+					m_viewExtent(DEFAULT_VIEW_WIDTH, DEFAULT_VIEW_HEIGHT),
+					m_priorities(MAX_PLAYERS, 0.0f),
+					m_acked(false),
+					m_ackedTick(0),
+					m_udpReady(false)
+				{}
+
+				/**
+				 * Frees the slot field by field. Assigning a new Player would
+				 * copy car signals, which share their connections.
+				 */
+				void reset();
+		};
+
+		/**
+		 * Player slots, never resized so cars keep their addresses. Slots are
+		 * pushed one by one, so no two cars are copies of one car.
+		 */
+		typedef std::vector<Player> TPlayerSlots;
+
+		/** FNV-1a hash of name bytes */
+		struct NameHash {
+				size_t operator()(const CL_String &p_name) const;
+		};
+
+		typedef boost::unordered_set<CL_String, NameHash> TNameSet;
+
+		/** Slot indices by UDP session token */
+		typedef boost::unordered_map<unsigned, unsigned> TTokenMap;
+
+		typedef void (Server::*TEventHandler)(Player&, const CL_NetGameEvent&);
+
+	public:
+
+		Server();
+
+		virtual ~Server();
+
+		void setBindPort(unsigned short p_port) { m_bindPort = p_port; }
+
+
+		void start();
+
+		void stop();
+
+		/**
+		 * Simulates cars at logic rate and sends snapshot of all cars to
+		 * every client when network tick is due. Has to be called much
+		 * more often than logic rate.
+		 */
+		void update();
+
+
+	private:
+		/** Bind port number */
+		unsigned short m_bindPort;
+
+		/** Running state */
+		bool m_running;
+
+		/** Network ticks per second */
+		unsigned m_tickRate;
+
+		/** Time of start, ticks are counted from it */
+		unsigned m_startTime;
+
+		/** Last network tick */
+		unsigned m_tick;
+
+		/** Last simulation step */
+		unsigned m_step;
+
+		/** Connection slots, index is kept with the connection */
+		TPlayerSlots m_players;
+
+		/** Indices of free slots, taken from the back */
+		std::vector<unsigned> m_freeSlots;
+
+		/** Names of joined players */
+		TNameSet m_names;
+
+		/** Player ids in use */
+		std::vector<bool> m_usedIds;
+
+		/** Level file sent to clients */
+		CL_String m_levelFile;
+
+		/** Level raced on, cars are simulated on it */
+		Race::Level m_level;
+
+		/** ClanLib game server */
+		CL_NetGameServer m_gameServer;
+
+		/** Datagram socket bound to the same port number, if UDP is on */
+		UdpSocket m_udpSocket;
+
+		bool m_udpEnabled;
+
+		/** UDP session tokens */
+		TTokenMap m_tokens;
+
+		/** Random device tokens are read from */
+		CL_File m_random;
+
+		/** Slots container */
+		CL_SlotContainer m_slots;
+
+		/** Handlers of client events */
+		EventDispatcher<TEventHandler> m_dispatcher;
+
+
+		/** @return Player in slot of given connection, NULL if it has none */
+		Player *findPlayer(CL_NetGameConnection *p_connection);
+
+		/** Sends over UDP once client address is known, over TCP before */
+		void send(Player &p_player, const CL_NetGameEvent &p_event, bool p_reliable = true);
+
+		void sendToAll(const CL_NetGameEvent &p_event, const Player *p_ignore = NULL, bool p_ignoreNotFullyConnected = true);
+
+		GameState prepareGameState();
+
+		CarState prepareCarState(const Player &p_player) const;
+
+		/** Steps every car with its next input */
+		void simulate();
+
+		/** Steps the car if its input has arrived */
+		void stepCar(Player &p_player);
+
+		/**
+		 * Sends every client a snapshot of its car and of cars of highest
+		 * accumulated priority that fit in its bandwidth budget.
+		 */
+		void sendSnapshot();
+
+		CL_Sizef getLevelExtent() const;
+
+		/** @return True if free id was found and taken */
+		bool takePlayerId(TPlayerId &p_id);
+
+		/** @return Unused non zero UDP session token */
+		unsigned makeToken();
+
+		void receiveDatagrams();
+
+		void flushChannels();
+
+
+		void onClientConnected(CL_NetGameConnection *p_connection);
+
+		void onClientDisconnected(CL_NetGameConnection *p_connection);
+
+		void onEventArrived(CL_NetGameConnection *p_connection, const CL_NetGameEvent &p_event);
+
+		/**
+		 * Dispatches event of player arrived over TCP or UDP.
+		 * @param p_bytes Encoded event size, 0 when transport does not tell
+		 */
+		void handleEvent(Player &p_player, const CL_NetGameEvent &p_event, unsigned p_bytes);
+
+		//
+		// event handlers
+		//
+
+		void onClientInfo(Player &p_player, const CL_NetGameEvent &p_event);
+
+		void onClientView(Player &p_player, const CL_NetGameEvent &p_event);
+
+		void onCarInput(Player &p_player, const CL_NetGameEvent &p_event);
+
+		void onSnapshotAck(Player &p_player, const CL_NetGameEvent &p_event);
+};
+
+} // namespace
@@ -0,0 +1,285 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "UdpChannel.h"
+
+#include <assert.h>
+#include <algorithm>
+
+#include "common.h"
+#include "debug/Metrics.h"
+#include "network/BitStream.h"
+#include "network/EventCodec.h"
+
+namespace Net {
+
+namespace {
+
+	/** Datagram types */
+	enum DatagramType {
+		DT_UNRELIABLE,
+		DT_RELIABLE,
+		DT_ACK
+	};
+
+	const unsigned TOKEN_BITS = 32;
+
+	const unsigned TYPE_BITS = 8;
+
+	const unsigned SEQUENCE_BITS = 16;
+
+	const unsigned SEQUENCE_MASK = (1 << SEQUENCE_BITS) - 1;
+
+	/** Header is byte aligned, payload follows as is */
+	const unsigned HEADER_SIZE = (TOKEN_BITS + TYPE_BITS + 2 * SEQUENCE_BITS) / 8;
+
+	/** Time after unacknowledged reliable datagram is sent again in ms */
+	const unsigned RESEND_TIME = 100;
+
+	/** How far ahead of order reliable datagrams are kept */
+	const unsigned RECEIVE_WINDOW = 1024;
+
+	/** Oldest unacknowledged reliable datagrams sent at one flush */
+	const unsigned SEND_WINDOW = 64;
+
+	/** Reliable events waiting for ack at most, far below sequence wrap */
+	const unsigned MAX_PENDING = RECEIVE_WINDOW;
+
+	const Dbg::Counter STALE_METRIC("udp stale dropped");
+
+	const Dbg::Counter RESENT_METRIC("udp resent");
+
+	const Dbg::Counter MALFORMED_METRIC("udp malformed dropped");
+
+	const Dbg::Counter OVERFLOW_METRIC("udp reliable overflows");
+
+	/** @return Sequence distance from p_from to p_to, negative if p_to is older */
+	int distance(unsigned p_from, unsigned p_to)
+	{
+		const unsigned delta = (p_to - p_from) & SEQUENCE_MASK;
+		return delta > SEQUENCE_MASK / 2 ? (int) delta - (int) (SEQUENCE_MASK + 1) : (int) delta;
+	}
+
+} // namespace
+
+UdpChannel::UdpChannel(unsigned p_token) :
+	m_token(p_token),
+	m_unreliableSequence(0),
+	m_reliableSequence(0),
+	m_lastUnreliable(0),
+	m_unreliableReceived(false),
+	m_nextReliable(0),
+	m_ackDue(false)
+{
+}
+
+bool UdpChannel::send(const CL_NetGameEvent &p_event, bool p_reliable)
+{
+	if (p_reliable && m_pending.size() >= MAX_PENDING) {
+		OVERFLOW_METRIC.increment();
+		return false;
+	}
+
+	BitWriter writer;
+	EventCodec::write(writer, p_event);
+
+	if (p_reliable) {
+		Pending pending;
+
+		pending.m_sequence = m_reliableSequence;
+		pending.m_payload = writer.getData();
+		pending.m_sentTime = 0;
+		pending.m_sent = false;
+
+		m_pending.push_back(pending);
+		m_reliableSequence = (m_reliableSequence + 1) & SEQUENCE_MASK;
+	} else {
+		m_unreliable.push_back(writer.getData());
+	}
+
+	return true;
+}
+
+void UdpChannel::flush(unsigned p_time, std::vector<CL_String8> &p_datagrams)
+{
+	const size_t first = p_datagrams.size();
+
+	foreach (const CL_String8 &payload, m_unreliable) {
+		p_datagrams.push_back(buildDatagram(DT_UNRELIABLE, m_unreliableSequence, payload));
+		m_unreliableSequence = (m_unreliableSequence + 1) & SEQUENCE_MASK;
+	}
+
+	m_unreliable.clear();
+
+	// newer ones wait until the oldest get acknowledged
+	const size_t windowSize = std::min(m_pending.size(), (size_t) SEND_WINDOW);
+
+	for (size_t i = 0; i < windowSize; ++i) {
+		Pending &pending = m_pending[i];
+
+		if (pending.m_sent && p_time - pending.m_sentTime < RESEND_TIME) {
+			continue;
+		}
+
+		if (pending.m_sent) {
+			RESENT_METRIC.increment();
+		}
+
+		p_datagrams.push_back(buildDatagram(DT_RELIABLE, pending.m_sequence, pending.m_payload));
+
+		pending.m_sentTime = p_time;
+		pending.m_sent = true;
+	}
+
+	// every datagram carries the ack, send bare one only if none went out
+	if (m_ackDue && p_datagrams.size() == first) {
+		p_datagrams.push_back(buildDatagram(DT_ACK, 0, CL_String8()));
+	}
+
+	m_ackDue = false;
+}
+
+void UdpChannel::receive(const CL_String8 &p_datagram, std::vector<CL_NetGameEvent> &p_events, std::vector<unsigned> *p_sizes)
+{
+	if (p_datagram.size() < HEADER_SIZE) {
+		throw CL_Exception("udp: datagram too short");
+	}
+
+	BitReader reader(p_datagram.substr(0, HEADER_SIZE));
+
+	const unsigned token = reader.read(TOKEN_BITS);
+	const unsigned type = reader.read(TYPE_BITS);
+	const unsigned ack = reader.read(SEQUENCE_BITS);
+	const unsigned sequence = reader.read(SEQUENCE_BITS);
+
+	if (token != m_token) {
+		throw CL_Exception("udp: wrong session token");
+	}
+
+	acknowledge(ack);
+
+	const CL_String8 payload = p_datagram.substr(HEADER_SIZE);
+
+	switch (type) {
+		case DT_UNRELIABLE:
+			// sequenced: anything not newer than last delivered is stale
+			if (m_unreliableReceived && distance(m_lastUnreliable, sequence) <= 0) {
+				STALE_METRIC.increment();
+				break;
+			}
+
+			m_lastUnreliable = sequence;
+			m_unreliableReceived = true;
+
+			deliver(payload, p_events, p_sizes);
+			break;
+
+		case DT_RELIABLE: {
+			m_ackDue = true;
+
+			const int ahead = distance(m_nextReliable, sequence);
+
+			// duplicates are acked again, too early ones dropped
+			if (ahead < 0 || ahead >= (int) RECEIVE_WINDOW) {
+				break;
+			}
+
+			m_early[sequence] = payload;
+
+			// deliver everything in order
+			TPayloadMap::iterator itor;
+
+			while ((itor = m_early.find(m_nextReliable)) != m_early.end()) {
+				deliver(itor->second, p_events, p_sizes);
+
+				m_early.erase(itor);
+				m_nextReliable = (m_nextReliable + 1) & SEQUENCE_MASK;
+			}
+
+			break;
+		}
+
+		case DT_ACK:
+			break;
+
+		default:
+			throw CL_Exception("udp: bad datagram type");
+	}
+}
+
+bool UdpChannel::readToken(const CL_String8 &p_datagram, unsigned &p_token)
+{
+	if (p_datagram.size() < HEADER_SIZE) {
+		return false;
+	}
+
+	BitReader reader(p_datagram.substr(0, TOKEN_BITS / 8));
+	p_token = reader.read(TOKEN_BITS);
+
+	return true;
+}
+
+CL_String8 UdpChannel::buildDatagram(unsigned p_type, unsigned p_sequence, const CL_String8 &p_payload) const
+{
+	BitWriter writer;
+
+	writer.write(m_token, TOKEN_BITS);
+	writer.write(p_type, TYPE_BITS);
+	writer.write(m_nextReliable, SEQUENCE_BITS);
+	writer.write(p_sequence, SEQUENCE_BITS);
+
+	assert(writer.getBitCount() == HEADER_SIZE * 8);
+
+	return writer.getData() + p_payload;
+}
+
+void UdpChannel::deliver(const CL_String8 &p_payload, std::vector<CL_NetGameEvent> &p_events, std::vector<unsigned> *p_sizes) const
+{
+	// bad payload is dropped, reliable ones must not stop the delivery
+	try {
+		BitReader reader(p_payload);
+		p_events.push_back(EventCodec::read(reader));
+
+		if (p_sizes != NULL) {
+			p_sizes->push_back(p_payload.size());
+		}
+	} catch (CL_Exception e) {
+		MALFORMED_METRIC.increment();
+		cl_log_event("network", "udp: dropped malformed payload: %1", e.message);
+	}
+}
+
+void UdpChannel::acknowledge(unsigned p_ack)
+{
+	// peer got everything before p_ack
+	while (!m_pending.empty() && distance(m_pending.front().m_sequence, p_ack) > 0) {
+		m_pending.pop_front();
+	}
+}
+
+} // namespace
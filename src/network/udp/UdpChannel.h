@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <deque>
+#include <map>
+#include <vector>
+#include <ClanLib/core.h>
+#include <ClanLib/network.h>
+
+namespace Net {
+
+/**
+ * Sequencing state of one UDP peer, independent of sockets. Carries two
+ * channels: unreliable sequenced, where stale datagrams are dropped, and
+ * reliable ordered, where datagrams are resent until acknowledged and
+ * delivered in send order. Every datagram starts with session token
+ * handed out over TCP and carries cumulative ack of reliable channel.
+ */
+class UdpChannel {
+
+	public:
+
+		explicit UdpChannel(unsigned p_token = 0);
+
+		/**
+		 * Queues event to send at next flush().
+		 * @return False when too many reliable events wait for ack, peer is
+		 *         unreachable and the event was not queued
+		 */
+		bool send(const CL_NetGameEvent &p_event, bool p_reliable);
+
+		/** Sends ack at next flush() even if nothing is queued */
+		void sendAck() { m_ackDue = true; }
+
+		/**
+		 * Appends datagrams due at given time: queued unreliable events,
+		 * new and timed out reliable ones of the send window and ack when
+		 * needed.
+		 */
+		void flush(unsigned p_time, std::vector<CL_String8> &p_datagrams);
+
+		/**
+		 * Processes datagram of this session. Appends events ready for
+		 * delivery. Throws CL_Exception on malformed header, events that
+		 * cannot be decoded are dropped.
+		 * @param p_sizes If given, receives encoded size in bytes of every appended event
+		 */
+		void receive(const CL_String8 &p_datagram, std::vector<CL_NetGameEvent> &p_events, std::vector<unsigned> *p_sizes = NULL);
+
+		/** @return False when datagram is too short to have a token */
+		static bool readToken(const CL_String8 &p_datagram, unsigned &p_token);
+
+
+		unsigned getToken() const { return m_token; }
+
+		/** @return Reliable events not acknowledged yet */
+		unsigned getPendingCount() const { return m_pending.size(); }
+
+	private:
+
+		/** Reliable datagram waiting for ack */
+		struct Pending {
+
+				unsigned m_sequence;
+
+				CL_String8 m_payload;
+
+				/** Time of last send, sent at all when m_sent is set */
+				unsigned m_sentTime;
+
+				bool m_sent;
+		};
+
+		typedef std::deque<Pending> TPendingQueue;
+
+		typedef std::map<unsigned, CL_String8> TPayloadMap;
+
+
+		/** Session token */
+		unsigned m_token;
+
+		/** Next outgoing sequences */
+		unsigned m_unreliableSequence;
+
+		unsigned m_reliableSequence;
+
+		/** Newest unreliable sequence received */
+		unsigned m_lastUnreliable;
+
+		bool m_unreliableReceived;
+
+		/** Next reliable sequence to deliver */
+		unsigned m_nextReliable;
+
+		/** Reliable events received ahead of order */
+		TPayloadMap m_early;
+
+		/** Unreliable payloads to send */
+		std::vector<CL_String8> m_unreliable;
+
+		/** Reliable payloads until acknowledged */
+		TPendingQueue m_pending;
+
+		/** Peer has to be told received reliable sequence */
+		bool m_ackDue;
+
+
+		CL_String8 buildDatagram(unsigned p_type, unsigned p_sequence, const CL_String8 &p_payload) const;
+
+		void deliver(const CL_String8 &p_payload, std::vector<CL_NetGameEvent> &p_events, std::vector<unsigned> *p_sizes) const;
+
+		void acknowledge(unsigned p_ack);
+
+};
+
+} // namespace
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "UdpSocket.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include "debug/DebugProperties.h"
+#include "debug/Metrics.h"
+
+namespace Net {
+
+const unsigned UdpSocket::MAX_DATAGRAM_SIZE;
+
+const Dbg::Counter BYTES_SENT_METRIC("udp bytes sent");
+
+const Dbg::Counter BYTES_RECEIVED_METRIC("udp bytes received");
+
+const Dbg::Counter LOST_METRIC("udp simulated loss");
+
+UdpSocket::UdpSocket() :
+	m_bound(false)
+{
+}
+
+void UdpSocket::bind(const CL_String &p_port)
+{
+	m_socket.bind(CL_SocketName(p_port));
+	m_bound = true;
+}
+
+void UdpSocket::send(const CL_String8 &p_datagram, const CL_SocketName &p_to)
+{
+	assert(m_bound && "socket not bound");
+	assert(p_datagram.size() <= MAX_DATAGRAM_SIZE && "datagram too big");
+
+	const int loss = Dbg::PACKET_LOSS.get();
+
+	if (loss > 0 && rand() % 100 < loss) {
+		LOST_METRIC.increment();
+		return;
+	}
+
+	m_socket.send(p_datagram.data(), p_datagram.size(), p_to);
+	BYTES_SENT_METRIC.increment(p_datagram.size());
+}
+
+bool UdpSocket::receive(CL_String8 &p_datagram, CL_SocketName &p_from)
+{
+	if (!m_bound || !m_socket.get_read_event().wait(0)) {
+		return false;
+	}
+
+	const int size = m_socket.receive(m_buffer, MAX_DATAGRAM_SIZE, p_from);
+
+	if (size <= 0) {
+		return false;
+	}
+
+	p_datagram.assign(m_buffer, size);
+	BYTES_RECEIVED_METRIC.increment(size);
+
+	return true;
+}
+
+} // namespace
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2009, Piotr Korzuszek
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <ClanLib/core.h>
+#include <ClanLib/network.h>
+
+namespace Net {
+
+/**
+ * Non blocking datagram socket. Drops outgoing datagrams at rate of
+ * dbg_packetLoss property to test lossy links over loopback.
+ */
+class UdpSocket {
+
+	public:
+
+		/** Largest datagram sent or received */
+		static const unsigned MAX_DATAGRAM_SIZE = 1400;
+
+		UdpSocket();
+
+		/** Binds to local port, "0" picks any. Throws CL_Exception on failure. */
+		void bind(const CL_String &p_port);
+
+		void send(const CL_String8 &p_datagram, const CL_SocketName &p_to);
+
+		/** @return False when nothing is waiting */
+		bool receive(CL_String8 &p_datagram, CL_SocketName &p_from);
+
+		bool isBound() const { return m_bound; }
+
+	private:
+
+		CL_UDPSocket m_socket;
+
+		bool m_bound;
+
+		/** Receive buffer */
+		char m_buffer[MAX_DATAGRAM_SIZE];
+};
+
+} // namespace
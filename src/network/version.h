@@ -28,5 +28,12 @@
 
 #pragma once
 
-#define PROTOCOL_VERSION_MAJOR 1
+// 2: bit packed car state, level extent in game state
+// 3: numeric player ids
+// 4: tick snapshots, delta compressed against acknowledged ones
+// 5: UDP session with token sent over TCP
+// 6: server simulates client inputs, snapshots acknowledge them
+// 7: tick rate in game state
+// 8: one character event opcodes instead of event names
+#define PROTOCOL_VERSION_MAJOR 8
 #define PROTOCOL_VERSION_MINOR 0